@@ -18,14 +18,20 @@
 #ifndef ZILLIQA_SRC_LIBSCHNORR_INCLUDE_MULTISIG_H_
 #define ZILLIQA_SRC_LIBSCHNORR_INCLUDE_MULTISIG_H_
 
+#include <array>
+#include <chrono>
 #include <memory>
 #include <vector>
 
 #include "Schnorr.h"
+#include "SchnorrConfig.h"
 
 // Commitment is composed of a random secret scalar, a public point and a hash
 // of the public point. It is generated by each signer.
 
+class CommitPoint;
+class CommitPointHash;
+
 /// CommitSecret stores information on the secret scalar.
 class CommitSecret : public SerializableCrypto {
   std::shared_ptr<BIGNUM> m_s;
@@ -41,6 +47,14 @@ class CommitSecret : public SerializableCrypto {
   /// Constructor for generating a new commitment secret.
   CommitSecret();
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+  /// Constructor for a commitment secret taken from a NoncePool, which also
+  /// sets the matching commit point and commit point hash without a
+  /// generator multiplication.
+  CommitSecret(NoncePool& pool, CommitPoint& commitPoint,
+               CommitPointHash& commitPointHash);
+#endif
+
   /// Constructor for loading existing secret from a byte stream.
   CommitSecret(const std::vector<uint8_t>& src, unsigned int offset);
 
@@ -53,12 +67,26 @@ class CommitSecret : public SerializableCrypto {
   /// Indicates if secret parameters have been initialized.
   bool Initialized() const;
 
+  /// Fixed-size serialized form.
+  using Serialized = std::array<uint8_t, 32>;
+
   /// Implements the Serialize function inherited from SerializableCrypto.
   bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
 
   /// Implements the Deserialize function inherited from SerializableCrypto.
   bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
 
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Serializes into a fixed-size buffer, without allocating.
+  bool Serialize(Serialized& dst) const;
+
+  /// Deserializes from a fixed-size buffer. Nothing is allocated once this
+  /// object holds a value.
+  bool Deserialize(const Serialized& src);
+
   /// Assignment operator.
   CommitSecret& operator=(const CommitSecret&);
 
@@ -74,6 +102,10 @@ class CommitPoint : public SerializableCrypto {
   friend class MultiSig;
   friend class CommitPointHash;
   friend class Challenge;
+  friend class PartialAggregate;
+  friend class CompactRound;
+  friend class CommitSecret;
+  friend struct ResponseBatchAccess;
 
   void Set(const CommitSecret& secret);
   bool constructPreChecks();
@@ -98,12 +130,44 @@ class CommitPoint : public SerializableCrypto {
   /// Indicates if commitment point parameters have been initialized.
   bool Initialized() const;
 
+  /// Fixed-size serialized form.
+  using Serialized = std::array<uint8_t, 33>;
+
   /// Implements the Serialize function inherited from SerializableCrypto.
   bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
 
   /// Implements the Deserialize function inherited from SerializableCrypto.
   bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
 
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Serializes into a fixed-size buffer, without allocating.
+  bool Serialize(Serialized& dst) const;
+
+  /// Deserializes from a fixed-size buffer. With the native backend,
+  /// nothing is allocated once this object holds a value.
+  bool Deserialize(const Serialized& src);
+
+  /// Serializes points into dst as consecutive Serialized records, on the
+  /// batch threads. dst is resized to fit. Fails if a point is not
+  /// initialized.
+  static bool SerializeAll(const std::vector<CommitPoint>& points,
+                           std::vector<uint8_t>& dst);
+
+  /// Deserializes the consecutive Serialized records of the size bytes at
+  /// src into points, decompressed on the batch threads. points is resized
+  /// to the number of records and its existing entries are reused. Fails if
+  /// size is not a multiple of the record size or a record is not a point on
+  /// the curve; points is then left partly decoded.
+  static bool DeserializeAll(const uint8_t* src, std::size_t size,
+                             std::vector<CommitPoint>& points);
+
+  /// Deserializes the records that make up src, as above.
+  static bool DeserializeAll(const std::vector<uint8_t>& src,
+                             std::vector<CommitPoint>& points);
+
   /// Assignment operator.
   CommitPoint& operator=(const CommitPoint& src);
 
@@ -116,6 +180,8 @@ class CommitPointHash : public SerializableCrypto {
   std::shared_ptr<BIGNUM> m_h;
   bool m_initialized{};
 
+  friend class CommitSecret;
+
   bool constructPreChecks();
   void Set(const CommitPoint& point);
 
@@ -138,12 +204,26 @@ class CommitPointHash : public SerializableCrypto {
   /// Indicates if hash point parameters have been initialized.
   bool Initialized() const;
 
+  /// Fixed-size serialized form.
+  using Serialized = std::array<uint8_t, 32>;
+
   /// Implements the Serialize function inherited from SerializableCrypto.
   bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
 
   /// Implements the Deserialize function inherited from SerializableCrypto.
   bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
 
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Serializes into a fixed-size buffer, without allocating.
+  bool Serialize(Serialized& dst) const;
+
+  /// Deserializes from a fixed-size buffer. Nothing is allocated once this
+  /// object holds a value.
+  bool Deserialize(const Serialized& src);
+
   /// Assignment operator.
   CommitPointHash& operator=(const CommitPointHash& src);
 
@@ -165,8 +245,7 @@ class Challenge : public SerializableCrypto {
 
   bool constructPreChecks();
   void Set(const CommitPoint& aggregatedCommit, const PubKey& aggregatedPubkey,
-           const std::vector<uint8_t>& message, unsigned int offset,
-           unsigned int size);
+           const uint8_t* message, std::size_t size);
 
  public:
   /// Default constructor for an uninitialized challenge.
@@ -181,6 +260,11 @@ class Challenge : public SerializableCrypto {
             const std::vector<uint8_t>& message, unsigned int offset,
             unsigned int size);
 
+  /// Constructor for generating a new challenge on the size bytes at
+  /// message.
+  Challenge(const CommitPoint& aggregatedCommit, const PubKey& aggregatedPubkey,
+            const uint8_t* message, std::size_t size);
+
   /// Constructor for loading challenge information from a byte stream.
   Challenge(const std::vector<uint8_t>& src, unsigned int offset);
 
@@ -193,12 +277,26 @@ class Challenge : public SerializableCrypto {
   /// Indicates if challenge parameters have been initialized.
   bool Initialized() const;
 
+  /// Fixed-size serialized form.
+  using Serialized = std::array<uint8_t, 32>;
+
   /// Implements the Serialize function inherited from SerializableCrypto.
   bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
 
   /// Implements the Deserialize function inherited from SerializableCrypto.
   bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
 
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Serializes into a fixed-size buffer, without allocating.
+  bool Serialize(Serialized& dst) const;
+
+  /// Deserializes from a fixed-size buffer. Nothing is allocated once this
+  /// object holds a value.
+  bool Deserialize(const Serialized& src);
+
   /// Assignment operator.
   Challenge& operator=(const Challenge& src);
 
@@ -213,6 +311,7 @@ class Response : public SerializableCrypto {
   bool m_initialized{};
 
   friend class MultiSig;
+  friend class PartialAggregate;
 
   bool constructPreChecks();
   void Set(const CommitSecret& secret, const Challenge& challenge,
@@ -238,12 +337,26 @@ class Response : public SerializableCrypto {
   /// Indicates if response parameters have been initialized.
   bool Initialized() const;
 
+  /// Fixed-size serialized form.
+  using Serialized = std::array<uint8_t, 32>;
+
   /// Implements the Serialize function inherited from SerializableCrypto.
   bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
 
   /// Implements the Deserialize function inherited from SerializableCrypto.
   bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
 
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Serializes into a fixed-size buffer, without allocating.
+  bool Serialize(Serialized& dst) const;
+
+  /// Deserializes from a fixed-size buffer. Nothing is allocated once this
+  /// object holds a value.
+  bool Deserialize(const Serialized& src);
+
   /// Assignment operator.
   Response& operator=(const Response& src);
 
@@ -251,6 +364,257 @@ class Response : public SerializableCrypto {
   bool operator==(const Response& r) const;
 };
 
+/// Stores the aggregate of the contributions of a subset of a committee: a
+/// bitmap of the signers with the sums of their commit points, public keys
+/// and, once the challenge is known, responses. Partial aggregates of
+/// disjoint subsets merge with one point addition per sum, and serialize to
+/// a size that only depends on the committee size, so they can be combined
+/// along a multi-level aggregation tree.
+class PartialAggregate : public SerializableCrypto {
+  std::vector<bool> m_signers;
+  CommitPoint m_commit;
+  PubKey m_pubkey;
+  Response m_response;
+  bool m_hasResponse{};
+  bool m_initialized{};
+
+  void set(unsigned int committeeSize, unsigned int index,
+           const PubKey& pubkey, const CommitPoint& commitPoint);
+
+ public:
+  /// Default constructor for an uninitialized partial aggregate.
+  PartialAggregate();
+
+  /// Constructor for the commit phase contribution of the signer at index
+  /// in a committee of committeeSize members.
+  PartialAggregate(unsigned int committeeSize, unsigned int index,
+                   const PubKey& pubkey, const CommitPoint& commitPoint);
+
+  /// Constructor for the response phase contribution of the signer at index
+  /// in a committee of committeeSize members.
+  PartialAggregate(unsigned int committeeSize, unsigned int index,
+                   const PubKey& pubkey, const CommitPoint& commitPoint,
+                   const Response& response);
+
+  /// Constructor for loading a partial aggregate from a byte stream.
+  PartialAggregate(const std::vector<uint8_t>& src, unsigned int offset);
+
+  /// Destructor.
+  ~PartialAggregate();
+
+  /// Indicates if the partial aggregate has been initialized.
+  bool Initialized() const;
+
+  /// Indicates if the partial aggregate includes the summed response.
+  bool HasResponse() const;
+
+  /// Returns the signer bitmap, with one bit per committee member.
+  const std::vector<bool>& GetSigners() const;
+
+  /// Returns the number of signers.
+  std::size_t GetSignerCount() const;
+
+  /// Returns the sum of the commit points of the signers.
+  const CommitPoint& GetCommit() const;
+
+  /// Returns the sum of the public keys of the signers.
+  const PubKey& GetPubKey() const;
+
+  /// Returns the sum of the responses of the signers.
+  const Response& GetResponse() const;
+
+  /// Adds the contributions of other, which must be initialized, come from
+  /// the same committee and phase, and have no signer in common. Returns
+  /// false, leaving this partial aggregate unchanged, otherwise.
+  bool Merge(const PartialAggregate& other);
+
+  /// Returns the serialized size for a committee of committeeSize members.
+  static unsigned int SerializedSize(unsigned int committeeSize);
+
+  /// Implements the Serialize function inherited from SerializableCrypto.
+  bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
+
+  /// Implements the Deserialize function inherited from SerializableCrypto.
+  bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
+
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Equality comparison operator.
+  bool operator==(const PartialAggregate& r) const;
+};
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+// The committee key set, the streaming and compact rounds and the batch
+// response checks run on the built-in secp256k1 arithmetic, and are only
+// available when it is enabled (NATIVE_SECP256K1=ON).
+
+/// Stores the public keys of a committee together with their aggregate, and
+/// derives the aggregated PubKey of any subset of signers from a bitmap.
+/// When most members sign, the keys of the absent ones are subtracted from
+/// the cached aggregate; otherwise the keys of the present ones are added,
+/// so a subset costs at most half the committee size in point additions.
+/// Copies share the same immutable state.
+class CommitteeKeySet {
+  class Impl;
+  std::shared_ptr<const Impl> m_impl;
+
+ public:
+  /// Constructor for a committee with the specified member keys.
+  explicit CommitteeKeySet(const std::vector<PubKey>& pubkeys);
+
+  /// Indicates if the member keys could be converted and aggregated.
+  bool Initialized() const;
+
+  /// Returns the number of members.
+  std::size_t Size() const;
+
+  /// Returns the member keys.
+  const std::vector<PubKey>& GetPubKeys() const;
+
+  /// Returns the aggregate of all member keys.
+  const PubKey& GetAggregatedPubKey() const;
+
+  /// Derives the aggregated PubKey of the members whose bit is set in
+  /// signers, indexed like the member keys. Returns nullptr if the bitmap
+  /// size differs from the committee size or no member is set.
+  std::shared_ptr<PubKey> AggregatePubKeys(
+      const std::vector<bool>& signers) const;
+};
+
+/// Runs the aggregator side of one multisignature round as contributions
+/// arrive. Each commit and response is checked (CommitPointHash and
+/// VerifyResponse) by a background task on the batch worker pool, and valid
+/// ones are added to running sums. The first quorum members with a valid
+/// commit become the signers: the challenge is available once their commits
+/// are in, and the signature once all of their responses are. A signer with
+/// an invalid response is reported as faulty and the round cannot complete;
+/// a new round is then needed without it. All functions are thread safe.
+class MultiSigRound {
+  class Impl;
+  std::shared_ptr<Impl> m_impl;
+
+ public:
+  /// Constructor for a round of the committee over message, which needs
+  /// quorum signers out of the committee size.
+  MultiSigRound(const CommitteeKeySet& committee,
+                const std::vector<uint8_t>& message, unsigned int quorum);
+
+  /// Constructor for a round of the committee over the size bytes at
+  /// message, which are copied once into the round.
+  MultiSigRound(const CommitteeKeySet& committee, const uint8_t* message,
+                std::size_t size, unsigned int quorum);
+
+  /// Destructor. Checks still running complete in the background.
+  ~MultiSigRound();
+
+  MultiSigRound(const MultiSigRound&) = delete;
+  MultiSigRound& operator=(const MultiSigRound&) = delete;
+
+  /// Indicates if the committee is initialized and the quorum is in
+  /// [1, ..., committee size].
+  bool Initialized() const;
+
+  /// Queues the check of the commit of the member at index against the hash
+  /// it sent first. Returns false if the index is invalid, the member has
+  /// already sent a commit or the signers are already known.
+  bool AddCommit(unsigned int index, const CommitPoint& commitPoint,
+                 const CommitPointHash& commitPointHash);
+
+  /// Queues the check of the response of the member at index. Returns false
+  /// if the challenge is not known yet, the member is not a signer or has
+  /// already sent a response.
+  bool AddResponse(unsigned int index, const Response& response);
+
+  /// Returns the challenge for the signers, or nullptr if not known yet.
+  std::shared_ptr<Challenge> GetChallenge() const;
+
+  /// Waits up to timeout for the challenge. Returns nullptr on timeout.
+  std::shared_ptr<Challenge> WaitForChallenge(
+      std::chrono::milliseconds timeout) const;
+
+  /// Returns the aggregated signature, or nullptr if not complete yet.
+  std::shared_ptr<Signature> GetSignature() const;
+
+  /// Waits up to timeout for the aggregated signature. Returns nullptr on
+  /// timeout, or as soon as a signer sent an invalid response.
+  std::shared_ptr<Signature> WaitForSignature(
+      std::chrono::milliseconds timeout) const;
+
+  /// Returns the signer bitmap, with no bit set until the challenge is known.
+  std::vector<bool> GetSigners() const;
+
+  /// Returns the aggregated PubKey of the signers, or nullptr if the
+  /// challenge is not known yet.
+  std::shared_ptr<PubKey> GetAggregatedPubKey() const;
+
+  /// Returns the indices of the members whose commit or response failed its
+  /// check, in the order the checks completed.
+  std::vector<unsigned int> GetFaulty() const;
+};
+
+/// Stores the contributions of the signers of a round in contiguous
+/// fixed-size arrays instead of one OpenSSL object per contribution: the
+/// commit point hashes and responses (32 bytes each, big-endian), the commit
+/// points (64 bytes each, affine coordinates) and the committee index of
+/// each signer's key. A round takes a few allocations whatever its size,
+/// and the MultiSig functions taking a CompactRound read the arrays
+/// directly.
+class CompactRound {
+  CommitteeKeySet m_committee;
+  std::vector<uint32_t> m_keyIndices;
+  std::vector<uint8_t> m_hashes;
+  std::vector<uint8_t> m_commits;
+  std::vector<uint8_t> m_responses;
+  std::vector<uint8_t> m_present;
+  bool m_initialized{};
+
+  friend class MultiSig;
+  friend struct ResponseBatchAccess;
+
+ public:
+  /// Constructor for a round where the signer at slot i holds the key at
+  /// index keyIndices[i] of the committee.
+  CompactRound(const CommitteeKeySet& committee,
+               const std::vector<unsigned int>& keyIndices);
+
+  /// Destructor.
+  ~CompactRound();
+
+  /// Indicates if the committee is initialized and the key indices are
+  /// distinct and within the committee.
+  bool Initialized() const;
+
+  /// Returns the number of signers.
+  std::size_t Size() const;
+
+  /// Returns the committee index of the key of the signer at slot.
+  unsigned int GetKeyIndex(std::size_t slot) const;
+
+  /// Returns the committee bitmap of the signers.
+  std::vector<bool> GetSigners() const;
+
+  /// Stores the commit point hash of the signer at slot.
+  bool SetCommitPointHash(std::size_t slot, const CommitPointHash& hash);
+
+  /// Stores the commit point of the signer at slot.
+  bool SetCommitPoint(std::size_t slot, const CommitPoint& commitPoint);
+
+  /// Stores the response of the signer at slot.
+  bool SetResponse(std::size_t slot, const Response& response);
+
+  /// Indicates if the signer at slot has a commit point matching its hash.
+  bool CheckCommitPointHash(std::size_t slot) const;
+
+  /// Indicates if the signer at slot has a commit point.
+  bool HasCommitPoint(std::size_t slot) const;
+
+  /// Indicates if the signer at slot has a response.
+  bool HasResponse(std::size_t slot) const;
+};
+#endif  // SCHNORR_NATIVE_SECP256K1
+
 /// Implements the functionality for EC-Schnorr multisignature scheme
 /// operations.
 class MultiSig {
@@ -270,6 +634,21 @@ class MultiSig {
   static std::shared_ptr<Response> AggregateResponses(
       const std::vector<Response>& responses);
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+  /// Aggregates the public keys of the signers of a compact round.
+  static std::shared_ptr<PubKey> AggregatePubKeys(const CompactRound& round);
+
+  /// Aggregates the commitments of a compact round. Returns nullptr if a
+  /// signer has no commit point.
+  static std::shared_ptr<CommitPoint> AggregateCommits(
+      const CompactRound& round);
+
+  /// Aggregates the responses of a compact round. Returns nullptr if a
+  /// signer has no response.
+  static std::shared_ptr<Response> AggregateResponses(
+      const CompactRound& round);
+#endif
+
   /// Generates the aggregated signature for the multisignature aggregator.
   static std::shared_ptr<Signature> AggregateSign(
       const Challenge& challenge, const Response& aggregatedResponse);
@@ -279,6 +658,38 @@ class MultiSig {
                              const Challenge& challenge, const PubKey& pubkey,
                              const CommitPoint& commitPoint);
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+  /// Verifies the responses of all signers for the multisignature
+  /// aggregator at once. Returns true only if every response would pass
+  /// VerifyResponse with the PubKey and CommitPoint at the same index.
+  static bool VerifyResponses(const std::vector<Response>& responses,
+                              const Challenge& challenge,
+                              const std::vector<PubKey>& pubkeys,
+                              const std::vector<CommitPoint>& commitPoints);
+
+  /// Finds the signers whose responses fail VerifyResponse, by bisecting
+  /// the round with batch checks, and stores their indices in faulty in
+  /// ascending order. k faulty signers among n take O(k log n) batch
+  /// checks. Returns false if the challenge or the input sizes are invalid.
+  static bool FindFaultyResponses(const std::vector<Response>& responses,
+                                  const Challenge& challenge,
+                                  const std::vector<PubKey>& pubkeys,
+                                  const std::vector<CommitPoint>& commitPoints,
+                                  std::vector<unsigned int>& faulty);
+
+  /// Verifies the responses of all signers of a compact round at once, like
+  /// VerifyResponses.
+  static bool VerifyResponses(const CompactRound& round,
+                              const Challenge& challenge);
+
+  /// Finds the signers of a compact round whose responses fail, like
+  /// FindFaultyResponses, and stores their slots in faulty in ascending
+  /// order.
+  static bool FindFaultyResponses(const CompactRound& round,
+                                  const Challenge& challenge,
+                                  std::vector<unsigned int>& faulty);
+#endif
+
   /// Checks the multi-signature validity using EC curve parameters and the
   /// specified aggregated PubKey.
   static bool MultiSigVerify(const std::vector<uint8_t>& message,
@@ -290,15 +701,51 @@ class MultiSig {
                              unsigned int offset, unsigned int size,
                              const Signature& toverify, const PubKey& pubkey);
 
+  /// Checks the multi-signature validity on the size bytes at message using
+  /// EC curve parameters and the specified aggregated PubKey.
+  static bool MultiSigVerify(const uint8_t* message, std::size_t size,
+                             const Signature& toverify, const PubKey& pubkey);
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+  /// Checks the multi-signature validity using the cached encoding and table
+  /// of the specified aggregated VerifyingKey.
+  static bool MultiSigVerify(const std::vector<uint8_t>& message,
+                             const Signature& toverify,
+                             const VerifyingKey& key);
+
+  /// Checks the multi-signature validity using the cached encoding and table
+  /// of the specified aggregated VerifyingKey.
+  static bool MultiSigVerify(const std::vector<uint8_t>& message,
+                             unsigned int offset, unsigned int size,
+                             const Signature& toverify,
+                             const VerifyingKey& key);
+
+  /// Checks the multi-signature validity on the size bytes at message using
+  /// the cached encoding and table of the specified aggregated VerifyingKey.
+  static bool MultiSigVerify(const uint8_t* message, std::size_t size,
+                             const Signature& toverify,
+                             const VerifyingKey& key);
+#endif
+
   /// Wrapper function for signing PoW message (including public key) for
   /// Proof-of-Possession (PoP) phase
   static bool SignKey(const std::vector<uint8_t>& messageWithPubKey,
                       const PairOfKey& keyPair, Signature& signature);
 
+  /// Wrapper function for signing the size bytes at messageWithPubKey for
+  /// Proof-of-Possession (PoP) phase
+  static bool SignKey(const uint8_t* messageWithPubKey, std::size_t size,
+                      const PairOfKey& keyPair, Signature& signature);
+
   /// Wrapper function for verifying PoW message (including public key) for
   /// Proof-of-Possession (PoP) phase
   static bool VerifyKey(const std::vector<uint8_t>& messageWithPubKey,
                         const Signature& signature, const PubKey& pubKey);
+
+  /// Wrapper function for verifying the size bytes at messageWithPubKey for
+  /// Proof-of-Possession (PoP) phase
+  static bool VerifyKey(const uint8_t* messageWithPubKey, std::size_t size,
+                        const Signature& signature, const PubKey& pubKey);
 };
 
 #endif  // ZILLIQA_SRC_LIBSCHNORR_INCLUDE_MULTISIG_H_
@@ -23,10 +23,14 @@
 
 #include <array>
 #include <boost/functional/hash.hpp>
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "SchnorrConfig.h"
+
 /// Specifies the interface required for classes that are byte serializable.
 class SerializableCrypto {
  public:
@@ -65,12 +69,26 @@ class PrivKey : public SerializableCrypto {
   /// Returns PrivKey from input string
   static PrivKey GetPrivKeyFromString(const std::string&);
 
+  /// Fixed-size serialized form.
+  using Serialized = std::array<uint8_t, 32>;
+
   /// Implements the Serialize function inherited from SerializableCrypto.
   bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
 
   /// Implements the Deserialize function inherited from SerializableCrypto.
   bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
 
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Serializes into a fixed-size buffer, without allocating.
+  bool Serialize(Serialized& dst) const;
+
+  /// Deserializes from a fixed-size buffer. Nothing is allocated once this
+  /// object holds a value.
+  bool Deserialize(const Serialized& src);
+
   /// Assignment operator.
   PrivKey& operator=(const PrivKey&);
 
@@ -80,9 +98,11 @@ class PrivKey : public SerializableCrypto {
 
 /// Stores information on an EC-Schnorr public key.
 class PubKey : public SerializableCrypto {
+  using CompressedPoint = std::array<uint8_t, 33>;
+
   bool constructPreChecks();
-  bool comparePreChecks(const PubKey& r, std::shared_ptr<BIGNUM>& lhs_bnvalue,
-                        std::shared_ptr<BIGNUM>& rhs_bnvalue) const;
+  bool comparePreChecks(const PubKey& r, CompressedPoint& lhs_value,
+                        CompressedPoint& rhs_value) const;
 
  public:
   /// The point on the curve.
@@ -106,12 +126,43 @@ class PubKey : public SerializableCrypto {
   /// Returns PubKey from input string
   static PubKey GetPubKeyFromString(const std::string&);
 
+  /// Fixed-size serialized form.
+  using Serialized = std::array<uint8_t, 33>;
+
   /// Implements the Serialize function inherited from SerializableCrypto.
   bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
 
   /// Implements the Deserialize function inherited from SerializableCrypto.
   bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
 
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Serializes into a fixed-size buffer, without allocating.
+  bool Serialize(Serialized& dst) const;
+
+  /// Deserializes from a fixed-size buffer. With the native backend,
+  /// nothing is allocated once this object holds a value.
+  bool Deserialize(const Serialized& src);
+
+  /// Serializes keys into dst as consecutive Serialized records, one per
+  /// entry, on the batch threads. dst is resized to fit.
+  static bool SerializeAll(const std::vector<PubKey>& keys,
+                           std::vector<uint8_t>& dst);
+
+  /// Deserializes the consecutive Serialized records of the size bytes at
+  /// src into keys, decompressing the points on the batch threads. keys is
+  /// resized to the number of records, and entries already present are
+  /// decoded in place. Fails if size is not a multiple of the record size
+  /// or a record is invalid, in which case keys is left partly decoded.
+  static bool DeserializeAll(const uint8_t* src, std::size_t size,
+                             std::vector<PubKey>& keys);
+
+  /// Deserializes the records that make up src, as above.
+  static bool DeserializeAll(const std::vector<uint8_t>& src,
+                             std::vector<PubKey>& keys);
+
   /// Assignment operator.
   PubKey& operator=(const PubKey& src);
 
@@ -141,8 +192,189 @@ struct hash<PubKey> {
 
 using PairOfKey = std::pair<PrivKey, PubKey>;
 
+class Signature;
+#ifdef SCHNORR_NATIVE_SECP256K1
+// The prepared keys, the nonce pool, the streaming Verifier and
+// R-form signing and verification run on the built-in secp256k1 arithmetic,
+// and are only available when it is enabled (NATIVE_SECP256K1=ON).
+struct PooledNonce;
+
+/// Public key prepared for repeated verification. It caches the compressed
+/// encoding hashed into every challenge and, as long as the process-wide
+/// table memory limit allows, a table of precomputed multiples of the key.
+/// Copies share the same immutable state.
+class VerifyingKey {
+  friend class Schnorr;
+  friend class MultiSig;
+  friend class Verifier;
+
+  class Impl;
+  std::shared_ptr<const Impl> m_impl;
+
+  /// Checks a signature whose challenge is H(prefix | Q | kpub | m).
+  bool verify(const std::vector<uint8_t>& prefix, const uint8_t* message,
+              std::size_t size, const Signature& toverify) const;
+
+ public:
+  /// Table windows: a window of w stores 2^(w-2) multiples of the key and of
+  /// its endomorphism image.
+  static const unsigned int MIN_WINDOW = 2;
+  static const unsigned int MAX_WINDOW = 12;
+  static const unsigned int DEFAULT_WINDOW = 8;
+
+  /// Default process-wide limit on the table memory of all keys (16 MiB).
+  static const std::size_t DEFAULT_TABLE_MEMORY_LIMIT = 16 * 1024 * 1024;
+
+  /// Constructor for preparing a PubKey, with the window clamped to
+  /// [MIN_WINDOW, MAX_WINDOW]. Without room under the memory limit the key
+  /// is verified without a table.
+  explicit VerifyingKey(const PubKey& pubkey,
+                        unsigned int window = DEFAULT_WINDOW);
+
+  /// Returns the key as a PubKey.
+  const PubKey& GetPubKey() const;
+
+  /// Returns the 33-byte compressed encoding of the key.
+  const std::array<uint8_t, 33>& GetCompressed() const;
+
+  /// Returns the memory held by the table of this key, or 0 without one.
+  std::size_t GetTableSize() const;
+
+  /// Sets the limit on the table memory of all keys. Tables that already
+  /// exist are kept; the limit applies to keys constructed afterwards.
+  static void SetTableMemoryLimit(std::size_t limit);
+
+  /// Returns the limit on the table memory of all keys.
+  static std::size_t GetTableMemoryLimit();
+
+  /// Returns the table memory currently held by all keys.
+  static std::size_t GetTableMemoryUsage();
+};
+#endif  // SCHNORR_NATIVE_SECP256K1
+
 std::ostream& operator<<(std::ostream& os, const PubKey& p);
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+/// Private key prepared for repeated signing. It holds the scalar in native
+/// form and the compressed encoding of the matching public key, so signing
+/// needs no OpenSSL BIGNUM or EC_POINT arithmetic. Signing does not modify
+/// the key, so it is thread safe.
+class SigningKey {
+  friend class Schnorr;
+
+  class Impl;
+  std::unique_ptr<Impl> m_impl;
+
+ public:
+  /// Constructor for preparing a PrivKey, deriving the matching PubKey.
+  explicit SigningKey(const PrivKey& privkey);
+
+  /// Copy constructor.
+  SigningKey(const SigningKey& src);
+
+  /// Destructor. Clears the private scalar.
+  ~SigningKey();
+
+  /// Assignment operator.
+  SigningKey& operator=(const SigningKey& src);
+
+  /// Returns the public key matching the private key.
+  const PubKey& GetPubKey() const;
+
+  /// Returns the 33-byte compressed encoding of the public key.
+  const std::array<uint8_t, 33>& GetCompressed() const;
+};
+
+/// Pool of random nonces precomputed by a background thread, each with its
+/// commitment kG and the hash of kG used as a multisignature commit point
+/// hash. Signing with a SigningKey and the multisignature commit phase then
+/// take a nonce from the pool instead of doing a generator multiplication.
+/// Each nonce is handed out at most once, and is cleared from the pool when
+/// taken or when the pool is destroyed. If the pool runs empty, nonces are
+/// generated on the calling thread. A child created by fork() discards the
+/// nonces copied from its parent and generates each nonce on the calling
+/// thread, so parent and child never share one. All functions are thread
+/// safe.
+class NoncePool {
+  friend class Schnorr;
+  friend class CommitSecret;
+
+  class Impl;
+  std::unique_ptr<Impl> m_impl;
+
+  /// Moves a nonce out of the pool, or generates one if it is empty.
+  bool take(PooledNonce& nonce);
+
+ public:
+  /// Default number of nonces kept ready.
+  static const std::size_t DEFAULT_CAPACITY = 256;
+
+  /// Constructor for a pool keeping capacity nonces ready, which starts
+  /// filling it in the background.
+  explicit NoncePool(std::size_t capacity = DEFAULT_CAPACITY);
+
+  /// Destructor. Stops the background thread and clears the nonces left.
+  ~NoncePool();
+
+  NoncePool(const NoncePool&) = delete;
+  NoncePool& operator=(const NoncePool&) = delete;
+
+  /// Returns the number of nonces kept ready.
+  std::size_t Capacity() const;
+
+  /// Returns the number of nonces currently ready.
+  std::size_t Size() const;
+
+  /// Waits up to timeout for the pool to be full. Returns whether it is.
+  bool WaitUntilFull(std::chrono::milliseconds timeout) const;
+};
+
+/// A buffer owned by the caller, holding a message or one of the pieces of
+/// a message scattered over several buffers.
+struct MessageSegment {
+  const uint8_t* data;
+  std::size_t size;
+};
+
+/// Checks a signature on a message fed in pieces, without copying them into
+/// one vector. The commitment is recovered from the signature on
+/// construction, so the message is hashed as it arrives. Accepts exactly
+/// the signatures Schnorr::Verify accepts for the concatenated pieces. The
+/// Verifier keeps a copy of the VerifyingKey.
+class Verifier {
+  class Impl;
+  std::unique_ptr<Impl> m_impl;
+
+ public:
+  /// Constructor for checking the specified signature with the specified
+  /// VerifyingKey.
+  Verifier(const VerifyingKey& key, const Signature& toverify);
+
+  /// Destructor.
+  ~Verifier();
+
+  Verifier(const Verifier&) = delete;
+  Verifier& operator=(const Verifier&) = delete;
+
+  /// Returns false if the key or signature is invalid, in which case
+  /// Finalize fails without reading the message.
+  bool Initialized() const;
+
+  /// Appends size bytes at data to the message.
+  bool Update(const uint8_t* data, std::size_t size);
+
+  /// Appends a byte vector to the message.
+  bool Update(const std::vector<uint8_t>& message);
+
+  /// Appends count segments to the message, in order.
+  bool Update(const MessageSegment* segments, std::size_t count);
+
+  /// Returns true if the signature is valid for the message fed so far.
+  /// Fails for an empty message. No more input is accepted afterwards.
+  bool Finalize();
+};
+#endif  // SCHNORR_NATIVE_SECP256K1
+
 /// Stores information on an EC-Schnorr signature.
 class Signature : public SerializableCrypto {
   bool constructPreChecks();
@@ -166,12 +398,26 @@ class Signature : public SerializableCrypto {
   /// Destructor.
   ~Signature();
 
+  /// Fixed-size serialized form.
+  using Serialized = std::array<uint8_t, 64>;
+
   /// Implements the Serialize function inherited from SerializableCrypto.
   bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
 
   /// Implements the Deserialize function inherited from SerializableCrypto.
   bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
 
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Serializes into a fixed-size buffer, without allocating.
+  bool Serialize(Serialized& dst) const;
+
+  /// Deserializes from a fixed-size buffer. Nothing is allocated once this
+  /// object holds a value.
+  bool Deserialize(const Serialized& src);
+
   /// Assignment operator.
   Signature& operator=(const Signature&);
 
@@ -184,6 +430,86 @@ class Signature : public SerializableCrypto {
 
 std::ostream& operator<<(std::ostream& os, const Signature& s);
 
+/// Stores information on an EC-Schnorr signature in the R form, which holds
+/// the commitment point instead of the challenge. The challenge and response
+/// are those of Signature, but keeping the point lets many signatures be
+/// checked together with Schnorr::BatchVerifyR, with the native backend.
+class SignatureR : public SerializableCrypto {
+  bool constructPreChecks();
+
+ public:
+  /// Commitment point.
+  std::shared_ptr<EC_POINT> m_R;
+
+  /// Response scalar.
+  std::shared_ptr<BIGNUM> m_s;
+
+  /// Default constructor.
+  SignatureR();
+
+  /// Constructor for loading existing signature from a byte stream.
+  SignatureR(const std::vector<uint8_t>& src, unsigned int offset);
+
+  /// Copy constructor.
+  SignatureR(const SignatureR&);
+
+  /// Destructor.
+  ~SignatureR();
+
+  /// Fixed-size serialized form.
+  using Serialized = std::array<uint8_t, 65>;
+
+  /// Implements the Serialize function inherited from SerializableCrypto.
+  bool Serialize(std::vector<uint8_t>& dst, unsigned int offset) const;
+
+  /// Implements the Deserialize function inherited from SerializableCrypto.
+  bool Deserialize(const std::vector<uint8_t>& src, unsigned int offset);
+
+  /// Deserializes from the start of the size bytes at src, without copying
+  /// them into a vector.
+  bool Deserialize(const uint8_t* src, std::size_t size);
+
+  /// Serializes into a fixed-size buffer, without allocating.
+  bool Serialize(Serialized& dst) const;
+
+  /// Deserializes from a fixed-size buffer. With the native backend,
+  /// nothing is allocated once this object holds a value.
+  bool Deserialize(const Serialized& src);
+
+  /// Assignment operator.
+  SignatureR& operator=(const SignatureR&);
+
+  /// Equality comparison operator.
+  bool operator==(const SignatureR& r) const;
+
+  /// Utility std::string conversion function for signature info.
+  explicit operator std::string() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const SignatureR& s);
+
+/// One signature for Schnorr::VerifyBatch: the message bytes, signature and
+/// public key it refers to are owned by the caller and must outlive the call.
+struct VerifyBatchItem {
+  const uint8_t* message;
+  std::size_t size;
+  const Signature* signature;
+  const PubKey* pubkey;
+
+  /// Constructor for a signature on a whole message.
+  VerifyBatchItem(const std::vector<uint8_t>& message,
+                  const Signature& signature, const PubKey& pubkey);
+
+  /// Constructor for a signature on a message range.
+  VerifyBatchItem(const std::vector<uint8_t>& message, unsigned int offset,
+                  unsigned int size, const Signature& signature,
+                  const PubKey& pubkey);
+
+  /// Constructor for a signature on the size bytes at message.
+  VerifyBatchItem(const uint8_t* message, std::size_t size,
+                  const Signature& signature, const PubKey& pubkey);
+};
+
 /// Implements the Elliptic Curve Based Schnorr Signature algorithm.
 class Schnorr {
   /// Stores the NID_secp256k1 curve parameters for the elliptic curve scheme
@@ -220,6 +546,52 @@ class Schnorr {
                    unsigned int size, const PrivKey& privkey,
                    const PubKey& pubkey, Signature& result);
 
+  /// Signs the size bytes at message using the EC curve parameters and the
+  /// specified key pair.
+  static bool Sign(const uint8_t* message, std::size_t size,
+                   const PrivKey& privkey, const PubKey& pubkey,
+                   Signature& result);
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+  /// Signs a message with the native scalar and cached public key encoding
+  /// of the specified SigningKey.
+  static bool Sign(const std::vector<uint8_t>& message, const SigningKey& key,
+                   Signature& result);
+
+  /// Signs a message with the native scalar and cached public key encoding
+  /// of the specified SigningKey.
+  static bool Sign(const std::vector<uint8_t>& message, unsigned int offset,
+                   unsigned int size, const SigningKey& key, Signature& result);
+
+  /// Signs the size bytes at message with the native scalar and cached
+  /// public key encoding of the specified SigningKey.
+  static bool Sign(const uint8_t* message, std::size_t size,
+                   const SigningKey& key, Signature& result);
+
+  /// Signs the concatenation of count segments with the specified
+  /// SigningKey, without copying them into one buffer. The segments are read
+  /// twice, for the nonce and then for the challenge, and must not change
+  /// during the call.
+  static bool Sign(const MessageSegment* segments, std::size_t count,
+                   const SigningKey& key, Signature& result);
+
+  /// Signs a message with the specified SigningKey, using a nonce taken
+  /// from the specified NoncePool.
+  static bool Sign(const std::vector<uint8_t>& message, const SigningKey& key,
+                   NoncePool& pool, Signature& result);
+
+  /// Signs a message with the specified SigningKey, using a nonce taken
+  /// from the specified NoncePool.
+  static bool Sign(const std::vector<uint8_t>& message, unsigned int offset,
+                   unsigned int size, const SigningKey& key, NoncePool& pool,
+                   Signature& result);
+
+  /// Signs the size bytes at message with the specified SigningKey, using a
+  /// nonce taken from the specified NoncePool.
+  static bool Sign(const uint8_t* message, std::size_t size,
+                   const SigningKey& key, NoncePool& pool, Signature& result);
+#endif
+
   /// Checks the signature validity using the EC curve parameters and the
   /// specified PubKey.
   static bool Verify(const std::vector<uint8_t>& message,
@@ -231,6 +603,119 @@ class Schnorr {
                      unsigned int size, const Signature& toverify,
                      const PubKey& pubkey);
 
+  /// Checks the signature validity on the size bytes at message using the
+  /// EC curve parameters and the specified PubKey.
+  static bool Verify(const uint8_t* message, std::size_t size,
+                     const Signature& toverify, const PubKey& pubkey);
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+  /// Checks the signature validity using the cached encoding and table of
+  /// the specified VerifyingKey.
+  static bool Verify(const std::vector<uint8_t>& message,
+                     const Signature& toverify, const VerifyingKey& key);
+
+  /// Checks the signature validity using the cached encoding and table of
+  /// the specified VerifyingKey.
+  static bool Verify(const std::vector<uint8_t>& message, unsigned int offset,
+                     unsigned int size, const Signature& toverify,
+                     const VerifyingKey& key);
+
+  /// Checks the signature validity on the size bytes at message using the
+  /// cached encoding and table of the specified VerifyingKey.
+  static bool Verify(const uint8_t* message, std::size_t size,
+                     const Signature& toverify, const VerifyingKey& key);
+#endif
+
+  /// Checks count signatures like Verify, spread over the batch threads, and
+  /// stores the result of each one in valid. Returns true only if the batch
+  /// is not empty and every signature is valid.
+  static bool VerifyBatch(const VerifyBatchItem* items, std::size_t count,
+                          std::vector<bool>& valid);
+
+  /// Checks the signatures of items like Verify, spread over the batch
+  /// threads, and stores the result of each one in valid. Returns true only
+  /// if the batch is not empty and every signature is valid.
+  static bool VerifyBatch(const std::vector<VerifyBatchItem>& items,
+                          std::vector<bool>& valid);
+
+  /// Sets the number of threads, the calling one included, over which the
+  /// batch operations spread their work. 0 selects the number of cores,
+  /// which is the default.
+  static void SetBatchThreads(unsigned int threads);
+
+  /// Returns the number of threads used by the batch operations.
+  static unsigned int GetBatchThreads();
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+  /// Signs a message into an R-form signature using the EC curve parameters
+  /// and the specified key pair.
+  static bool SignR(const std::vector<uint8_t>& message,
+                    const PrivKey& privkey, const PubKey& pubkey,
+                    SignatureR& result);
+
+  /// Signs a message into an R-form signature using the EC curve parameters
+  /// and the specified key pair.
+  static bool SignR(const std::vector<uint8_t>& message, unsigned int offset,
+                    unsigned int size, const PrivKey& privkey,
+                    const PubKey& pubkey, SignatureR& result);
+
+  /// Signs the size bytes at message into an R-form signature using the EC
+  /// curve parameters and the specified key pair.
+  static bool SignR(const uint8_t* message, std::size_t size,
+                    const PrivKey& privkey, const PubKey& pubkey,
+                    SignatureR& result);
+
+  /// Signs a message into an R-form signature with the specified
+  /// SigningKey.
+  static bool SignR(const std::vector<uint8_t>& message, const SigningKey& key,
+                    SignatureR& result);
+
+  /// Signs a message into an R-form signature with the specified
+  /// SigningKey.
+  static bool SignR(const std::vector<uint8_t>& message, unsigned int offset,
+                    unsigned int size, const SigningKey& key,
+                    SignatureR& result);
+
+  /// Signs the size bytes at message into an R-form signature with the
+  /// specified SigningKey.
+  static bool SignR(const uint8_t* message, std::size_t size,
+                    const SigningKey& key, SignatureR& result);
+
+  /// Signs the concatenation of count segments into an R-form signature with
+  /// the specified SigningKey, reading the segments twice like Sign.
+  static bool SignR(const MessageSegment* segments, std::size_t count,
+                    const SigningKey& key, SignatureR& result);
+
+  /// Checks the R-form signature validity using the EC curve parameters and
+  /// the specified PubKey.
+  static bool VerifyR(const std::vector<uint8_t>& message,
+                      const SignatureR& toverify, const PubKey& pubkey);
+
+  /// Checks the R-form signature validity using the EC curve parameters and
+  /// the specified PubKey.
+  static bool VerifyR(const std::vector<uint8_t>& message, unsigned int offset,
+                      unsigned int size, const SignatureR& toverify,
+                      const PubKey& pubkey);
+
+  /// Checks the R-form signature validity on the size bytes at message using
+  /// the EC curve parameters and the specified PubKey.
+  static bool VerifyR(const uint8_t* message, std::size_t size,
+                      const SignatureR& toverify, const PubKey& pubkey);
+
+  /// Checks n R-form signatures at once with a single randomized
+  /// multi-scalar multiplication. Returns true only if every signature would
+  /// pass VerifyR with the message and PubKey at the same index.
+  static bool BatchVerifyR(const std::vector<std::vector<uint8_t>>& messages,
+                           const std::vector<SignatureR>& signatures,
+                           const std::vector<PubKey>& pubkeys);
+
+  /// Same as above for count messages given as buffers owned by the caller,
+  /// with the signatures and PubKeys at the same index.
+  static bool BatchVerifyR(const MessageSegment* messages,
+                           const SignatureR* signatures, const PubKey* pubkeys,
+                           std::size_t count);
+#endif
+
   /// Utility function for printing EC_POINT coordinates.
   static std::string PrintPoint(const EC_POINT* point);
 };
@@ -24,8 +24,6 @@
 
 using namespace std;
 
-std::mutex m_mutexBIGNUM;
-
 shared_ptr<BIGNUM> BIGNUMSerialize::GetNumber(const bytes& src,
                                               unsigned int offset,
                                               unsigned int size) {
@@ -40,11 +38,17 @@ shared_ptr<BIGNUM> BIGNUMSerialize::GetNumber(const bytes& src,
     return nullptr;
   }
 
-  // This mutex is to prevent multi-threaded issues with the use of openssl
-  // functions
-  lock_guard<mutex> g(m_mutexBIGNUM);
-  return shared_ptr<BIGNUM>(BN_bin2bn(src.data() + offset, size, NULL),
-                            BN_clear_free);
+  return GetNumber(src.data() + offset, size);
+}
+
+shared_ptr<BIGNUM> BIGNUMSerialize::GetNumber(const uint8_t* src,
+                                              unsigned int size) {
+  return shared_ptr<BIGNUM>(BN_bin2bn(src, size, NULL), BN_clear_free);
+}
+
+bool BIGNUMSerialize::GetNumber(BIGNUM* dst, const uint8_t* src,
+                                unsigned int size) {
+  return BN_bin2bn(src, size, dst) != NULL;
 }
 
 void BIGNUMSerialize::SetNumber(bytes& dst, unsigned int offset,
@@ -56,10 +60,6 @@ void BIGNUMSerialize::SetNumber(bytes& dst, unsigned int offset,
     return;
   }
 
-  // This mutex is to prevent multi-threaded issues with the use of openssl
-  // functions
-  lock_guard<mutex> g(m_mutexBIGNUM);
-
   const int actual_bn_size = BN_num_bytes(value.get());
 
   if (actual_bn_size <= static_cast<int>(size)) {
@@ -80,3 +80,13 @@ void BIGNUMSerialize::SetNumber(bytes& dst, unsigned int offset,
     // BIGNUM size > declared size
   }
 }
+
+bool BIGNUMSerialize::SetNumber(uint8_t* dst, unsigned int size,
+                                const BIGNUM* value) {
+  if (BN_bn2binpad(value, dst, size) < 0) {
+    // BIGNUM size > declared size
+    return false;
+  }
+
+  return true;
+}
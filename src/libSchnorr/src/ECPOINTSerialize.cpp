@@ -21,62 +21,136 @@
 
 #include "Schnorr.h"
 #include "SchnorrInternal.h"
+#ifdef SCHNORR_NATIVE_SECP256K1
+#include "Secp256k1Group.h"
+#endif
 
 using namespace std;
 
-std::mutex m_mutexECPOINT;
-
 shared_ptr<EC_POINT> ECPOINTSerialize::GetNumber(const bytes& src,
                                                  unsigned int offset,
                                                  unsigned int size) {
-  shared_ptr<BIGNUM> bnvalue = BIGNUMSerialize::GetNumber(src, offset, size);
+  // Check for offset overflow
+  if ((offset + size) < size) {
+    // Overflow detected
+    return nullptr;
+  }
 
-  if (bnvalue == nullptr) {
-    // BIGNUMSerialize::GetNumber failed
+  if (offset + size > src.size()) {
+    // Can't get ECPOINT
     return nullptr;
   }
 
-  // This mutex is to prevent multi-threaded issues with the use of openssl
-  // functions
-  lock_guard<mutex> g(m_mutexECPOINT);
+  return GetNumber(src.data() + offset, size);
+}
 
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
+shared_ptr<EC_POINT> ECPOINTSerialize::GetNumber(const uint8_t* src,
+                                                 unsigned int size) {
+  shared_ptr<EC_POINT> result(EC_POINT_new(Schnorr::GetCurveGroup()),
+                              EC_POINT_clear_free);
+  if (result == nullptr) {
     // Memory allocation failure
     throw std::bad_alloc();
   }
 
-  return shared_ptr<EC_POINT>(EC_POINT_bn2point(Schnorr::GetCurveGroup(),
-                                                bnvalue.get(), NULL, ctx.get()),
-                              EC_POINT_clear_free);
+  if (!GetNumber(result.get(), src, size)) {
+    // ECPOINTSerialize::GetNumber failed
+    return nullptr;
+  }
+
+  return result;
+}
+
+bool ECPOINTSerialize::GetNumber(EC_POINT* dst, const uint8_t* src,
+                                 unsigned int size) {
+  // Leading zeroes are padding added by SetNumber
+  const uint8_t* begin = src;
+  const uint8_t* end = begin + size;
+  while ((begin != end) && (*begin == 0x00)) {
+    begin++;
+  }
+
+  if (begin == end) {
+    // An all-zero field is the point at infinity
+    return EC_POINT_set_to_infinity(Schnorr::GetCurveGroup(), dst) != 0;
+  }
+
+  ScratchFrame frame;
+#ifdef SCHNORR_NATIVE_SECP256K1
+  if (static_cast<size_t>(end - begin) == PUB_KEY_SIZE) {
+    // EC_POINT_oct2point allocates for the square root, so compressed points
+    // are decompressed natively and stored uncompressed
+    secp256k1::GeAffine point;
+    if (!point.ParseVar(begin, PUB_KEY_SIZE)) {
+      // Not a point on the curve
+      return false;
+    }
+    return secp256k1::StorePoint(dst, point, frame.Ctx());
+  }
+#endif
+
+  if (EC_POINT_oct2point(Schnorr::GetCurveGroup(), dst, begin, end - begin,
+                         frame.Ctx()) == 0) {
+    // EC_POINT_oct2point failed
+    return false;
+  }
+
+  return true;
 }
 
 void ECPOINTSerialize::SetNumber(bytes& dst, unsigned int offset,
                                  unsigned int size,
                                  const shared_ptr<EC_POINT>& value) {
-  shared_ptr<BIGNUM> bnvalue;
+  // Check for offset overflow
+  if ((offset + size) < size) {
+    // Overflow detected
+    return;
+  }
+
+  array<uint8_t, Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES> buf{};
 
-  {
-    // This mutex is to prevent multi-threaded issues with the use of openssl
-    // functions
-    std::lock_guard<mutex> g(m_mutexECPOINT);
+  ScratchFrame frame;
+  const size_t actual_size = EC_POINT_point2oct(
+      Schnorr::GetCurveGroup(), value.get(), POINT_CONVERSION_COMPRESSED,
+      buf.data(), buf.size(), frame.Ctx());
 
-    unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-    if (ctx == nullptr) {
-      // Memory allocation failure
-      throw std::bad_alloc();
+  if (actual_size == 0) {
+    // EC_POINT_point2oct failed
+    return;
+  }
+
+  if (actual_size <= size) {
+    if (offset + size > dst.size()) {
+      dst.resize(offset + size);
     }
 
-    bnvalue.reset(
-        EC_POINT_point2bn(Schnorr::GetCurveGroup(), value.get(),
-                          POINT_CONVERSION_COMPRESSED, NULL, ctx.get()),
-        BN_clear_free);
+    // Pad with zeroes as needed
+    const unsigned int size_diff = size - actual_size;
+    fill(dst.begin() + offset, dst.begin() + offset + size_diff, 0x00);
+    copy(buf.begin(), buf.begin() + actual_size,
+         dst.begin() + offset + size_diff);
+  } else {
+    // ECPOINT size > declared size
   }
+}
 
-  if (bnvalue == nullptr) {
-    // EC_POINT_point2bn failed
-    return;
+bool ECPOINTSerialize::SetNumber(uint8_t* dst, unsigned int size,
+                                 const EC_POINT* value) {
+  array<uint8_t, Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES> buf{};
+
+  ScratchFrame frame;
+  const size_t actual_size = EC_POINT_point2oct(
+      Schnorr::GetCurveGroup(), value, POINT_CONVERSION_COMPRESSED, buf.data(),
+      buf.size(), frame.Ctx());
+
+  if ((actual_size == 0) || (actual_size > size)) {
+    // EC_POINT_point2oct failed or ECPOINT size > declared size
+    return false;
   }
 
-  BIGNUMSerialize::SetNumber(dst, offset, size, bnvalue);
+  // Pad with zeroes as needed
+  const unsigned int size_diff = size - actual_size;
+  fill(dst, dst + size_diff, 0x00);
+  copy(buf.begin(), buf.begin() + actual_size, dst + size_diff);
+  return true;
 }
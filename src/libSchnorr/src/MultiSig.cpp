@@ -15,17 +15,112 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "MultiSig.h"
 #include "SchnorrInternal.h"
+#ifdef SCHNORR_NATIVE_SECP256K1
+#include "Secp256k1Group.h"
+#endif
 
 using namespace std;
 
-std::mutex m_mutexMultiSigVerify;
-
 MultiSig::MultiSig() {}
 
 MultiSig::~MultiSig() {}
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+namespace {
+
+/// Adds the partial sums of the chunks into parts[0] by pairwise tree
+/// reduction, running the additions of each level in parallel.
+template <class T, class AddFn>
+void TreeReduce(vector<T>& parts, const AddFn& add) {
+  for (size_t stride = 1; stride < parts.size(); stride *= 2) {
+    const size_t pairs = (parts.size() + 2 * stride - 1) / (2 * stride);
+    WorkerPool::Get().ParallelFor(pairs, [&parts, &add, stride](size_t j) {
+      const size_t left = 2 * stride * j;
+      if (left + stride < parts.size()) {
+        add(parts[left], parts[left + stride]);
+      }
+    });
+  }
+}
+
+/// Sums the n points returned by point in Jacobian coordinates, with the
+/// chunks and the tree reduction spread over the batch threads, and a
+/// single conversion to affine at the end. Returns false if a point cannot
+/// be converted.
+bool SumPoints(EC_POINT* r, size_t n,
+               const function<const EC_POINT*(size_t)>& point) {
+  vector<secp256k1::GeJacobian> sums((n + BULK_CHUNK_SIZE - 1) /
+                                     BULK_CHUNK_SIZE);
+  for (auto& sum : sums) {
+    sum.SetInfinity();
+  }
+
+  // Each chunk is summed by a single task into its own partial sum
+  auto add = [&sums, &point](size_t i) {
+    ScratchFrame frame;
+    secp256k1::GeAffine p;
+    if (!secp256k1::LoadPoint(p, point(i), frame.Ctx())) {
+      // Point conversion failed
+      return false;
+    }
+    secp256k1::GeJacobian& sum = sums[i / BULK_CHUNK_SIZE];
+    sum.AddAffineVar(sum, p);
+    return true;
+  };
+  if (!ParallelForChunks(n, BULK_CHUNK_SIZE, add)) {
+    return false;
+  }
+
+  TreeReduce(sums,
+             [](secp256k1::GeJacobian& a, const secp256k1::GeJacobian& b) {
+               a.AddVar(a, b);
+             });
+
+  secp256k1::GeAffine sum;
+  sum.SetJacobianVar(sums[0]);
+  ScratchFrame frame;
+  return secp256k1::StorePoint(r, sum, frame.Ctx());
+}
+
+/// Sums the n scalars returned by scalar modulo the order, with the chunks
+/// and the tree reduction spread over the batch threads. Returns false if a
+/// scalar cannot be converted.
+bool SumScalars(BIGNUM* r, size_t n,
+                const function<const BIGNUM*(size_t)>& scalar) {
+  // Sum with a single reduction at the end of each chunk
+  vector<secp256k1::ScalarSum> chunkSums((n + BULK_CHUNK_SIZE - 1) /
+                                         BULK_CHUNK_SIZE);
+  auto add = [&chunkSums, &scalar](size_t i) {
+    secp256k1::Scalar a;
+    if (!secp256k1::LoadScalar(a, scalar(i))) {
+      // Scalar conversion failed
+      return false;
+    }
+    chunkSums[i / BULK_CHUNK_SIZE].Add(a);
+    return true;
+  };
+  if (!ParallelForChunks(n, BULK_CHUNK_SIZE, add)) {
+    return false;
+  }
+
+  vector<secp256k1::Scalar> sums;
+  sums.reserve(chunkSums.size());
+  for (const auto& sum : chunkSums) {
+    sums.push_back(sum.Get());
+  }
+  TreeReduce(sums, [](secp256k1::Scalar& a, const secp256k1::Scalar& b) {
+    a.Add(a, b);
+  });
+  return secp256k1::StoreScalar(r, sums[0]);
+}
+
+}  // namespace
+#endif
+
 shared_ptr<PubKey> MultiSig::AggregatePubKeys(const vector<PubKey>& pubkeys) {
   if (pubkeys.size() == 0) {
     // Empty list of public keys
@@ -38,14 +133,25 @@ shared_ptr<PubKey> MultiSig::AggregatePubKeys(const vector<PubKey>& pubkeys) {
     throw std::bad_alloc();
   }
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+  if (pubkeys.size() > 1) {
+    if (!SumPoints(aggregatedPubkey->m_P.get(), pubkeys.size(),
+                   [&pubkeys](size_t i) { return pubkeys[i].m_P.get(); })) {
+      // Pubkey aggregation failed
+      return nullptr;
+    }
+  }
+#else
+  ScratchFrame frame;
   for (unsigned int i = 1; i < pubkeys.size(); i++) {
     if (EC_POINT_add(Schnorr::GetCurveGroup(), aggregatedPubkey->m_P.get(),
                      aggregatedPubkey->m_P.get(), pubkeys.at(i).m_P.get(),
-                     NULL) == 0) {
+                     frame.Ctx()) == 0) {
       // Pubkey aggregation failed
       return nullptr;
     }
   }
+#endif
 
   return aggregatedPubkey;
 }
@@ -63,14 +169,26 @@ shared_ptr<CommitPoint> MultiSig::AggregateCommits(
     throw std::bad_alloc();
   }
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+  if (commitPoints.size() > 1) {
+    if (!SumPoints(
+            aggregatedCommit->m_p.get(), commitPoints.size(),
+            [&commitPoints](size_t i) { return commitPoints[i].m_p.get(); })) {
+      // Commit aggregation failed
+      return nullptr;
+    }
+  }
+#else
+  ScratchFrame frame;
   for (unsigned int i = 1; i < commitPoints.size(); i++) {
     if (EC_POINT_add(Schnorr::GetCurveGroup(), aggregatedCommit->m_p.get(),
                      aggregatedCommit->m_p.get(), commitPoints.at(i).m_p.get(),
-                     NULL) == 0) {
+                     frame.Ctx()) == 0) {
       // Commit aggregation failed
       return nullptr;
     }
   }
+#endif
 
   return aggregatedCommit;
 }
@@ -88,23 +206,114 @@ shared_ptr<Response> MultiSig::AggregateResponses(
     throw std::bad_alloc();
   }
 
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    // Memory allocation failure
-    throw std::bad_alloc();
+#ifdef SCHNORR_NATIVE_SECP256K1
+  if (responses.size() > 1) {
+    if (!SumScalars(
+            aggregatedResponse->m_r.get(), responses.size(),
+            [&responses](size_t i) { return responses[i].m_r.get(); })) {
+      // Response aggregation failed
+      return nullptr;
+    }
   }
-
+#else
+  ScratchFrame frame;
   for (unsigned int i = 1; i < responses.size(); i++) {
     if (BN_mod_add(aggregatedResponse->m_r.get(), aggregatedResponse->m_r.get(),
                    responses.at(i).m_r.get(), Schnorr::GetCurveOrder(),
-                   ctx.get()) == 0) {
+                   frame.Ctx()) == 0) {
       // Response aggregation failed
       return nullptr;
     }
   }
+#endif
+
+  return aggregatedResponse;
+}
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+namespace {
+
+/// Reads a commit point stored by a CompactRound, which checked it when
+/// storing it.
+void LoadCompactCommit(secp256k1::GeAffine& r, const uint8_t* in) {
+  r.x.SetB32(in);
+  r.y.SetB32(in + COMPACT_COMMIT_POINT_SIZE / 2);
+  r.infinity = false;
+}
+
+}  // namespace
+
+shared_ptr<PubKey> MultiSig::AggregatePubKeys(const CompactRound& round) {
+  if (!round.Initialized()) {
+    // Round not initialized
+    return nullptr;
+  }
+
+  return round.m_committee.AggregatePubKeys(round.GetSigners());
+}
+
+shared_ptr<CommitPoint> MultiSig::AggregateCommits(const CompactRound& round) {
+  if (!round.Initialized()) {
+    // Round not initialized
+    return nullptr;
+  }
+
+  secp256k1::GeJacobian sum;
+  sum.SetInfinity();
+  for (size_t i = 0; i < round.Size(); i++) {
+    if (!round.HasCommitPoint(i)) {
+      // Commit point missing
+      return nullptr;
+    }
+
+    secp256k1::GeAffine commit;
+    LoadCompactCommit(commit,
+                      round.m_commits.data() + i * COMPACT_COMMIT_POINT_SIZE);
+    sum.AddAffineVar(sum, commit);
+  }
+
+  secp256k1::GeAffine aggregated;
+  aggregated.SetJacobianVar(sum);
+
+  auto aggregatedCommit = make_shared<CommitPoint>();
+  ScratchFrame frame;
+  if (!secp256k1::StorePoint(aggregatedCommit->m_p.get(), aggregated,
+                             frame.Ctx())) {
+    // Commit aggregation failed
+    return nullptr;
+  }
+  aggregatedCommit->m_initialized = true;
+
+  return aggregatedCommit;
+}
+
+shared_ptr<Response> MultiSig::AggregateResponses(const CompactRound& round) {
+  if (!round.Initialized()) {
+    // Round not initialized
+    return nullptr;
+  }
+
+  secp256k1::ScalarSum sum;
+  for (size_t i = 0; i < round.Size(); i++) {
+    secp256k1::Scalar response;
+    if (!round.HasResponse(i) ||
+        !response.SetB32(round.m_responses.data() + i * RESPONSE_SIZE)) {
+      // Response missing or not in range
+      return nullptr;
+    }
+    sum.Add(response);
+  }
+
+  auto aggregatedResponse = make_shared<Response>();
+  if (!secp256k1::StoreScalar(aggregatedResponse->m_r.get(), sum.Get())) {
+    // Response aggregation failed
+    return nullptr;
+  }
+  aggregatedResponse->m_initialized = true;
 
   return aggregatedResponse;
 }
+#endif
 
 shared_ptr<Signature> MultiSig::AggregateSign(
     const Challenge& challenge, const Response& aggregatedResponse) {
@@ -165,11 +374,11 @@ bool MultiSig::VerifyResponse(const Response& response,
     bool err = false;
 
     // Regenerate the commitmment part of the signature
-    unique_ptr<EC_POINT, void (*)(EC_POINT*)> Q(
-        EC_POINT_new(Schnorr::GetCurveGroup()), EC_POINT_clear_free);
-    unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+    ScratchFrame frame;
+    EC_POINT* Q = frame.GetPoint();
+    BN_CTX* ctx = frame.Ctx();
 
-    if ((ctx != nullptr) && (Q != nullptr)) {
+    if (Q != nullptr) {
       // 1. Check if s is in [1, ..., order-1]
       err = (BN_is_zero(response.m_r.get()) ||
              (BN_cmp(response.m_r.get(), Schnorr::GetCurveOrder()) != -1));
@@ -178,22 +387,32 @@ bool MultiSig::VerifyResponse(const Response& response,
         return false;
       }
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+      // 2.-3. Compute Q = sG + r*kpub and check Q == commitPoint
+      err = !secp256k1::CheckCommitment(response.m_r.get(), challenge.m_c.get(),
+                                        pubkey.m_P.get(), commitPoint.m_p.get(),
+                                        ctx);
+      if (err) {
+        // Generated commit point doesn't match the given one
+        return false;
+      }
+#else
       // 2. Compute Q = sG + r*kpub
-      err =
-          (EC_POINT_mul(Schnorr::GetCurveGroup(), Q.get(), response.m_r.get(),
-                        pubkey.m_P.get(), challenge.m_c.get(), ctx.get()) == 0);
+      err = (EC_POINT_mul(Schnorr::GetCurveGroup(), Q, response.m_r.get(),
+                          pubkey.m_P.get(), challenge.m_c.get(), ctx) == 0);
       if (err) {
         // Commit regenerate failed
         return false;
       }
 
       // 3. Q == commitPoint
-      err = (EC_POINT_cmp(Schnorr::GetCurveGroup(), Q.get(),
-                          commitPoint.m_p.get(), ctx.get()) != 0);
+      err = (EC_POINT_cmp(Schnorr::GetCurveGroup(), Q, commitPoint.m_p.get(),
+                          ctx) != 0);
       if (err) {
         // Generated commit point doesn't match the given one
         return false;
       }
+#endif
     } else {
       // Memory allocation failure
       throw std::bad_alloc();
@@ -206,6 +425,349 @@ bool MultiSig::VerifyResponse(const Response& response,
   return true;
 }
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+/// Reads the private state of the round inputs for the batch checks below.
+struct ResponseBatchAccess {
+  static const EC_POINT* Point(const CommitPoint& commitPoint) {
+    return commitPoint.m_p.get();
+  }
+
+  static const PubKey& Key(const CompactRound& round, size_t slot) {
+    return round.m_committee.GetPubKeys()[round.m_keyIndices[slot]];
+  }
+
+  static const uint8_t* CommitData(const CompactRound& round, size_t slot) {
+    return round.m_commits.data() + slot * COMPACT_COMMIT_POINT_SIZE;
+  }
+
+  static const uint8_t* ResponseData(const CompactRound& round, size_t slot) {
+    return round.m_responses.data() + slot * RESPONSE_SIZE;
+  }
+};
+
+namespace {
+
+/// Ranges of at most this many signers are checked one by one during fault
+/// isolation.
+const size_t FAULT_ISOLATION_SINGLE_CHECKS = 4;
+
+/// Native form of the inputs of a round, for batch checks over ranges of
+/// signers.
+struct ResponseBatch {
+  secp256k1::Scalar challenge;
+  vector<secp256k1::Scalar> responses;
+  vector<secp256k1::GeAffine> keys;
+  vector<secp256k1::GeAffine> commits;
+  /// Whether the inputs of each signer are well-formed.
+  vector<bool> valid;
+};
+
+/// Converts a challenge. Returns false if it is not initialized.
+bool LoadChallenge(secp256k1::Scalar& r, const Challenge& challenge) {
+  Challenge::Serialized encoded;
+  return challenge.Initialized() && challenge.Serialize(encoded) &&
+         r.SetB32(encoded.data());
+}
+
+/// Converts a response. Returns false if it is not initialized or not in
+/// [1, ..., order-1].
+bool LoadResponse(secp256k1::Scalar& r, const Response& response) {
+  Response::Serialized encoded;
+  return response.Initialized() && response.Serialize(encoded) &&
+         r.SetB32(encoded.data()) && !r.IsZero();
+}
+
+/// Converts the inputs of a round. Returns false if the challenge or the
+/// input sizes are wrong; malformed inputs of single signers are only
+/// marked as not valid.
+bool LoadResponseBatch(ResponseBatch& batch, const vector<Response>& responses,
+                       const Challenge& challenge,
+                       const vector<PubKey>& pubkeys,
+                       const vector<CommitPoint>& commitPoints) {
+  const size_t count = responses.size();
+  if ((pubkeys.size() != count) || (commitPoints.size() != count)) {
+    // Mismatched input sizes
+    return false;
+  }
+
+  if (!LoadChallenge(batch.challenge, challenge)) {
+    // Challenge not initialized
+    return false;
+  }
+
+  ScratchFrame frame;
+  BN_CTX* ctx = frame.Ctx();
+
+  batch.responses.resize(count);
+  batch.keys.resize(count);
+  batch.commits.resize(count);
+  batch.valid.assign(count, false);
+  for (size_t i = 0; i < count; i++) {
+    if (!commitPoints[i].Initialized()) {
+      // Commit point not initialized
+      continue;
+    }
+
+    batch.valid[i] =
+        LoadResponse(batch.responses[i], responses[i]) &&
+        secp256k1::LoadPoint(batch.keys[i], pubkeys[i].m_P.get(), ctx) &&
+        secp256k1::LoadPoint(batch.commits[i],
+                             ResponseBatchAccess::Point(commitPoints[i]), ctx);
+  }
+  return true;
+}
+
+/// Converts the inputs of a compact round, like the overload above.
+bool LoadResponseBatch(ResponseBatch& batch, const CompactRound& round,
+                       const Challenge& challenge) {
+  if (!round.Initialized()) {
+    // Round not initialized
+    return false;
+  }
+
+  if (!LoadChallenge(batch.challenge, challenge)) {
+    // Challenge not initialized
+    return false;
+  }
+
+  ScratchFrame frame;
+  BN_CTX* ctx = frame.Ctx();
+
+  const size_t count = round.Size();
+  batch.responses.resize(count);
+  batch.keys.resize(count);
+  batch.commits.resize(count);
+  batch.valid.assign(count, false);
+  for (size_t i = 0; i < count; i++) {
+    if (!round.HasCommitPoint(i) || !round.HasResponse(i)) {
+      // Response or commit point missing
+      continue;
+    }
+
+    // Check if s is in [1, ..., order-1]
+    secp256k1::Scalar& response = batch.responses[i];
+    if (!response.SetB32(ResponseBatchAccess::ResponseData(round, i)) ||
+        response.IsZero()) {
+      // Response not in range
+      continue;
+    }
+
+    LoadCompactCommit(batch.commits[i],
+                      ResponseBatchAccess::CommitData(round, i));
+    batch.valid[i] = secp256k1::LoadPoint(
+        batch.keys[i], ResponseBatchAccess::Key(round, i).m_P.get(), ctx);
+  }
+  return true;
+}
+
+/// Checks the signers in [begin, end) of a batch with well-formed inputs.
+/// Each response satisfies s_i*G + r*kpub_i = Q_i. With random 128-bit
+/// weights z_i, all of them hold together iff (except with probability
+/// 2^-128)
+///   sum(z_i*s_i)*G + r*sum(z_i*kpub_i) - sum(z_i*Q_i) = O,
+/// which takes two multi-scalar multiplications instead of one double
+/// multiplication per signer.
+bool CheckResponseBatch(const ResponseBatch& batch, size_t begin, size_t end) {
+  const size_t count = end - begin;
+
+  vector<secp256k1::Scalar> weights(count);
+  if (!secp256k1::RandomBatchWeights(weights.data(), count)) {
+    // Random generation failed
+    throw std::runtime_error("RAND_bytes failed");
+  }
+
+  vector<secp256k1::Scalar> neg_weights(count + 1);
+  vector<secp256k1::GeAffine> commits(batch.commits.begin() + begin,
+                                      batch.commits.begin() + end);
+  secp256k1::ScalarSum weighted_sum;
+  for (size_t i = 0; i < count; i++) {
+    neg_weights[i].Negate(weights[i]);
+
+    secp256k1::Scalar weighted;
+    weighted.Mul(weights[i], batch.responses[begin + i]);
+    weighted_sum.Add(weighted);
+  }
+
+  // K = sum(z_i*kpub_i)
+  secp256k1::Scalar zero;
+  zero.SetInt(0);
+  secp256k1::GeJacobian key_sum;
+  secp256k1::EcMultMultiVar(key_sum, &batch.keys[begin], weights.data(),
+                            count, zero);
+  commits.emplace_back();
+  commits.back().SetJacobianVar(key_sum);
+  neg_weights[count] = batch.challenge;
+
+  // sum(z_i*s_i)*G + r*K - sum(z_i*Q_i) = O
+  secp256k1::GeJacobian result;
+  secp256k1::EcMultMultiVar(result, commits.data(), neg_weights.data(),
+                            count + 1, weighted_sum.Get());
+  return result.infinity;
+}
+
+/// Appends the indices of the faulty signers in [begin, end) of a batch
+/// with well-formed inputs to faulty by bisection, mapping batch positions
+/// to signer indices through index. known_bad is set if the range is known
+/// to hold a faulty signer, which saves its own check.
+void IsolateFaultyResponses(const ResponseBatch& batch,
+                            const vector<unsigned int>& index, size_t begin,
+                            size_t end, bool known_bad,
+                            vector<unsigned int>& faulty) {
+  if (begin == end) {
+    return;
+  }
+
+  // Small ranges are cheaper to check signer by signer
+  if (end - begin <= FAULT_ISOLATION_SINGLE_CHECKS) {
+    for (size_t i = begin; i < end; i++) {
+      secp256k1::GeJacobian q;
+      secp256k1::EcMultDoubleVar(q, batch.keys[i], batch.challenge,
+                                 batch.responses[i]);
+      if (!q.EqualAffineVar(batch.commits[i])) {
+        faulty.push_back(index[i]);
+      }
+    }
+    return;
+  }
+
+  if (!known_bad && CheckResponseBatch(batch, begin, end)) {
+    return;
+  }
+
+  // If the left half passes, the fault is in the right half
+  const size_t mid = begin + (end - begin) / 2;
+  const size_t before = faulty.size();
+  IsolateFaultyResponses(batch, index, begin, mid, false, faulty);
+  IsolateFaultyResponses(batch, index, mid, end, faulty.size() == before,
+                         faulty);
+}
+
+/// Checks all signers of a batch.
+bool VerifyResponseBatch(const ResponseBatch& batch) {
+  if (find(batch.valid.begin(), batch.valid.end(), false) !=
+      batch.valid.end()) {
+    // Malformed response, commit point or public key
+    return false;
+  }
+
+  return CheckResponseBatch(batch, 0, batch.valid.size());
+}
+
+/// Appends the indices of the faulty signers of a batch to faulty, sorted.
+void FindFaultyBatchResponses(ResponseBatch& batch,
+                              vector<unsigned int>& faulty) {
+  // Signers with malformed inputs are faulty without a check; the others
+  // are moved to the front of the batch and bisected
+  vector<unsigned int> index;
+  for (size_t i = 0; i < batch.valid.size(); i++) {
+    if (batch.valid[i]) {
+      batch.responses[index.size()] = batch.responses[i];
+      batch.keys[index.size()] = batch.keys[i];
+      batch.commits[index.size()] = batch.commits[i];
+      index.push_back(static_cast<unsigned int>(i));
+    } else {
+      faulty.push_back(static_cast<unsigned int>(i));
+    }
+  }
+
+  // The whole round is not checked first: callers only search after a
+  // failure, and checking both halves costs the same if all are valid
+  const size_t mid = index.size() / 2;
+  IsolateFaultyResponses(batch, index, 0, mid, false, faulty);
+  IsolateFaultyResponses(batch, index, mid, index.size(), false, faulty);
+  sort(faulty.begin(), faulty.end());
+}
+
+}  // namespace
+
+bool MultiSig::VerifyResponses(const vector<Response>& responses,
+                               const Challenge& challenge,
+                               const vector<PubKey>& pubkeys,
+                               const vector<CommitPoint>& commitPoints) {
+  try {
+    // Initial checks
+
+    if (responses.empty()) {
+      // No responses
+      return false;
+    }
+
+    ResponseBatch batch;
+    if (!LoadResponseBatch(batch, responses, challenge, pubkeys,
+                           commitPoints)) {
+      // Invalid round inputs
+      return false;
+    }
+
+    return VerifyResponseBatch(batch);
+  } catch (const std::exception& e) {
+    // LOG_GENERAL(WARNING,
+    //"Error with MultiSig::VerifyResponses." << ' ' << e.what());
+    return false;
+  }
+}
+
+bool MultiSig::VerifyResponses(const CompactRound& round,
+                               const Challenge& challenge) {
+  try {
+    ResponseBatch batch;
+    if (!LoadResponseBatch(batch, round, challenge)) {
+      // Invalid round inputs
+      return false;
+    }
+
+    return VerifyResponseBatch(batch);
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
+
+bool MultiSig::FindFaultyResponses(const vector<Response>& responses,
+                                   const Challenge& challenge,
+                                   const vector<PubKey>& pubkeys,
+                                   const vector<CommitPoint>& commitPoints,
+                                   vector<unsigned int>& faulty) {
+  faulty.clear();
+
+  try {
+    ResponseBatch batch;
+    if (!LoadResponseBatch(batch, responses, challenge, pubkeys,
+                           commitPoints)) {
+      // Invalid round inputs
+      return false;
+    }
+
+    FindFaultyBatchResponses(batch, faulty);
+    return true;
+  } catch (const std::exception& e) {
+    // LOG_GENERAL(WARNING,
+    //"Error with MultiSig::FindFaultyResponses." << ' ' << e.what());
+    faulty.clear();
+    return false;
+  }
+}
+
+bool MultiSig::FindFaultyResponses(const CompactRound& round,
+                                   const Challenge& challenge,
+                                   vector<unsigned int>& faulty) {
+  faulty.clear();
+
+  try {
+    ResponseBatch batch;
+    if (!LoadResponseBatch(batch, round, challenge)) {
+      // Invalid round inputs
+      return false;
+    }
+
+    FindFaultyBatchResponses(batch, faulty);
+    return true;
+  } catch (const std::exception& e) {
+    faulty.clear();
+    return false;
+  }
+}
+#endif
+
 /*
  * This method is the same as:
  * bool Schnorr::Verify(const bytes& message,
@@ -231,18 +793,19 @@ bool MultiSig::MultiSigVerify(const bytes& message, const Signature& toverify,
 bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
                               unsigned int size, const Signature& toverify,
                               const PubKey& pubkey) {
-  // This mutex is to prevent multi-threaded issues with the use of openssl
-  // functions
-  lock_guard<mutex> g(m_mutexMultiSigVerify);
-
-  // Initial checks
-  if (message.size() == 0) {
-    // Empty message
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
     return false;
   }
 
-  if (message.size() < (offset + size)) {
-    // Offset and size beyond message size
+  return MultiSigVerify(message.data() + offset, size, toverify, pubkey);
+}
+
+bool MultiSig::MultiSigVerify(const uint8_t* message, size_t size,
+                              const Signature& toverify, const PubKey& pubkey) {
+  // Initial checks
+  if (size == 0) {
+    // Empty message
     return false;
   }
 
@@ -278,13 +841,12 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
     bool err2 = false;
 
     // Regenerate the commitment part of the signature
-    unique_ptr<BIGNUM, void (*)(BIGNUM*)> challenge_built(BN_new(),
-                                                          BN_clear_free);
-    unique_ptr<EC_POINT, void (*)(EC_POINT*)> Q(
-        EC_POINT_new(Schnorr::GetCurveGroup()), EC_POINT_clear_free);
-    unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+    ScratchFrame frame;
+    BIGNUM* challenge_built = frame.GetBN();
+    EC_POINT* Q = frame.GetPoint();
+    BN_CTX* ctx = frame.Ctx();
 
-    if ((challenge_built != nullptr) && (ctx != nullptr) && (Q != nullptr)) {
+    if ((challenge_built != nullptr) && (Q != nullptr)) {
       // 1. Check if r,s is in [1, ..., order-1]
       err2 = (BN_is_zero(toverify.m_r.get()) ||
               BN_is_negative(toverify.m_r.get()) ||
@@ -304,10 +866,26 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
         return false;
       }
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+      // 2.-4.2 Compute Q = sG + r*kpub (failing if Q = O) and convert the
+      // commitment and the public key to octets
+      bytes encoded(2 * Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES);
+      err2 = !secp256k1::VerifyCommitment(
+          toverify.m_s.get(), toverify.m_r.get(), pubkey.m_P.get(),
+          encoded.data(),
+          encoded.data() + Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES, ctx);
+      err = err || err2;
+      if (err2) {
+        // Commit regenerate failed
+        return false;
+      }
+
+      // Hash commitment and public key
+      sha2.Update(encoded);
+#else
       // 2. Compute Q = sG + r*kpub
-      err2 =
-          (EC_POINT_mul(Schnorr::GetCurveGroup(), Q.get(), toverify.m_s.get(),
-                        pubkey.m_P.get(), toverify.m_r.get(), ctx.get()) == 0);
+      err2 = (EC_POINT_mul(Schnorr::GetCurveGroup(), Q, toverify.m_s.get(),
+                           pubkey.m_P.get(), toverify.m_r.get(), ctx) == 0);
       err = err || err2;
       if (err2) {
         // Commit regenerate failed
@@ -315,7 +893,7 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
       }
 
       // 3. If Q = O (the neutral point), return 0;
-      err2 = (EC_POINT_is_at_infinity(Schnorr::GetCurveGroup(), Q.get()));
+      err2 = (EC_POINT_is_at_infinity(Schnorr::GetCurveGroup(), Q));
       err = err || err2;
       if (err2) {
         // Commit at infinity
@@ -324,9 +902,9 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
 
       // 4. r' = H(Q, kpub, m)
       // 4.1 Convert the committment to octets first
-      err2 = (EC_POINT_point2oct(Schnorr::GetCurveGroup(), Q.get(),
+      err2 = (EC_POINT_point2oct(Schnorr::GetCurveGroup(), Q,
                                  POINT_CONVERSION_COMPRESSED, buf.data(),
-                                 Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES, NULL) !=
+                                 Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES, ctx) !=
               Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES);
       err = err || err2;
       if (err2) {
@@ -343,7 +921,7 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
       // 4.2 Convert the public key to octets
       err2 = (EC_POINT_point2oct(Schnorr::GetCurveGroup(), pubkey.m_P.get(),
                                  POINT_CONVERSION_COMPRESSED, buf.data(),
-                                 Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES, NULL) !=
+                                 Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES, ctx) !=
               Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES);
       err = err || err2;
       if (err2) {
@@ -353,22 +931,23 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
 
       // Hash public key
       sha2.Update(buf);
+#endif
 
       // 4.3 Hash message
-      sha2.Update(message, offset, size);
+      sha2.Update(message, size);
       bytes digest = sha2.Finalize();
 
       // 5. return r' == r
-      err2 = (BN_bin2bn(digest.data(), digest.size(), challenge_built.get()) ==
-              NULL);
+      err2 =
+          (BN_bin2bn(digest.data(), digest.size(), challenge_built) == NULL);
       err = err || err2;
       if (err2) {
         // Challenge bin2bn conversion failed
         return false;
       }
 
-      err2 = (BN_nnmod(challenge_built.get(), challenge_built.get(),
-                       Schnorr::GetCurveOrder(), NULL) == 0);
+      err2 = (BN_nnmod(challenge_built, challenge_built,
+                       Schnorr::GetCurveOrder(), ctx) == 0);
       err = err || err2;
       if (err2) {
         // Challenge rebuild mod failed
@@ -380,13 +959,39 @@ bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
       // Memory allocation failure
       throw std::bad_alloc();
     }
-    return (!err) && (BN_cmp(challenge_built.get(), toverify.m_r.get()) == 0);
+    return (!err) && (BN_cmp(challenge_built, toverify.m_r.get()) == 0);
   } catch (const std::exception& e) {
     // LOG_GENERAL(WARNING, "Error with Schnorr::Verify." << ' ' << e.what());
     return false;
   }
 }
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+bool MultiSig::MultiSigVerify(const bytes& message, const Signature& toverify,
+                              const VerifyingKey& key) {
+  return MultiSigVerify(message, 0, message.size(), toverify, key);
+}
+
+bool MultiSig::MultiSigVerify(const bytes& message, unsigned int offset,
+                              unsigned int size, const Signature& toverify,
+                              const VerifyingKey& key) {
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
+    return false;
+  }
+
+  return MultiSigVerify(message.data() + offset, size, toverify, key);
+}
+
+bool MultiSig::MultiSigVerify(const uint8_t* message, size_t size,
+                              const Signature& toverify,
+                              const VerifyingKey& key) {
+  // Same as above, with the third domain separated hash function
+  return key.verify({THIRD_DOMAIN_SEPARATED_HASH_FUNCTION_BYTE}, message, size,
+                    toverify);
+}
+#endif
+
 bool MultiSig::SignKey(const bytes& messageWithPubKey, const PairOfKey& keyPair,
                        Signature& signature) {
   // This function is only used by Messenger::SetDSPoWSubmission for
@@ -401,3 +1006,14 @@ bool MultiSig::VerifyKey(const bytes& messageWithPubKey,
   // Proof-of-Possession (PoP) phase
   return Schnorr::Verify(messageWithPubKey, signature, pubKey);
 }
+
+bool MultiSig::SignKey(const uint8_t* messageWithPubKey, size_t size,
+                       const PairOfKey& keyPair, Signature& signature) {
+  return Schnorr::Sign(messageWithPubKey, size, keyPair.first, keyPair.second,
+                       signature);
+}
+
+bool MultiSig::VerifyKey(const uint8_t* messageWithPubKey, size_t size,
+                         const Signature& signature, const PubKey& pubKey) {
+  return Schnorr::Verify(messageWithPubKey, size, signature, pubKey);
+}
@@ -43,10 +43,33 @@ Challenge::Challenge(const CommitPoint& aggregatedCommit,
     throw std::bad_alloc();
   }
 
-  Set(aggregatedCommit, aggregatedPubkey, message, offset, size);
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size outside message length
+    return;
+  }
+
+  Set(aggregatedCommit, aggregatedPubkey, message.data() + offset, size);
+}
+
+Challenge::Challenge(const CommitPoint& aggregatedCommit,
+                     const PubKey& aggregatedPubkey, const uint8_t* message,
+                     size_t size)
+    : m_c(BN_new(), BN_clear_free), m_initialized(false) {
+  if (!constructPreChecks()) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+
+  Set(aggregatedCommit, aggregatedPubkey, message, size);
 }
 
-Challenge::Challenge(const bytes& src, unsigned int offset) {
+Challenge::Challenge(const bytes& src, unsigned int offset)
+    : m_c(BN_new(), BN_clear_free), m_initialized(false) {
+  if (!constructPreChecks()) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+
   if (!Deserialize(src, offset)) {
     // We failed to init Challenge
   }
@@ -75,23 +98,45 @@ bool Challenge::Serialize(bytes& dst, unsigned int offset) const {
   return true;
 }
 
+bool Challenge::Serialize(Serialized& dst) const {
+  if (!m_initialized) {
+    return false;
+  }
+
+  return BIGNUMSerialize::SetNumber(dst.data(), dst.size(), m_c.get());
+}
+
 bool Challenge::Deserialize(const bytes& src, unsigned int offset) {
-  shared_ptr<BIGNUM> tmp =
-      BIGNUMSerialize::GetNumber(src, offset, CHALLENGE_SIZE);
-  if (tmp == nullptr) {
+  if (offset > src.size()) {
+    // Offset beyond source size
+    return false;
+  }
+
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
+
+bool Challenge::Deserialize(const uint8_t* src, size_t size) {
+  if (size < CHALLENGE_SIZE) {
+    // Source too short
+    return false;
+  }
+
+  if (!BIGNUMSerialize::GetNumber(m_c.get(), src, CHALLENGE_SIZE)) {
     // Deserialization failure
     return false;
   }
 
-  m_c = tmp;
   m_initialized = true;
-
   return true;
 }
 
+bool Challenge::Deserialize(const Serialized& src) {
+  return Deserialize(src.data(), src.size());
+}
+
 void Challenge::Set(const CommitPoint& aggregatedCommit,
-                    const PubKey& aggregatedPubkey, const bytes& message,
-                    unsigned int offset, unsigned int size) {
+                    const PubKey& aggregatedPubkey, const uint8_t* message,
+                    size_t size) {
   // Initial checks
 
   if (!aggregatedCommit.Initialized()) {
@@ -99,16 +144,11 @@ void Challenge::Set(const CommitPoint& aggregatedCommit,
     return;
   }
 
-  if (message.size() == 0) {
+  if (size == 0) {
     // Empty message
     return;
   }
 
-  if (message.size() < (offset + size)) {
-    // Offset and size outside message length
-    return;
-  }
-
   // Compute the challenge c = H(r, kpub, m)
 
   SHA2<HashType::HASH_VARIANT_256> sha2;
@@ -128,12 +168,13 @@ void Challenge::Set(const CommitPoint& aggregatedCommit,
   m_initialized = false;
 
   bytes buf(Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES);
+  ScratchFrame frame;
 
   // Convert the committment to octets first
   if (EC_POINT_point2oct(Schnorr::GetCurveGroup(), aggregatedCommit.m_p.get(),
                          POINT_CONVERSION_COMPRESSED, buf.data(),
-                         Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES,
-                         NULL) != Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES) {
+                         Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES, frame.Ctx()) !=
+      Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES) {
     // Could not convert commitment to octets
     return;
   }
@@ -147,8 +188,8 @@ void Challenge::Set(const CommitPoint& aggregatedCommit,
   // Convert the public key to octets
   if (EC_POINT_point2oct(Schnorr::GetCurveGroup(), aggregatedPubkey.m_P.get(),
                          POINT_CONVERSION_COMPRESSED, buf.data(),
-                         Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES,
-                         NULL) != Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES) {
+                         Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES, frame.Ctx()) !=
+      Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES) {
     // Could not convert public key to octets
     return;
   }
@@ -157,7 +198,7 @@ void Challenge::Set(const CommitPoint& aggregatedCommit,
   sha2.Update(buf);
 
   // Hash message
-  sha2.Update(message, offset, size);
+  sha2.Update(message, size);
   bytes digest = sha2.Finalize();
 
   // Build the challenge
@@ -166,7 +207,8 @@ void Challenge::Set(const CommitPoint& aggregatedCommit,
     return;
   }
 
-  if (BN_nnmod(m_c.get(), m_c.get(), Schnorr::GetCurveOrder(), NULL) == 0) {
+  if (BN_nnmod(m_c.get(), m_c.get(), Schnorr::GetCurveOrder(), frame.Ctx()) ==
+      0) {
     // Could not reduce challenge modulo group order
     return;
   }
@@ -17,6 +17,9 @@
 
 #include "MultiSig.h"
 #include "SchnorrInternal.h"
+#ifdef SCHNORR_NATIVE_SECP256K1
+#include "Secp256k1Group.h"
+#endif
 
 using namespace std;
 
@@ -42,7 +45,14 @@ CommitPoint::CommitPoint(const CommitSecret& secret)
   Set(secret);
 }
 
-CommitPoint::CommitPoint(const bytes& src, unsigned int offset) {
+CommitPoint::CommitPoint(const bytes& src, unsigned int offset)
+    : m_p(EC_POINT_new(Schnorr::GetCurveGroup()), EC_POINT_clear_free),
+      m_initialized(false) {
+  if (!constructPreChecks()) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+
   if (!Deserialize(src, offset)) {
     // We failed to init CommitPoint
   }
@@ -72,27 +82,88 @@ bool CommitPoint::Serialize(bytes& dst, unsigned int offset) const {
   return true;
 }
 
+bool CommitPoint::Serialize(Serialized& dst) const {
+  if (!m_initialized) {
+    return false;
+  }
+
+  return ECPOINTSerialize::SetNumber(dst.data(), dst.size(), m_p.get());
+}
+
 bool CommitPoint::Deserialize(const bytes& src, unsigned int offset) {
-  shared_ptr<EC_POINT> tmp;
-  tmp = ECPOINTSerialize::GetNumber(src, offset, COMMIT_POINT_SIZE);
-  if (tmp == nullptr) {
+  if (offset > src.size()) {
+    // Offset beyond source size
+    return false;
+  }
+
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
+
+bool CommitPoint::Deserialize(const uint8_t* src, size_t size) {
+  if (size < COMMIT_POINT_SIZE) {
+    // Source too short
+    return false;
+  }
+
+  if (!ECPOINTSerialize::GetNumber(m_p.get(), src, COMMIT_POINT_SIZE)) {
     // Deserialization failure
     return false;
   }
 
-  m_p = tmp;
   m_initialized = true;
-
   return true;
 }
 
+bool CommitPoint::Deserialize(const Serialized& src) {
+  return Deserialize(src.data(), src.size());
+}
+
+bool CommitPoint::SerializeAll(const vector<CommitPoint>& points, bytes& dst) {
+  dst.resize(points.size() * COMMIT_POINT_SIZE);
+  uint8_t* records = dst.data();
+  auto encode = [&points, records](size_t i) {
+    return points[i].m_initialized &&
+           ECPOINTSerialize::SetNumber(records + i * COMMIT_POINT_SIZE,
+                                       COMMIT_POINT_SIZE, points[i].m_p.get());
+  };
+  return ParallelForChunks(points.size(), BULK_CHUNK_SIZE, encode);
+}
+
+bool CommitPoint::DeserializeAll(const uint8_t* src, size_t size,
+                                 vector<CommitPoint>& points) {
+  if (size % COMMIT_POINT_SIZE != 0) {
+    // Source not made of whole records
+    return false;
+  }
+
+  // The points are allocated here, so that the batch threads only decode
+  points.resize(size / COMMIT_POINT_SIZE);
+  auto decode = [src, &points](size_t i) {
+    return points[i].Deserialize(src + i * COMMIT_POINT_SIZE,
+                                 COMMIT_POINT_SIZE);
+  };
+  return ParallelForChunks(points.size(), BULK_CHUNK_SIZE, decode);
+}
+
+bool CommitPoint::DeserializeAll(const bytes& src,
+                                 vector<CommitPoint>& points) {
+  return DeserializeAll(src.data(), src.size(), points);
+}
+
 void CommitPoint::Set(const CommitSecret& secret) {
   if (!secret.Initialized()) {
     return;
   }
 
+  ScratchFrame frame{SecretScratch()};
+#ifdef SCHNORR_NATIVE_SECP256K1
+  m_initialized =
+      secp256k1::MulGenerator(m_p.get(), secret.m_s.get(), frame.Ctx());
+#else
   m_initialized = (EC_POINT_mul(Schnorr::GetCurveGroup(), m_p.get(),
-                                secret.m_s.get(), NULL, NULL, NULL) == 1);
+                                secret.m_s.get(), NULL, NULL,
+                                frame.Ctx()) == 1);
+#endif
 }
 
 CommitPoint& CommitPoint::operator=(const CommitPoint& src) {
@@ -101,13 +172,8 @@ CommitPoint& CommitPoint::operator=(const CommitPoint& src) {
 }
 
 bool CommitPoint::operator==(const CommitPoint& r) const {
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    // Memory allocation failure
-    throw std::bad_alloc();
-  }
-
+  ScratchFrame frame;
   return (m_initialized && r.m_initialized &&
           (EC_POINT_cmp(Schnorr::GetCurveGroup(), m_p.get(), r.m_p.get(),
-                        ctx.get()) == 0));
+                        frame.Ctx()) == 0));
 }
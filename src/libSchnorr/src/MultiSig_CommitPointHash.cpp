@@ -17,6 +17,9 @@
 
 #include "MultiSig.h"
 #include "SchnorrInternal.h"
+#ifdef SCHNORR_NATIVE_SECP256K1
+#include "Secp256k1Group.h"
+#endif
 
 using namespace std;
 
@@ -40,7 +43,13 @@ CommitPointHash::CommitPointHash(const CommitPoint& point)
   Set(point);
 }
 
-CommitPointHash::CommitPointHash(const bytes& src, unsigned int offset) {
+CommitPointHash::CommitPointHash(const bytes& src, unsigned int offset)
+    : m_h(BN_new(), BN_clear_free), m_initialized(false) {
+  if (!constructPreChecks()) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+
   if (!Deserialize(src, offset)) {
     // We failed to init CommitPointHash
   }
@@ -69,29 +78,44 @@ bool CommitPointHash::Serialize(bytes& dst, unsigned int offset) const {
   return true;
 }
 
+bool CommitPointHash::Serialize(Serialized& dst) const {
+  if (!m_initialized) {
+    return false;
+  }
+
+  return BIGNUMSerialize::SetNumber(dst.data(), dst.size(), m_h.get());
+}
+
 bool CommitPointHash::Deserialize(const bytes& src, unsigned int offset) {
-  shared_ptr<BIGNUM> tmp =
-      BIGNUMSerialize::GetNumber(src, offset, COMMIT_POINT_HASH_SIZE);
+  if (offset > src.size()) {
+    // Offset beyond source size
+    return false;
+  }
+
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
 
-  if (tmp == nullptr) {
+bool CommitPointHash::Deserialize(const uint8_t* src, size_t size) {
+  if (size < COMMIT_POINT_HASH_SIZE) {
+    // Source too short
     return false;
   }
 
-  m_h = tmp;
-  m_initialized = true;
+  if (!BIGNUMSerialize::GetNumber(m_h.get(), src, COMMIT_POINT_HASH_SIZE)) {
+    // Deserialization failure
+    return false;
+  }
 
+  m_initialized = true;
   return true;
 }
 
-void CommitPointHash::Set(const CommitPoint& point) {
-  if (!point.Initialized()) {
-    // Commitment point not initialized
-    return;
-  }
-
-  m_initialized = false;
-  bytes buf(Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES);
+bool CommitPointHash::Deserialize(const Serialized& src) {
+  return Deserialize(src.data(), src.size());
+}
 
+bool HashCommitPoint(const uint8_t* compressed,
+                     array<uint8_t, COMMIT_POINT_HASH_SIZE>& hash) {
   SHA2<HashType::HASH_VARIANT_256> sha2;
 
   // The second domain separated hash function.
@@ -104,30 +128,57 @@ void CommitPointHash::Set(const CommitPoint& point) {
   // byte to 0x01.
   sha2.Update({SECOND_DOMAIN_SEPARATED_HASH_FUNCTION_BYTE});
 
-  // Convert the commitment to octets first
-  if (EC_POINT_point2oct(Schnorr::GetCurveGroup(), point.m_p.get(),
-                         POINT_CONVERSION_COMPRESSED, buf.data(),
-                         Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES,
-                         NULL) != Schnorr::PUBKEY_COMPRESSED_SIZE_BYTES) {
-    // Could not convert commitPoint to octets
+  // compute H(0x01||point)
+  sha2.Update(compressed, COMMIT_POINT_SIZE);
+  const bytes digest = sha2.Finalize();
+
+  // Reduce the hash value modulo the group order
+#ifdef SCHNORR_NATIVE_SECP256K1
+  secp256k1::Scalar h;
+  h.SetB32(digest.data());
+  h.GetB32(hash.data());
+  return true;
+#else
+  ScratchFrame frame;
+  BIGNUM* h = frame.GetBN();
+  if ((BN_bin2bn(digest.data(), digest.size(), h) == NULL) ||
+      (BN_nnmod(h, h, Schnorr::GetCurveOrder(), frame.Ctx()) == 0)) {
+    // Could not reduce hashpoint value modulo group order
+    return false;
+  }
+  return BIGNUMSerialize::SetNumber(hash.data(), hash.size(), h);
+#endif
+}
+
+void CommitPointHash::Set(const CommitPoint& point) {
+  if (!point.Initialized()) {
+    // Commitment point not initialized
     return;
   }
 
-  // compute H(0x01||point)
-  sha2.Update(buf);
-  bytes digest = sha2.Finalize();
+  m_initialized = false;
+  array<uint8_t, COMMIT_POINT_SIZE> buf;
+  array<uint8_t, COMMIT_POINT_HASH_SIZE> hash;
+
+  {
+    ScratchFrame frame;
+
+    // Convert the commitment to octets first
+    if (EC_POINT_point2oct(Schnorr::GetCurveGroup(), point.m_p.get(),
+                           POINT_CONVERSION_COMPRESSED, buf.data(), buf.size(),
+                           frame.Ctx()) != buf.size()) {
+      // Could not convert commitPoint to octets
+      return;
+    }
+  }
 
   // Build the PointHash
-  if ((BN_bin2bn(digest.data(), digest.size(), m_h.get())) == NULL) {
+  if (!HashCommitPoint(buf.data(), hash) ||
+      !BIGNUMSerialize::GetNumber(m_h.get(), hash.data(), hash.size())) {
     // Digest to scalar failed
     return;
   }
 
-  if (BN_nnmod(m_h.get(), m_h.get(), Schnorr::GetCurveOrder(), NULL) == 0) {
-    // Could not reduce hashpoint value modulo group order
-    return;
-  }
-
   m_initialized = true;
 }
 
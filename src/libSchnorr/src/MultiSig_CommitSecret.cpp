@@ -17,6 +17,9 @@
 
 #include "MultiSig.h"
 #include "SchnorrInternal.h"
+#ifdef SCHNORR_NATIVE_SECP256K1
+#include "Secp256k1Group.h"
+#endif
 
 using namespace std;
 
@@ -49,7 +52,51 @@ CommitSecret::CommitSecret()
   m_initialized = (!err);
 }
 
-CommitSecret::CommitSecret(const bytes& src, unsigned int offset) {
+#ifdef SCHNORR_NATIVE_SECP256K1
+CommitSecret::CommitSecret(NoncePool& pool, CommitPoint& commitPoint,
+                           CommitPointHash& commitPointHash)
+    : m_s(BN_new(), BN_clear_free), m_initialized(false) {
+  if (!constructPreChecks()) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+
+  commitPoint.m_initialized = false;
+  commitPointHash.m_initialized = false;
+
+  PooledNonce nonce;
+  if (!pool.take(nonce)) {
+    // Value to commit rand failed
+    return;
+  }
+
+  secp256k1::GeAffine point;
+  point.x.SetB32(nonce.commit.data());
+  point.y.SetB32(nonce.commit.data() + COMPACT_COMMIT_POINT_SIZE / 2);
+  point.infinity = false;
+
+  ScratchFrame frame;
+  if ((BN_bin2bn(nonce.k.data(), nonce.k.size(), m_s.get()) == NULL) ||
+      !secp256k1::StorePoint(commitPoint.m_p.get(), point, frame.Ctx()) ||
+      (BN_bin2bn(nonce.hash.data(), nonce.hash.size(),
+                 commitPointHash.m_h.get()) == NULL)) {
+    // Commitment conversion failed
+    return;
+  }
+
+  m_initialized = true;
+  commitPoint.m_initialized = true;
+  commitPointHash.m_initialized = true;
+}
+#endif
+
+CommitSecret::CommitSecret(const bytes& src, unsigned int offset)
+    : m_s(BN_new(), BN_clear_free), m_initialized(false) {
+  if (!constructPreChecks()) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+
   if (!Deserialize(src, offset)) {
     // We failed to init CommitSecret
   }
@@ -78,19 +125,40 @@ bool CommitSecret::Serialize(bytes& dst, unsigned int offset) const {
   return true;
 }
 
+bool CommitSecret::Serialize(Serialized& dst) const {
+  if (!m_initialized) {
+    return false;
+  }
+
+  return BIGNUMSerialize::SetNumber(dst.data(), dst.size(), m_s.get());
+}
+
 bool CommitSecret::Deserialize(const bytes& src, unsigned int offset) {
-  shared_ptr<BIGNUM> tmp =
-      BIGNUMSerialize::GetNumber(src, offset, COMMIT_SECRET_SIZE);
+  if (offset > src.size()) {
+    // Offset beyond source size
+    return false;
+  }
 
-  if (tmp == nullptr) {
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
+
+bool CommitSecret::Deserialize(const uint8_t* src, size_t size) {
+  if (size < COMMIT_SECRET_SIZE) {
+    // Source too short
+    return false;
+  }
+
+  if (!BIGNUMSerialize::GetNumber(m_s.get(), src, COMMIT_SECRET_SIZE)) {
     // Deserialization failure
     return false;
   }
 
-  m_s = tmp;
   m_initialized = true;
+  return true;
+}
 
-  return 0;
+bool CommitSecret::Deserialize(const Serialized& src) {
+  return Deserialize(src.data(), src.size());
 }
 
 CommitSecret& CommitSecret::operator=(const CommitSecret& src) {
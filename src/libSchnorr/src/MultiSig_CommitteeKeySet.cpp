@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/ec.h>
+
+#include <algorithm>
+
+#include "MultiSig.h"
+#include "SchnorrInternal.h"
+#include "Secp256k1Group.h"
+
+using namespace std;
+
+class CommitteeKeySet::Impl {
+ public:
+  vector<PubKey> m_pubkeys;
+  vector<secp256k1::GeAffine> m_points;
+  secp256k1::GeAffine m_total;
+  PubKey m_aggregatedPubkey;
+  bool m_initialized = false;
+
+  explicit Impl(const vector<PubKey>& pubkeys)
+      : m_pubkeys(pubkeys), m_points(pubkeys.size()) {
+    if (m_pubkeys.empty()) {
+      // Empty committee
+      return;
+    }
+
+    // Convert the keys in parallel
+    auto convert = [this](size_t i) {
+      ScratchFrame frame;
+      return secp256k1::LoadPoint(m_points[i], m_pubkeys[i].m_P.get(),
+                                  frame.Ctx());
+    };
+    if (!ParallelForChunks(m_pubkeys.size(), BULK_CHUNK_SIZE, convert)) {
+      // Public key conversion failed
+      return;
+    }
+
+    secp256k1::GeJacobian total;
+    total.SetInfinity();
+    for (const auto& point : m_points) {
+      total.AddAffineVar(total, point);
+    }
+    m_total.SetJacobianVar(total);
+
+    ScratchFrame frame;
+    m_initialized = secp256k1::StorePoint(m_aggregatedPubkey.m_P.get(),
+                                          m_total, frame.Ctx());
+  }
+
+  Impl(const Impl&) = delete;
+  Impl& operator=(const Impl&) = delete;
+};
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+CommitteeKeySet::CommitteeKeySet(const vector<PubKey>& pubkeys)
+    : m_impl(make_shared<const Impl>(pubkeys)) {}
+
+bool CommitteeKeySet::Initialized() const { return m_impl->m_initialized; }
+
+size_t CommitteeKeySet::Size() const { return m_impl->m_pubkeys.size(); }
+
+const vector<PubKey>& CommitteeKeySet::GetPubKeys() const {
+  return m_impl->m_pubkeys;
+}
+
+const PubKey& CommitteeKeySet::GetAggregatedPubKey() const {
+  return m_impl->m_aggregatedPubkey;
+}
+
+// ============================================================================
+// Aggregation
+// ============================================================================
+
+shared_ptr<PubKey> CommitteeKeySet::AggregatePubKeys(
+    const vector<bool>& signers) const {
+  const Impl& impl = *m_impl;
+  if (!impl.m_initialized) {
+    // Committee not initialized
+    return nullptr;
+  }
+
+  if (signers.size() != impl.m_points.size()) {
+    // Bitmap size mismatch
+    return nullptr;
+  }
+
+  const size_t present = count(signers.begin(), signers.end(), true);
+  if (present == 0) {
+    // Empty list of signers
+    return nullptr;
+  }
+
+  // Add up whichever of the present and absent members are fewer
+  secp256k1::GeJacobian sum;
+  if (2 * present > signers.size()) {
+    sum.SetAffine(impl.m_total);
+    for (size_t i = 0; i < signers.size(); i++) {
+      if (!signers[i]) {
+        secp256k1::GeAffine negated;
+        negated.Neg(impl.m_points[i]);
+        sum.AddAffineVar(sum, negated);
+      }
+    }
+  } else {
+    sum.SetInfinity();
+    for (size_t i = 0; i < signers.size(); i++) {
+      if (signers[i]) {
+        sum.AddAffineVar(sum, impl.m_points[i]);
+      }
+    }
+  }
+
+  secp256k1::GeAffine aggregated;
+  aggregated.SetJacobianVar(sum);
+
+  auto result = make_shared<PubKey>();
+  ScratchFrame frame;
+  if (!secp256k1::StorePoint(result->m_P.get(), aggregated, frame.Ctx())) {
+    // Pubkey aggregation failed
+    return nullptr;
+  }
+
+  return result;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/ec.h>
+
+#include <algorithm>
+#include <array>
+
+#include "MultiSig.h"
+#include "SchnorrInternal.h"
+#include "Secp256k1Group.h"
+
+using namespace std;
+
+const uint8_t COMPACT_HAS_HASH = 0x01;
+const uint8_t COMPACT_HAS_COMMIT = 0x02;
+const uint8_t COMPACT_HAS_RESPONSE = 0x04;
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+CompactRound::CompactRound(const CommitteeKeySet& committee,
+                           const vector<unsigned int>& keyIndices)
+    : m_committee(committee),
+      m_keyIndices(keyIndices.begin(), keyIndices.end()),
+      m_hashes(keyIndices.size() * COMMIT_POINT_HASH_SIZE),
+      m_commits(keyIndices.size() * COMPACT_COMMIT_POINT_SIZE),
+      m_responses(keyIndices.size() * RESPONSE_SIZE),
+      m_present(keyIndices.size(), 0) {
+  if (!committee.Initialized() || keyIndices.empty()) {
+    // Committee not initialized or no signer
+    return;
+  }
+
+  vector<bool> seen(committee.Size(), false);
+  for (unsigned int index : keyIndices) {
+    if ((index >= seen.size()) || seen[index]) {
+      // Key index beyond committee size or repeated
+      return;
+    }
+    seen[index] = true;
+  }
+
+  m_initialized = true;
+}
+
+CompactRound::~CompactRound() {}
+
+bool CompactRound::Initialized() const { return m_initialized; }
+
+size_t CompactRound::Size() const { return m_keyIndices.size(); }
+
+unsigned int CompactRound::GetKeyIndex(size_t slot) const {
+  return m_keyIndices.at(slot);
+}
+
+vector<bool> CompactRound::GetSigners() const {
+  vector<bool> signers(m_committee.Size(), false);
+  for (uint32_t index : m_keyIndices) {
+    if (index < signers.size()) {
+      signers[index] = true;
+    }
+  }
+  return signers;
+}
+
+// ============================================================================
+// Contributions
+// ============================================================================
+
+bool CompactRound::SetCommitPointHash(size_t slot,
+                                      const CommitPointHash& hash) {
+  if (!m_initialized || (slot >= m_keyIndices.size())) {
+    // Round not initialized or slot beyond round size
+    return false;
+  }
+
+  if (!hash.Serialize(m_hashes, slot * COMMIT_POINT_HASH_SIZE)) {
+    // Commit point hash not initialized
+    return false;
+  }
+
+  m_present[slot] |= COMPACT_HAS_HASH;
+  return true;
+}
+
+bool CompactRound::SetCommitPoint(size_t slot, const CommitPoint& commitPoint) {
+  if (!m_initialized || (slot >= m_keyIndices.size())) {
+    // Round not initialized or slot beyond round size
+    return false;
+  }
+
+  if (!commitPoint.Initialized()) {
+    // Commit point not initialized
+    return false;
+  }
+
+  // The point at infinity has no uncompressed encoding, and is rejected
+  array<uint8_t, COMPACT_COMMIT_POINT_SIZE + 1> buf;
+  ScratchFrame frame;
+  if (EC_POINT_point2oct(Schnorr::GetCurveGroup(), commitPoint.m_p.get(),
+                         POINT_CONVERSION_UNCOMPRESSED, buf.data(), buf.size(),
+                         frame.Ctx()) != buf.size()) {
+    // Commit point conversion failed
+    return false;
+  }
+
+  copy(buf.begin() + 1, buf.end(),
+       m_commits.begin() + slot * COMPACT_COMMIT_POINT_SIZE);
+  m_present[slot] |= COMPACT_HAS_COMMIT;
+  return true;
+}
+
+bool CompactRound::SetResponse(size_t slot, const Response& response) {
+  if (!m_initialized || (slot >= m_keyIndices.size())) {
+    // Round not initialized or slot beyond round size
+    return false;
+  }
+
+  if (!response.Serialize(m_responses, slot * RESPONSE_SIZE)) {
+    // Response not initialized
+    return false;
+  }
+
+  m_present[slot] |= COMPACT_HAS_RESPONSE;
+  return true;
+}
+
+bool CompactRound::CheckCommitPointHash(size_t slot) const {
+  const uint8_t both = COMPACT_HAS_HASH | COMPACT_HAS_COMMIT;
+  if ((slot >= m_keyIndices.size()) || ((m_present[slot] & both) != both)) {
+    // Missing commit point or hash
+    return false;
+  }
+
+  // Hashed over the compressed encoding
+  const uint8_t* commit = m_commits.data() + slot * COMPACT_COMMIT_POINT_SIZE;
+  array<uint8_t, COMMIT_POINT_SIZE> compressed;
+  compressed[0] = (commit[COMPACT_COMMIT_POINT_SIZE - 1] & 1) ? 0x03 : 0x02;
+  copy(commit, commit + COMPACT_COMMIT_POINT_SIZE / 2, compressed.begin() + 1);
+
+  array<uint8_t, COMMIT_POINT_HASH_SIZE> hash;
+  return HashCommitPoint(compressed.data(), hash) &&
+         equal(hash.begin(), hash.end(),
+               m_hashes.begin() + slot * COMMIT_POINT_HASH_SIZE);
+}
+
+bool CompactRound::HasCommitPoint(size_t slot) const {
+  return (slot < m_keyIndices.size()) &&
+         ((m_present[slot] & COMPACT_HAS_COMMIT) != 0);
+}
+
+bool CompactRound::HasResponse(size_t slot) const {
+  return (slot < m_keyIndices.size()) &&
+         ((m_present[slot] & COMPACT_HAS_RESPONSE) != 0);
+}
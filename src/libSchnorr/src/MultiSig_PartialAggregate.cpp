@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+
+#include <algorithm>
+
+#include "MultiSig.h"
+#include "SchnorrInternal.h"
+
+using namespace std;
+
+// Serialized layout: the committee size (4 bytes, big-endian), the signer
+// bitmap (one bit per member, most significant bit first), a flags byte,
+// then the commit point, the public key and the response (all zeros if
+// absent) at their usual sizes
+const unsigned int PARTIAL_AGGREGATE_SIZE_BYTES = 4;
+const unsigned int PARTIAL_AGGREGATE_FLAGS_BYTES = 1;
+const uint8_t PARTIAL_AGGREGATE_HAS_RESPONSE = 0x01;
+
+namespace {
+
+unsigned int BitmapSize(unsigned int committeeSize) {
+  return (committeeSize / 8) + ((committeeSize % 8) != 0 ? 1 : 0);
+}
+
+}  // namespace
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+PartialAggregate::PartialAggregate() {}
+
+PartialAggregate::PartialAggregate(unsigned int committeeSize,
+                                   unsigned int index, const PubKey& pubkey,
+                                   const CommitPoint& commitPoint) {
+  set(committeeSize, index, pubkey, commitPoint);
+}
+
+PartialAggregate::PartialAggregate(unsigned int committeeSize,
+                                   unsigned int index, const PubKey& pubkey,
+                                   const CommitPoint& commitPoint,
+                                   const Response& response) {
+  if (!response.Initialized()) {
+    // Response not initialized
+    return;
+  }
+
+  set(committeeSize, index, pubkey, commitPoint);
+  if (m_initialized) {
+    m_response = response;
+    m_hasResponse = true;
+  }
+}
+
+PartialAggregate::PartialAggregate(const bytes& src, unsigned int offset) {
+  if (!Deserialize(src, offset)) {
+    // We failed to init PartialAggregate from stream
+  }
+}
+
+PartialAggregate::~PartialAggregate() {}
+
+void PartialAggregate::set(unsigned int committeeSize, unsigned int index,
+                           const PubKey& pubkey,
+                           const CommitPoint& commitPoint) {
+  if (index >= committeeSize) {
+    // Signer index beyond committee size
+    return;
+  }
+
+  if (!commitPoint.Initialized()) {
+    // Commit point not initialized
+    return;
+  }
+
+  m_signers.assign(committeeSize, false);
+  m_signers[index] = true;
+  m_commit = commitPoint;
+  m_pubkey = pubkey;
+  m_initialized = true;
+}
+
+bool PartialAggregate::Initialized() const { return m_initialized; }
+
+bool PartialAggregate::HasResponse() const { return m_hasResponse; }
+
+const vector<bool>& PartialAggregate::GetSigners() const { return m_signers; }
+
+size_t PartialAggregate::GetSignerCount() const {
+  return count(m_signers.begin(), m_signers.end(), true);
+}
+
+const CommitPoint& PartialAggregate::GetCommit() const { return m_commit; }
+
+const PubKey& PartialAggregate::GetPubKey() const { return m_pubkey; }
+
+const Response& PartialAggregate::GetResponse() const { return m_response; }
+
+// ============================================================================
+// Aggregation
+// ============================================================================
+
+bool PartialAggregate::Merge(const PartialAggregate& other) {
+  // Initial checks
+
+  if (!m_initialized || !other.m_initialized) {
+    // Partial aggregate not initialized
+    return false;
+  }
+
+  if (m_signers.size() != other.m_signers.size()) {
+    // Committee size mismatch
+    return false;
+  }
+
+  if (m_hasResponse != other.m_hasResponse) {
+    // Phase mismatch
+    return false;
+  }
+
+  for (size_t i = 0; i < m_signers.size(); i++) {
+    if (m_signers[i] && other.m_signers[i]) {
+      // Signer included twice
+      return false;
+    }
+  }
+
+  // Compute all sums before updating anything
+  ScratchFrame frame;
+  EC_POINT* commit = frame.GetPoint();
+  EC_POINT* pubkey = frame.GetPoint();
+  BIGNUM* response = frame.GetBN();
+
+  if ((EC_POINT_add(Schnorr::GetCurveGroup(), commit, m_commit.m_p.get(),
+                    other.m_commit.m_p.get(), frame.Ctx()) == 0) ||
+      (EC_POINT_add(Schnorr::GetCurveGroup(), pubkey, m_pubkey.m_P.get(),
+                    other.m_pubkey.m_P.get(), frame.Ctx()) == 0)) {
+    // Point aggregation failed
+    return false;
+  }
+
+  if (m_hasResponse &&
+      (BN_mod_add(response, m_response.m_r.get(), other.m_response.m_r.get(),
+                  Schnorr::GetCurveOrder(), frame.Ctx()) == 0)) {
+    // Response aggregation failed
+    return false;
+  }
+
+  if ((EC_POINT_copy(m_commit.m_p.get(), commit) == 0) ||
+      (EC_POINT_copy(m_pubkey.m_P.get(), pubkey) == 0) ||
+      (m_hasResponse && (BN_copy(m_response.m_r.get(), response) == NULL))) {
+    // Partial aggregate update failed
+    m_initialized = false;
+    return false;
+  }
+
+  for (size_t i = 0; i < m_signers.size(); i++) {
+    if (other.m_signers[i]) {
+      m_signers[i] = true;
+    }
+  }
+
+  return true;
+}
+
+// ============================================================================
+// Serialization
+// ============================================================================
+
+unsigned int PartialAggregate::SerializedSize(unsigned int committeeSize) {
+  return PARTIAL_AGGREGATE_SIZE_BYTES + BitmapSize(committeeSize) +
+         PARTIAL_AGGREGATE_FLAGS_BYTES + COMMIT_POINT_SIZE + PUB_KEY_SIZE +
+         RESPONSE_SIZE;
+}
+
+bool PartialAggregate::Serialize(bytes& dst, unsigned int offset) const {
+  if (!m_initialized) {
+    return false;
+  }
+
+  const unsigned int committeeSize = m_signers.size();
+  const unsigned int size = SerializedSize(committeeSize);
+  if ((offset + size) < size) {
+    // Overflow detected
+    return false;
+  }
+
+  if (offset + size > dst.size()) {
+    dst.resize(offset + size);
+  }
+  fill(dst.begin() + offset, dst.begin() + offset + size, 0x00);
+
+  unsigned int pos = offset;
+  for (unsigned int i = 0; i < PARTIAL_AGGREGATE_SIZE_BYTES; i++) {
+    dst[pos++] = static_cast<uint8_t>(
+        committeeSize >> (8 * (PARTIAL_AGGREGATE_SIZE_BYTES - 1 - i)));
+  }
+
+  for (unsigned int i = 0; i < committeeSize; i++) {
+    if (m_signers[i]) {
+      dst[pos + i / 8] |= static_cast<uint8_t>(0x80 >> (i % 8));
+    }
+  }
+  pos += BitmapSize(committeeSize);
+
+  dst[pos] = m_hasResponse ? PARTIAL_AGGREGATE_HAS_RESPONSE : 0x00;
+  pos += PARTIAL_AGGREGATE_FLAGS_BYTES;
+
+  if (!m_commit.Serialize(dst, pos)) {
+    return false;
+  }
+  pos += COMMIT_POINT_SIZE;
+
+  if (!m_pubkey.Serialize(dst, pos)) {
+    return false;
+  }
+  pos += PUB_KEY_SIZE;
+
+  if (m_hasResponse && !m_response.Serialize(dst, pos)) {
+    return false;
+  }
+
+  return true;
+}
+
+bool PartialAggregate::Deserialize(const bytes& src, unsigned int offset) {
+  if (offset > src.size()) {
+    // Offset beyond source size
+    return false;
+  }
+
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
+
+bool PartialAggregate::Deserialize(const uint8_t* src, size_t size) {
+  if (size < PARTIAL_AGGREGATE_SIZE_BYTES) {
+    // Can't get committee size
+    return false;
+  }
+
+  unsigned int committeeSize = 0;
+  size_t pos = 0;
+  for (unsigned int i = 0; i < PARTIAL_AGGREGATE_SIZE_BYTES; i++) {
+    committeeSize = (committeeSize << 8) | src[pos++];
+  }
+
+  if ((committeeSize == 0) || (size < SerializedSize(committeeSize))) {
+    // Invalid committee size
+    return false;
+  }
+
+  vector<bool> signers(committeeSize, false);
+  for (unsigned int i = 0; i < BitmapSize(committeeSize) * 8; i++) {
+    const bool bit = (src[pos + i / 8] & (0x80 >> (i % 8))) != 0;
+    if (i >= committeeSize) {
+      if (bit) {
+        // Padding bits must be zero
+        return false;
+      }
+    } else {
+      signers[i] = bit;
+    }
+  }
+  pos += BitmapSize(committeeSize);
+
+  if (find(signers.begin(), signers.end(), true) == signers.end()) {
+    // No signer
+    return false;
+  }
+
+  const uint8_t flags = src[pos];
+  if ((flags & ~PARTIAL_AGGREGATE_HAS_RESPONSE) != 0) {
+    // Unknown flags
+    return false;
+  }
+  const bool hasResponse = (flags & PARTIAL_AGGREGATE_HAS_RESPONSE) != 0;
+  pos += PARTIAL_AGGREGATE_FLAGS_BYTES;
+
+  CommitPoint commit;
+  PubKey pubkey;
+  Response response;
+  if (!commit.Deserialize(src + pos, COMMIT_POINT_SIZE) ||
+      !pubkey.Deserialize(src + pos + COMMIT_POINT_SIZE, PUB_KEY_SIZE)) {
+    // Point deserialization failed
+    return false;
+  }
+  pos += COMMIT_POINT_SIZE + PUB_KEY_SIZE;
+
+  if (hasResponse && !response.Deserialize(src + pos, RESPONSE_SIZE)) {
+    // Response deserialization failed
+    return false;
+  }
+
+  m_signers = move(signers);
+  m_commit = commit;
+  m_pubkey = pubkey;
+  m_response = response;
+  m_hasResponse = hasResponse;
+  m_initialized = true;
+  return true;
+}
+
+// ============================================================================
+// Comparison
+// ============================================================================
+
+bool PartialAggregate::operator==(const PartialAggregate& r) const {
+  return m_initialized && r.m_initialized && (m_signers == r.m_signers) &&
+         (m_hasResponse == r.m_hasResponse) && (m_commit == r.m_commit) &&
+         (m_pubkey == r.m_pubkey) &&
+         (!m_hasResponse || (m_response == r.m_response));
+}
@@ -17,6 +17,9 @@
 
 #include "MultiSig.h"
 #include "SchnorrInternal.h"
+#ifdef SCHNORR_NATIVE_SECP256K1
+#include "Secp256k1Group.h"
+#endif
 
 using namespace std;
 
@@ -40,7 +43,13 @@ Response::Response(const CommitSecret& secret, const Challenge& challenge,
   Set(secret, challenge, privkey);
 }
 
-Response::Response(const bytes& src, unsigned int offset) {
+Response::Response(const bytes& src, unsigned int offset)
+    : m_r(BN_new(), BN_clear_free), m_initialized(false) {
+  if (!constructPreChecks()) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+
   if (!Deserialize(src, offset)) {
     // We failed to init Response
   }
@@ -69,21 +78,42 @@ bool Response::Serialize(bytes& dst, unsigned int offset) const {
   return true;
 }
 
+bool Response::Serialize(Serialized& dst) const {
+  if (!m_initialized) {
+    return false;
+  }
+
+  return BIGNUMSerialize::SetNumber(dst.data(), dst.size(), m_r.get());
+}
+
 bool Response::Deserialize(const bytes& src, unsigned int offset) {
-  shared_ptr<BIGNUM> tmp =
-      BIGNUMSerialize::GetNumber(src, offset, RESPONSE_SIZE);
+  if (offset > src.size()) {
+    // Offset beyond source size
+    return false;
+  }
+
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
+
+bool Response::Deserialize(const uint8_t* src, size_t size) {
+  if (size < RESPONSE_SIZE) {
+    // Source too short
+    return false;
+  }
 
-  if (tmp == nullptr) {
+  if (!BIGNUMSerialize::GetNumber(m_r.get(), src, RESPONSE_SIZE)) {
     // Deserialization failure
     return false;
   }
 
-  m_r = tmp;
   m_initialized = true;
-
   return true;
 }
 
+bool Response::Deserialize(const Serialized& src) {
+  return Deserialize(src.data(), src.size());
+}
+
 void Response::Set(const CommitSecret& secret, const Challenge& challenge,
                    const PrivKey& privkey) {
   // Initial checks
@@ -106,26 +136,43 @@ void Response::Set(const CommitSecret& secret, const Challenge& challenge,
   m_initialized = false;
 
   // Compute s = k - krpiv*c
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    // Memory allocation failure
-    throw std::bad_alloc();
+#ifdef SCHNORR_NATIVE_SECP256K1
+  secp256k1::Scalar k, c, d, r;
+  if (!secp256k1::LoadScalar(k, secret.m_s.get()) ||
+      !secp256k1::LoadScalar(c, challenge.m_c.get()) ||
+      !secp256k1::LoadScalar(d, privkey.m_d.get())) {
+    // Scalar conversion failed
+    return;
   }
 
+  r.Mul(d, c);
+  r.Sub(k, r);
+  k.Clear();
+  d.Clear();
+
+  if (!secp256k1::StoreScalar(m_r.get(), r)) {
+    // Response conversion failed
+    return;
+  }
+#else
+  ScratchFrame frame{SecretScratch()};
+
   // kpriv*c
   if (BN_mod_mul(m_r.get(), challenge.m_c.get(), privkey.m_d.get(),
-                 Schnorr::GetCurveOrder(), ctx.get()) == 0) {
+                 Schnorr::GetCurveOrder(), frame.Ctx()) == 0) {
     // BIGNUM mod mul failed
     return;
   }
 
   // k-kpriv*c
   if (BN_mod_sub(m_r.get(), secret.m_s.get(), m_r.get(),
-                 Schnorr::GetCurveOrder(), ctx.get()) == 0) {
+                 Schnorr::GetCurveOrder(), frame.Ctx()) == 0) {
     // BIGNUM mod add failed
     return;
   }
 
+#endif
+
   m_initialized = true;
 }
 
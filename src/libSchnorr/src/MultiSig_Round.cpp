@@ -0,0 +1,323 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <condition_variable>
+#include <mutex>
+
+#include "MultiSig.h"
+#include "SchnorrInternal.h"
+#include "Secp256k1Group.h"
+
+using namespace std;
+
+/// State of a round, shared with the checks still queued or running so that
+/// it outlives the MultiSigRound. The members below m_mutex are guarded by
+/// it, except m_commits, which is only written before the signers are known
+/// and only read after the challenge is set.
+class MultiSigRound::Impl {
+ public:
+  const CommitteeKeySet m_committee;
+  const bytes m_message;
+  const unsigned int m_quorum;
+  const bool m_initialized;
+
+  mutable mutex m_mutex;
+  mutable condition_variable m_changed;
+  vector<uint8_t> m_committed;
+  vector<uint8_t> m_responded;
+  vector<CommitPoint> m_commits;
+  PartialAggregate m_commitSum;
+  unsigned int m_commitCount = 0;
+  bool m_signersKnown = false;
+  shared_ptr<Challenge> m_challenge;
+  secp256k1::ScalarSum m_responseSum;
+  unsigned int m_responseCount = 0;
+  shared_ptr<Signature> m_signature;
+  vector<unsigned int> m_faulty;
+  bool m_failed = false;
+
+  Impl(const CommitteeKeySet& committee, const uint8_t* message, size_t size,
+       unsigned int quorum)
+      : m_committee(committee),
+        m_message(message, message + size),
+        m_quorum(quorum),
+        m_initialized(committee.Initialized() && (quorum > 0) &&
+                      (quorum <= committee.Size())),
+        m_committed(committee.Size(), 0),
+        m_responded(committee.Size(), 0),
+        m_commits(committee.Size()) {}
+
+  Impl(const Impl&) = delete;
+  Impl& operator=(const Impl&) = delete;
+
+  /// Adds a checked commit to the running sums, and sets the challenge once
+  /// quorum commits are in.
+  void AcceptCommit(unsigned int index, const CommitPoint& commitPoint,
+                    bool valid) {
+    // Built before taking the lock, as it copies points
+    PartialAggregate contribution;
+    if (valid) {
+      contribution = PartialAggregate(m_committed.size(), index,
+                                      m_committee.GetPubKeys()[index],
+                                      commitPoint);
+    }
+
+    CommitPoint aggregatedCommit;
+    PubKey aggregatedPubKey;
+    {
+      lock_guard<mutex> lock(m_mutex);
+      if (!contribution.Initialized()) {
+        // Commit does not match its hash
+        m_faulty.push_back(index);
+        return;
+      }
+
+      if (m_signersKnown) {
+        // Signers already known
+        return;
+      }
+
+      if ((m_commitCount > 0) && !m_commitSum.Merge(contribution)) {
+        // Commit aggregation failed
+        m_failed = true;
+        m_changed.notify_all();
+        return;
+      }
+      if (m_commitCount == 0) {
+        m_commitSum = contribution;
+      }
+      m_commits[index] = commitPoint;
+
+      if (++m_commitCount < m_quorum) {
+        return;
+      }
+      m_signersKnown = true;
+      aggregatedCommit = m_commitSum.GetCommit();
+      aggregatedPubKey = m_commitSum.GetPubKey();
+    }
+
+    // Built without the lock, as it hashes the whole message
+    auto challenge =
+        make_shared<Challenge>(aggregatedCommit, aggregatedPubKey, m_message);
+
+    lock_guard<mutex> lock(m_mutex);
+    if (challenge->Initialized()) {
+      m_challenge = challenge;
+    } else {
+      // Challenge generation failed
+      m_failed = true;
+    }
+    m_changed.notify_all();
+  }
+
+  /// Adds a checked response to the running sum, and sets the signature
+  /// once all signers have responded.
+  void AcceptResponse(unsigned int index, const Response& response,
+                      bool valid) {
+    // Converted before taking the lock
+    Response::Serialized serialized;
+    secp256k1::Scalar scalar;
+    valid = valid && response.Serialize(serialized) &&
+            scalar.SetB32(serialized.data());
+
+    Response::Serialized aggregated;
+    {
+      lock_guard<mutex> lock(m_mutex);
+      if (!valid) {
+        // Response verification failed
+        m_faulty.push_back(index);
+        m_failed = true;
+        m_changed.notify_all();
+        return;
+      }
+
+      m_responseSum.Add(scalar);
+      if (++m_responseCount < m_quorum) {
+        m_changed.notify_all();
+        return;
+      }
+      m_responseSum.Get().GetB32(aggregated.data());
+    }
+
+    // Built without the lock, as it allocates
+    Response aggregatedResponse;
+    shared_ptr<Signature> signature;
+    if (aggregatedResponse.Deserialize(aggregated)) {
+      signature = MultiSig::AggregateSign(*m_challenge, aggregatedResponse);
+    }
+
+    lock_guard<mutex> lock(m_mutex);
+    if (signature != nullptr) {
+      m_signature = signature;
+    } else {
+      // Response aggregation failed
+      m_failed = true;
+    }
+    m_changed.notify_all();
+  }
+};
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+MultiSigRound::MultiSigRound(const CommitteeKeySet& committee,
+                             const bytes& message, unsigned int quorum)
+    : MultiSigRound(committee, message.data(), message.size(), quorum) {}
+
+MultiSigRound::MultiSigRound(const CommitteeKeySet& committee,
+                             const uint8_t* message, size_t size,
+                             unsigned int quorum)
+    : m_impl(make_shared<Impl>(committee, message, size, quorum)) {}
+
+MultiSigRound::~MultiSigRound() {}
+
+bool MultiSigRound::Initialized() const { return m_impl->m_initialized; }
+
+// ============================================================================
+// Contributions
+// ============================================================================
+
+bool MultiSigRound::AddCommit(unsigned int index,
+                              const CommitPoint& commitPoint,
+                              const CommitPointHash& commitPointHash) {
+  Impl& impl = *m_impl;
+  if (!impl.m_initialized || (index >= impl.m_committed.size())) {
+    // Round not initialized or index beyond committee size
+    return false;
+  }
+
+  if (!commitPoint.Initialized() || !commitPointHash.Initialized()) {
+    // Commit not initialized
+    return false;
+  }
+
+  {
+    lock_guard<mutex> lock(impl.m_mutex);
+    if (impl.m_signersKnown || impl.m_committed[index]) {
+      // Signers already known or commit already received
+      return false;
+    }
+    impl.m_committed[index] = 1;
+  }
+
+  shared_ptr<Impl> round = m_impl;
+  WorkerPool::Get().Submit([round, index, commitPoint, commitPointHash]() {
+    try {
+      const bool valid = CommitPointHash(commitPoint) == commitPointHash;
+      round->AcceptCommit(index, commitPoint, valid);
+    } catch (const std::exception& e) {
+      // Out of memory, the commit is dropped
+    }
+  });
+  return true;
+}
+
+bool MultiSigRound::AddResponse(unsigned int index, const Response& response) {
+  Impl& impl = *m_impl;
+  if (!impl.m_initialized || (index >= impl.m_responded.size())) {
+    // Round not initialized or index beyond committee size
+    return false;
+  }
+
+  if (!response.Initialized()) {
+    // Response not initialized
+    return false;
+  }
+
+  shared_ptr<Challenge> challenge;
+  {
+    lock_guard<mutex> lock(impl.m_mutex);
+    if ((impl.m_challenge == nullptr) ||
+        !impl.m_commitSum.GetSigners()[index] || impl.m_responded[index]) {
+      // Not a signer or response already received
+      return false;
+    }
+    impl.m_responded[index] = 1;
+    challenge = impl.m_challenge;
+  }
+
+  shared_ptr<Impl> round = m_impl;
+  WorkerPool::Get().Submit([round, index, challenge, response]() {
+    try {
+      const bool valid = MultiSig::VerifyResponse(
+          response, *challenge, round->m_committee.GetPubKeys()[index],
+          round->m_commits[index]);
+      round->AcceptResponse(index, response, valid);
+    } catch (const std::exception& e) {
+      // Out of memory, the response is dropped
+    }
+  });
+  return true;
+}
+
+// ============================================================================
+// Results
+// ============================================================================
+
+shared_ptr<Challenge> MultiSigRound::GetChallenge() const {
+  lock_guard<mutex> lock(m_impl->m_mutex);
+  return m_impl->m_challenge;
+}
+
+shared_ptr<Challenge> MultiSigRound::WaitForChallenge(
+    chrono::milliseconds timeout) const {
+  const Impl& impl = *m_impl;
+  unique_lock<mutex> lock(impl.m_mutex);
+  impl.m_changed.wait_for(lock, timeout, [&impl]() {
+    return (impl.m_challenge != nullptr) || impl.m_failed;
+  });
+  return impl.m_challenge;
+}
+
+shared_ptr<Signature> MultiSigRound::GetSignature() const {
+  lock_guard<mutex> lock(m_impl->m_mutex);
+  return m_impl->m_signature;
+}
+
+shared_ptr<Signature> MultiSigRound::WaitForSignature(
+    chrono::milliseconds timeout) const {
+  const Impl& impl = *m_impl;
+  unique_lock<mutex> lock(impl.m_mutex);
+  impl.m_changed.wait_for(lock, timeout, [&impl]() {
+    return (impl.m_signature != nullptr) || impl.m_failed;
+  });
+  return impl.m_signature;
+}
+
+vector<bool> MultiSigRound::GetSigners() const {
+  const Impl& impl = *m_impl;
+  lock_guard<mutex> lock(impl.m_mutex);
+  if (impl.m_challenge == nullptr) {
+    return vector<bool>(impl.m_committed.size(), false);
+  }
+  return impl.m_commitSum.GetSigners();
+}
+
+shared_ptr<PubKey> MultiSigRound::GetAggregatedPubKey() const {
+  const Impl& impl = *m_impl;
+  lock_guard<mutex> lock(impl.m_mutex);
+  if (impl.m_challenge == nullptr) {
+    return nullptr;
+  }
+  return make_shared<PubKey>(impl.m_commitSum.GetPubKey());
+}
+
+vector<unsigned int> MultiSigRound::GetFaulty() const {
+  lock_guard<mutex> lock(m_impl->m_mutex);
+  return m_impl->m_faulty;
+}
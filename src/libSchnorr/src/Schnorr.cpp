@@ -29,6 +29,9 @@
 
 #include "Schnorr.h"
 #include "SchnorrInternal.h"
+#ifdef SCHNORR_NATIVE_SECP256K1
+#include "Secp256k1Group.h"
+#endif
 
 using namespace std;
 
@@ -61,17 +64,11 @@ const std::unique_ptr<Schnorr::Curve> Schnorr::m_curve =
 const EC_GROUP* Schnorr::GetCurveGroup() { return m_curve->m_group.get(); }
 const BIGNUM* Schnorr::GetCurveOrder() { return m_curve->m_order.get(); }
 
-std::mutex m_mutexSchnorr;
-
 Schnorr::Schnorr() {}
 
 Schnorr::~Schnorr() {}
 
 PairOfKey Schnorr::GenKeyPair() {
-  // This mutex is to prevent multi-threaded issues with the use of openssl
-  // functions
-  lock_guard<mutex> g(m_mutexSchnorr);
-
   PrivKey privkey;
   PubKey pubkey(privkey);
 
@@ -86,22 +83,23 @@ bool Schnorr::Sign(const bytes& message, const PrivKey& privkey,
 bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
                    const PrivKey& privkey, const PubKey& pubkey,
                    Signature& result) {
-  // This mutex is to prevent multi-threaded issues with the use of openssl
-  // functions
-  lock_guard<mutex> g(m_mutexSchnorr);
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
+    return false;
+  }
+
+  return Sign(message.data() + offset, size, privkey, pubkey, result);
+}
 
+bool Schnorr::Sign(const uint8_t* message, size_t size, const PrivKey& privkey,
+                   const PubKey& pubkey, Signature& result) {
   // Initial checks
 
-  if (message.size() == 0) {
+  if (size == 0) {
     // Empty message
     return false;
   }
 
-  if (message.size() < (offset + size)) {
-    // Offset and size beyond message size
-    return false;
-  }
-
   // Main signing procedure
 
   // The algorithm takes the following steps:
@@ -119,24 +117,22 @@ bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
   bool err = false;  // detect error
   int res = 1;       // result to return
 
-  unique_ptr<BIGNUM, void (*)(BIGNUM*)> k(BN_new(), BN_clear_free);
-  unique_ptr<EC_POINT, void (*)(EC_POINT*)> Q(EC_POINT_new(GetCurveGroup()),
-                                              EC_POINT_clear_free);
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+  ScratchFrame frame{SecretScratch()};
+  BIGNUM* k = frame.GetBN();
+  EC_POINT* Q = frame.GetPoint();
+  BN_CTX* ctx = frame.Ctx();
 
-  if ((k != nullptr) && (ctx != nullptr) && (Q != nullptr)) {
+  if ((k != nullptr) && (Q != nullptr)) {
     do {
       err = false;
 
       // 1. Generate a random k from [1,..., order-1]
       do {
-        err = (BN_generate_dsa_nonce(
-                   k.get(), GetCurveOrder(), privkey.m_d.get(),
-                   static_cast<const unsigned char*>(message.data()),
-                   message.size(), ctx.get()) == 0);
+        err = (BN_generate_dsa_nonce(k, GetCurveOrder(), privkey.m_d.get(),
+                                     message, size, ctx) == 0);
 
         // err =
-        // (BN_rand(k.get(), BN_num_bits(GetCurveOrder()), -1, 0) == 0);
+        // (BN_rand(k, BN_num_bits(GetCurveOrder()), -1, 0) == 0);
         if (err) {
           // Random generation failed
           return false;
@@ -144,14 +140,32 @@ bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
 #if defined(__clang__)
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wparentheses-equality"
-      } while (BN_is_zero(k.get()));
+      } while (BN_is_zero(k));
 #pragma clang diagnostic pop
 #else
-      } while (BN_is_zero(k.get()));
+      } while (BN_is_zero(k));
 #endif
+#ifdef SCHNORR_NATIVE_SECP256K1
+      // 2. Compute the commitment Q = kG from the precomputed table of G
+      secp256k1::Scalar nonce;
+      err = !secp256k1::LoadScalar(nonce, k);
+      if (err) {
+        // Nonce conversion failed
+        return false;
+      }
+
+      secp256k1::GeJacobian commit;
+      secp256k1::EcMultGen(commit, nonce);
+      secp256k1::GeAffine commit_affine;
+      commit_affine.SetJacobianVar(commit);
+
+      // 3. Compute the challenge r = H(Q, kpub, m)
+
+      // Convert the commitment to octets first
+      commit_affine.GetCompressed(buf.data());
+#else
       // 2. Compute the commitment Q = kG, where G is the base point
-      err = (EC_POINT_mul(GetCurveGroup(), Q.get(), k.get(), NULL, NULL,
-                          NULL) == 0);
+      err = (EC_POINT_mul(GetCurveGroup(), Q, k, NULL, NULL, ctx) == 0);
       if (err) {
         // Commit generation failed
         return false;
@@ -160,14 +174,15 @@ bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
       // 3. Compute the challenge r = H(Q, kpub, m)
 
       // Convert the committment to octets first
-      err = (EC_POINT_point2oct(GetCurveGroup(), Q.get(),
+      err = (EC_POINT_point2oct(GetCurveGroup(), Q,
                                 POINT_CONVERSION_COMPRESSED, buf.data(),
                                 PUBKEY_COMPRESSED_SIZE_BYTES,
-                                NULL) != PUBKEY_COMPRESSED_SIZE_BYTES);
+                                ctx) != PUBKEY_COMPRESSED_SIZE_BYTES);
       if (err) {
         // Commit octet conversion failed
         return false;
       }
+#endif
 
       // Hash commitment
       sha2.Update(buf);
@@ -179,7 +194,7 @@ bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
       err = (EC_POINT_point2oct(GetCurveGroup(), pubkey.m_P.get(),
                                 POINT_CONVERSION_COMPRESSED, buf.data(),
                                 PUBKEY_COMPRESSED_SIZE_BYTES,
-                                NULL) != PUBKEY_COMPRESSED_SIZE_BYTES);
+                                ctx) != PUBKEY_COMPRESSED_SIZE_BYTES);
       if (err) {
         // Pubkey octet conversion failed
         return false;
@@ -189,9 +204,31 @@ bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
       sha2.Update(buf);
 
       // Hash message
-      sha2.Update(message, offset, size);
+      sha2.Update(message, size);
       bytes digest = sha2.Finalize();
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+      // Build the challenge and compute s = k - r*kpriv on native scalars
+      secp256k1::Scalar r, s, d;
+      r.SetB32(digest.data());
+      err = !secp256k1::LoadScalar(d, privkey.m_d.get());
+      if (err) {
+        // Private key conversion failed
+        return false;
+      }
+
+      s.Mul(r, d);
+      s.Sub(nonce, s);
+      nonce.Clear();
+      d.Clear();
+
+      err = !secp256k1::StoreScalar(result.m_r.get(), r) ||
+            !secp256k1::StoreScalar(result.m_s.get(), s);
+      if (err) {
+        // Signature conversion failed
+        return false;
+      }
+#else
       // Build the challenge
       err =
           ((BN_bin2bn(digest.data(), digest.size(), result.m_r.get())) == NULL);
@@ -201,7 +238,7 @@ bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
       }
 
       err = (BN_nnmod(result.m_r.get(), result.m_r.get(), GetCurveOrder(),
-                      ctx.get()) == 0);
+                      ctx) == 0);
       if (err) {
         // BIGNUM NNmod failed
         return false;
@@ -210,19 +247,20 @@ bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
       // 4. Compute s = k - r*krpiv
       // 4.1 r*kpriv
       err = (BN_mod_mul(result.m_s.get(), result.m_r.get(), privkey.m_d.get(),
-                        GetCurveOrder(), ctx.get()) == 0);
+                        GetCurveOrder(), ctx) == 0);
       if (err) {
         // Response mod mul failed
         return false;
       }
 
       // 4.2 k-r*kpriv
-      err = (BN_mod_sub(result.m_s.get(), k.get(), result.m_s.get(),
-                        GetCurveOrder(), ctx.get()) == 0);
+      err = (BN_mod_sub(result.m_s.get(), k, result.m_s.get(),
+                        GetCurveOrder(), ctx) == 0);
       if (err) {
         // BIGNUM mod sub failed
         return false;
       }
+#endif
 
       // Clear buffer
       fill(buf.begin(), buf.end(), 0x00);
@@ -249,22 +287,23 @@ bool Schnorr::Verify(const bytes& message, const Signature& toverify,
 bool Schnorr::Verify(const bytes& message, unsigned int offset,
                      unsigned int size, const Signature& toverify,
                      const PubKey& pubkey) {
-  // This mutex is to prevent multi-threaded issues with the use of openssl
-  // functions
-  lock_guard<mutex> g(m_mutexSchnorr);
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
+    return false;
+  }
+
+  return Verify(message.data() + offset, size, toverify, pubkey);
+}
 
+bool Schnorr::Verify(const uint8_t* message, size_t size,
+                     const Signature& toverify, const PubKey& pubkey) {
   // Initial checks
 
-  if (message.size() == 0) {
+  if (size == 0) {
     // Empty message
     return false;
   }
 
-  if (message.size() < (offset + size)) {
-    // Offset and size beyond message size
-    return false;
-  }
-
   try {
     // Main verification procedure
 
@@ -283,13 +322,12 @@ bool Schnorr::Verify(const bytes& message, unsigned int offset,
     bool err2 = false;
 
     // Regenerate the commitmment part of the signature
-    unique_ptr<BIGNUM, void (*)(BIGNUM*)> challenge_built(BN_new(),
-                                                          BN_clear_free);
-    unique_ptr<EC_POINT, void (*)(EC_POINT*)> Q(EC_POINT_new(GetCurveGroup()),
-                                                EC_POINT_clear_free);
-    unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+    ScratchFrame frame;
+    BIGNUM* challenge_built = frame.GetBN();
+    EC_POINT* Q = frame.GetPoint();
+    BN_CTX* ctx = frame.Ctx();
 
-    if ((challenge_built != nullptr) && (ctx != nullptr) && (Q != nullptr)) {
+    if ((challenge_built != nullptr) && (Q != nullptr)) {
       // 1. Check if r,s is in [1, ..., order-1]
       err2 = (BN_is_zero(toverify.m_r.get()) ||
               BN_is_negative(toverify.m_r.get()) ||
@@ -309,10 +347,26 @@ bool Schnorr::Verify(const bytes& message, unsigned int offset,
         return false;
       }
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+      // 2.-4.2 Compute Q = sG + r*kpub (failing if Q = O) and convert the
+      // commitment and the public key to octets
+      bytes encoded(2 * PUBKEY_COMPRESSED_SIZE_BYTES);
+      err2 = !secp256k1::VerifyCommitment(
+          toverify.m_s.get(), toverify.m_r.get(), pubkey.m_P.get(),
+          encoded.data(), encoded.data() + PUBKEY_COMPRESSED_SIZE_BYTES,
+          ctx);
+      err = err || err2;
+      if (err2) {
+        // Commit regenerate failed
+        return false;
+      }
+
+      // Hash commitment and public key
+      sha2.Update(encoded);
+#else
       // 2. Compute Q = sG + r*kpub
-      err2 =
-          (EC_POINT_mul(GetCurveGroup(), Q.get(), toverify.m_s.get(),
-                        pubkey.m_P.get(), toverify.m_r.get(), ctx.get()) == 0);
+      err2 = (EC_POINT_mul(GetCurveGroup(), Q, toverify.m_s.get(),
+                           pubkey.m_P.get(), toverify.m_r.get(), ctx) == 0);
       err = err || err2;
       if (err2) {
         // Commit regenerate failed
@@ -320,7 +374,7 @@ bool Schnorr::Verify(const bytes& message, unsigned int offset,
       }
 
       // 3. If Q = O (the neutral point), return 0;
-      err2 = (EC_POINT_is_at_infinity(GetCurveGroup(), Q.get()));
+      err2 = (EC_POINT_is_at_infinity(GetCurveGroup(), Q));
       err = err || err2;
       if (err2) {
         // Commit at infinity
@@ -329,10 +383,10 @@ bool Schnorr::Verify(const bytes& message, unsigned int offset,
 
       // 4. r' = H(Q, kpub, m)
       // 4.1 Convert the committment to octets first
-      err2 = (EC_POINT_point2oct(GetCurveGroup(), Q.get(),
+      err2 = (EC_POINT_point2oct(GetCurveGroup(), Q,
                                  POINT_CONVERSION_COMPRESSED, buf.data(),
                                  PUBKEY_COMPRESSED_SIZE_BYTES,
-                                 NULL) != PUBKEY_COMPRESSED_SIZE_BYTES);
+                                 ctx) != PUBKEY_COMPRESSED_SIZE_BYTES);
       err = err || err2;
       if (err2) {
         // Commit octet conversion failed
@@ -349,7 +403,7 @@ bool Schnorr::Verify(const bytes& message, unsigned int offset,
       err2 = (EC_POINT_point2oct(GetCurveGroup(), pubkey.m_P.get(),
                                  POINT_CONVERSION_COMPRESSED, buf.data(),
                                  PUBKEY_COMPRESSED_SIZE_BYTES,
-                                 NULL) != PUBKEY_COMPRESSED_SIZE_BYTES);
+                                 ctx) != PUBKEY_COMPRESSED_SIZE_BYTES);
       err = err || err2;
       if (err2) {
         // Pubkey octet conversion failed
@@ -358,22 +412,23 @@ bool Schnorr::Verify(const bytes& message, unsigned int offset,
 
       // Hash public key
       sha2.Update(buf);
+#endif
 
       // 4.3 Hash message
-      sha2.Update(message, offset, size);
+      sha2.Update(message, size);
       bytes digest = sha2.Finalize();
 
       // 5. return r' == r
-      err2 = (BN_bin2bn(digest.data(), digest.size(), challenge_built.get()) ==
-              NULL);
+      err2 =
+          (BN_bin2bn(digest.data(), digest.size(), challenge_built) == NULL);
       err = err || err2;
       if (err2) {
         // Challenge bin2bn conversion failed
         return false;
       }
 
-      err2 = (BN_nnmod(challenge_built.get(), challenge_built.get(),
-                       GetCurveOrder(), ctx.get()) == 0);
+      err2 = (BN_nnmod(challenge_built, challenge_built, GetCurveOrder(),
+                       ctx) == 0);
       err = err || err2;
       if (err2) {
         // Challenge rebuild mod failed
@@ -385,17 +440,37 @@ bool Schnorr::Verify(const bytes& message, unsigned int offset,
       // Memory allocation failure
       throw std::bad_alloc();
     }
-    return (!err) && (BN_cmp(challenge_built.get(), toverify.m_r.get()) == 0);
+    return (!err) && (BN_cmp(challenge_built, toverify.m_r.get()) == 0);
   } catch (const std::exception& e) {
     // LOG_GENERAL(WARNING, "Error with Schnorr::Verify." << ' ' << e.what());
     return false;
   }
 }
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+bool Schnorr::Verify(const bytes& message, const Signature& toverify,
+                     const VerifyingKey& key) {
+  return Verify(message, 0, message.size(), toverify, key);
+}
+
+bool Schnorr::Verify(const bytes& message, unsigned int offset,
+                     unsigned int size, const Signature& toverify,
+                     const VerifyingKey& key) {
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
+    return false;
+  }
+
+  return key.verify({}, message.data() + offset, size, toverify);
+}
+
+bool Schnorr::Verify(const uint8_t* message, size_t size,
+                     const Signature& toverify, const VerifyingKey& key) {
+  return key.verify({}, message, size, toverify);
+}
+#endif
+
 string Schnorr::PrintPoint(const EC_POINT* point) {
-  // This mutex is to prevent multi-threaded issues with the use of openssl
-  // functions
-  lock_guard<mutex> g(m_mutexSchnorr);
   unique_ptr<BIGNUM, void (*)(BIGNUM*)> x(BN_new(), BN_clear_free);
   unique_ptr<BIGNUM, void (*)(BIGNUM*)> y(BN_new(), BN_clear_free);
 
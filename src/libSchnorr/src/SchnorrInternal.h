@@ -19,14 +19,21 @@
 #define ZILLIQA_SRC_LIBSCHNORR_SRC_SCHNORRINTERNAL_H_
 
 #include <openssl/bn.h>
+#include <openssl/crypto.h>
 #include <openssl/ec.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <boost/algorithm/hex.hpp>
 #include <boost/functional/hash.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "generate_dsa_nonce.h"
@@ -40,12 +47,24 @@ const unsigned int PRIV_KEY_SIZE = 32;
 const unsigned int PUB_KEY_SIZE = 33;
 const unsigned int SIGNATURE_CHALLENGE_SIZE = 32;
 const unsigned int SIGNATURE_RESPONSE_SIZE = 32;
+const unsigned int SIGNATURE_COMMIT_SIZE = 33;
 const unsigned int COMMIT_SECRET_SIZE = 32;
 const unsigned int COMMIT_POINT_HASH_SIZE = 32;
 const unsigned int COMMIT_POINT_SIZE = 33;
 const unsigned int CHALLENGE_SIZE = 32;
 const unsigned int RESPONSE_SIZE = 32;
 
+// Commit points of a CompactRound or a NoncePool are kept as their x and y
+// coordinates, so that reading them back needs no square root
+const unsigned int COMPACT_COMMIT_POINT_SIZE = 64;
+
+/// Returns true if the size bytes from offset lie within message. Written so
+/// that offset + size cannot overflow.
+inline bool MessageRangeValid(const bytes& message, unsigned int offset,
+                              unsigned int size) {
+  return (offset <= message.size()) && (size <= message.size() - offset);
+}
+
 /// EC-Schnorr utility for serializing BIGNUM data type.
 struct BIGNUMSerialize {
   /// Deserializes a BIGNUM from specified byte stream.
@@ -53,9 +72,21 @@ struct BIGNUMSerialize {
                                            unsigned int offset,
                                            unsigned int size);
 
+  /// Deserializes a BIGNUM from the size bytes at src.
+  static std::shared_ptr<BIGNUM> GetNumber(const uint8_t* src,
+                                           unsigned int size);
+
+  /// Deserializes a BIGNUM from the size bytes at src into dst, reusing the
+  /// digits already allocated by dst.
+  static bool GetNumber(BIGNUM* dst, const uint8_t* src, unsigned int size);
+
   /// Serializes a BIGNUM into specified byte stream.
   static void SetNumber(bytes& dst, unsigned int offset, unsigned int size,
                         const std::shared_ptr<BIGNUM>& value);
+
+  /// Serializes a BIGNUM into the size bytes at dst, padded with leading
+  /// zeroes. Returns false if the BIGNUM does not fit.
+  static bool SetNumber(uint8_t* dst, unsigned int size, const BIGNUM* value);
 };
 
 /// EC-Schnorr utility for serializing ECPOINT data type.
@@ -65,9 +96,170 @@ struct ECPOINTSerialize {
                                              unsigned int offset,
                                              unsigned int size);
 
+  /// Deserializes an ECPOINT from the size bytes at src.
+  static std::shared_ptr<EC_POINT> GetNumber(const uint8_t* src,
+                                             unsigned int size);
+
+  /// Deserializes an ECPOINT from the size bytes at src into dst. With the
+  /// native backend, compressed points are decompressed without allocating
+  /// a temporary.
+  static bool GetNumber(EC_POINT* dst, const uint8_t* src, unsigned int size);
+
   /// Serializes an ECPOINT into specified byte stream.
   static void SetNumber(bytes& dst, unsigned int offset, unsigned int size,
                         const std::shared_ptr<EC_POINT>& value);
+
+  /// Serializes an ECPOINT in compressed form into the size bytes at dst,
+  /// padded with leading zeroes. Returns false if the encoding does not fit.
+  static bool SetNumber(uint8_t* dst, unsigned int size,
+                        const EC_POINT* value);
+};
+
+/// Per-thread cache of the OpenSSL scratch objects used by the hot paths.
+/// The BN_CTX and the temporary EC_POINTs are allocated on first use by each
+/// thread and reused across calls. Objects are only handed out through a
+/// ScratchFrame, so nested calls on the same thread never alias each other.
+class alignas(64) ScratchPool {
+  friend class ScratchFrame;
+
+  std::unique_ptr<BN_CTX, void (*)(BN_CTX*)> m_ctx;
+  std::vector<std::unique_ptr<EC_POINT, void (*)(EC_POINT*)>> m_points;
+  unsigned int m_pointsInUse{};
+
+  ScratchPool();
+
+ public:
+  /// Returns the pool owned by the calling thread.
+  static ScratchPool& Get();
+};
+
+/// Selects a ScratchFrame with its own BN_CTX, for operations on secret keys
+/// and nonces.
+struct SecretScratch {};
+
+/// Borrows scratch objects from the calling thread's ScratchPool for the
+/// lifetime of the frame. BIGNUMs come from a BN_CTX_start/BN_CTX_end frame
+/// and are cleared on release, since they may hold secret scalars. OpenSSL
+/// also takes its own temporaries from the BN_CTX (such as the product in
+/// BN_mod_mul), which stay in the pooled BN_CTX until the thread exits: frames
+/// opened with SecretScratch use a short-lived BN_CTX instead, which clears
+/// all of them when the frame closes.
+class ScratchFrame {
+  static const unsigned int MAX_BIGNUMS = 8;
+
+  ScratchPool& m_pool;
+  std::unique_ptr<BN_CTX, void (*)(BN_CTX*)> m_secretCtx;
+  std::array<BIGNUM*, MAX_BIGNUMS> m_bignums{};
+  unsigned int m_numBignums{};
+  unsigned int m_firstPoint;
+
+ public:
+  /// Opens a new frame on the calling thread's pool.
+  ScratchFrame();
+
+  /// Opens a new frame on the calling thread's pool, with a BN_CTX of its own
+  /// allocated from the OpenSSL secure heap when one is set up.
+  explicit ScratchFrame(SecretScratch);
+
+  /// Clears and returns all borrowed objects to the pool.
+  ~ScratchFrame();
+
+  ScratchFrame(const ScratchFrame&) = delete;
+  ScratchFrame& operator=(const ScratchFrame&) = delete;
+
+  /// Returns the frame's BN_CTX (usable for any OpenSSL call).
+  BN_CTX* Ctx() const;
+
+  /// Returns a zeroed temporary BIGNUM.
+  BIGNUM* GetBN();
+
+  /// Returns a temporary EC_POINT on the curve group.
+  EC_POINT* GetPoint();
+};
+
+/// Process-wide pool of worker threads for the batch operations. ParallelFor
+/// spreads the tasks of a call over the workers and the calling thread, which
+/// keeps taking tasks until none are left, so concurrent and nested calls
+/// always make progress, even without workers.
+class WorkerPool {
+  struct Job;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::deque<std::shared_ptr<Job>> m_jobs;
+  std::vector<std::thread> m_workers;
+  bool m_stop{};
+
+  std::mutex m_configMutex;
+  std::atomic<unsigned int> m_threads{1};
+
+  WorkerPool();
+  ~WorkerPool();
+
+  void startWorkers(unsigned int threads);
+  void stopWorkers();
+  void drainJobs();
+  void workerLoop();
+
+ public:
+  /// Returns the process-wide pool, started with one thread per core.
+  static WorkerPool& Get();
+
+  /// Sets the number of threads, the calling one included, that run the
+  /// tasks of each call. 0 selects the number of cores.
+  void SetThreads(unsigned int threads);
+
+  /// Returns the number of threads that run the tasks of each call.
+  unsigned int GetThreads() const;
+
+  /// Runs task(i) for every i in [0, count) and returns when all are done.
+  /// Tasks run concurrently in any order and must not throw.
+  void ParallelFor(std::size_t count,
+                   const std::function<void(std::size_t)>& task);
+
+  /// Runs task in the background on a worker, or on the calling thread if
+  /// the pool has no workers. The task must not throw.
+  void Submit(std::function<void()> task);
+};
+
+/// Number of items handled by one pool task of a ParallelForChunks call,
+/// for the bulk serialization, aggregation and committee key conversion.
+const std::size_t BULK_CHUNK_SIZE = 256;
+
+/// Runs task(i) for every i in [0, count) on the worker pool, chunk indices
+/// per pool task. Returns false if a task returns false or throws; the
+/// remaining indices of its chunk are then skipped.
+inline bool ParallelForChunks(std::size_t count, std::size_t chunk,
+                              const std::function<bool(std::size_t)>& task) {
+  const std::size_t chunks = (count + chunk - 1) / chunk;
+  std::vector<uint8_t> done(chunks, 0);
+  WorkerPool::Get().ParallelFor(chunks, [&](std::size_t c) {
+    try {
+      const std::size_t end = std::min(count, (c + 1) * chunk);
+      for (std::size_t i = c * chunk; i < end; i++) {
+        if (!task(i)) {
+          return;
+        }
+      }
+      done[c] = 1;
+    } catch (const std::exception& e) {
+    }
+  });
+  return std::find(done.begin(), done.end(), 0) == done.end();
+}
+
+/// Nonce taken from a NoncePool: the scalar k, the affine coordinates of
+/// kG and the commit point hash of kG, all big-endian. Cleared on
+/// destruction.
+struct PooledNonce {
+  std::array<uint8_t, PRIV_KEY_SIZE> k{};
+  std::array<uint8_t, COMPACT_COMMIT_POINT_SIZE> commit{};
+  std::array<uint8_t, COMMIT_POINT_HASH_SIZE> hash{};
+
+  PooledNonce() = default;
+  PooledNonce(const PooledNonce&) = default;
+  PooledNonce& operator=(const PooledNonce&) = default;
+  ~PooledNonce() { OPENSSL_cleanse(k.data(), k.size()); }
 };
 
 template <class T>
@@ -86,4 +278,10 @@ static bool SerializableCryptoToHexStr(const T& input, std::string& str) {
 const uint8_t SECOND_DOMAIN_SEPARATED_HASH_FUNCTION_BYTE = 0x01;
 const uint8_t THIRD_DOMAIN_SEPARATED_HASH_FUNCTION_BYTE = 0x11;
 
+/// Computes the commit point hash H(0x01 || point) mod order of the commit
+/// point whose compressed encoding is at compressed, as a big-endian scalar.
+/// Defined with CommitPointHash.
+bool HashCommitPoint(const uint8_t* compressed,
+                     std::array<uint8_t, COMMIT_POINT_HASH_SIZE>& hash);
+
 #endif  // ZILLIQA_SRC_LIBSCHNORR_SRC_SCHNORRINTERNAL_H_
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/rand.h>
+#include <unistd.h>
+
+#include "Schnorr.h"
+#include "SchnorrInternal.h"
+#include "Secp256k1Group.h"
+
+using namespace std;
+
+/// Time the background thread waits before retrying after a random
+/// generation failure.
+const chrono::milliseconds NONCE_POOL_RETRY_DELAY(100);
+
+namespace {
+
+/// Generates a random k from [1, ..., order-1] with the commitment kG and
+/// its commit point hash H(0x01 || kG).
+bool GenerateNonce(PooledNonce& nonce) {
+  secp256k1::Scalar k;
+  do {
+    if (RAND_bytes(nonce.k.data(), nonce.k.size()) != 1) {
+      // Random generation failed
+      return false;
+    }
+  } while (!k.SetB32(nonce.k.data()) || k.IsZero());
+
+  secp256k1::GeJacobian commit_jacobian;
+  secp256k1::EcMultGen(commit_jacobian, k);
+  k.Clear();
+  secp256k1::GeAffine commit;
+  commit.SetJacobianVar(commit_jacobian);
+  commit.x.GetB32(nonce.commit.data());
+  commit.y.GetB32(nonce.commit.data() + COMPACT_COMMIT_POINT_SIZE / 2);
+
+  array<uint8_t, COMMIT_POINT_SIZE> compressed;
+  commit.GetCompressed(compressed.data());
+  return HashCommitPoint(compressed.data(), nonce.hash);
+}
+
+}  // namespace
+
+class NoncePool::Impl {
+ public:
+  const size_t m_capacity;
+
+  mutable mutex m_mutex;
+  condition_variable m_wake;
+  mutable condition_variable m_filled;
+  vector<PooledNonce> m_nonces;
+  bool m_stop = false;
+  unique_ptr<thread> m_thread;
+
+  // Process that filled the pool. A child created by fork() gets a copy of
+  // the nonces but not the fill thread, and must not hand out the nonces
+  // its parent may also use.
+  const pid_t m_pid;
+  once_flag m_discarded;
+
+  explicit Impl(size_t capacity) : m_capacity(capacity), m_pid(getpid()) {
+    // Reserved once, so that no copy of a nonce is left behind by a
+    // reallocation
+    m_nonces.reserve(m_capacity);
+    m_thread = make_unique<thread>(&Impl::FillLoop, this);
+  }
+
+  ~Impl() {
+    if (Forked()) {
+      // The fill thread does not exist in this process, so it can be
+      // neither stopped nor joined
+      DiscardAfterFork();
+      m_thread.release();
+      return;
+    }
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    m_thread->join();
+    m_nonces.clear();
+  }
+
+  Impl(const Impl&) = delete;
+  Impl& operator=(const Impl&) = delete;
+
+  /// Returns true in a child created by fork() after the pool was.
+  bool Forked() const { return getpid() != m_pid; }
+
+  /// Clears the nonces copied from the parent (each PooledNonce clears its
+  /// scalar on destruction). The mutex is not taken, as
+  /// the parent thread holding it at the time of the fork may never release
+  /// it here; only this function touches the nonces in a child.
+  void DiscardAfterFork() {
+    call_once(m_discarded, [this]() { m_nonces.clear(); });
+  }
+
+  /// Keeps the pool full until the pool is destroyed.
+  void FillLoop() {
+    unique_lock<mutex> lock(m_mutex);
+    while (true) {
+      m_wake.wait(lock, [this]() {
+        return m_stop || (m_nonces.size() < m_capacity);
+      });
+      if (m_stop) {
+        return;
+      }
+
+      lock.unlock();
+      PooledNonce nonce;
+      const bool generated = GenerateNonce(nonce);
+      lock.lock();
+
+      if (!generated) {
+        // Random generation failed
+        m_wake.wait_for(lock, NONCE_POOL_RETRY_DELAY);
+        continue;
+      }
+
+      if (m_nonces.size() < m_capacity) {
+        m_nonces.push_back(nonce);
+        if (m_nonces.size() == m_capacity) {
+          m_filled.notify_all();
+        }
+      }
+    }
+  }
+};
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+NoncePool::NoncePool(size_t capacity) : m_impl(make_unique<Impl>(capacity)) {}
+
+NoncePool::~NoncePool() {}
+
+size_t NoncePool::Capacity() const { return m_impl->m_capacity; }
+
+size_t NoncePool::Size() const {
+  if (m_impl->Forked()) {
+    // Nothing is kept ready in a child process
+    return 0;
+  }
+
+  lock_guard<mutex> lock(m_impl->m_mutex);
+  return m_impl->m_nonces.size();
+}
+
+bool NoncePool::WaitUntilFull(chrono::milliseconds timeout) const {
+  const Impl& impl = *m_impl;
+  if (impl.Forked()) {
+    // Nothing is kept ready in a child process
+    return false;
+  }
+
+  unique_lock<mutex> lock(impl.m_mutex);
+  return impl.m_filled.wait_for(lock, timeout, [&impl]() {
+    return impl.m_nonces.size() == impl.m_capacity;
+  });
+}
+
+// ============================================================================
+// Nonces
+// ============================================================================
+
+bool NoncePool::take(PooledNonce& nonce) {
+  Impl& impl = *m_impl;
+  if (impl.Forked()) {
+    // Never reuse a nonce the parent may also hand out
+    impl.DiscardAfterFork();
+    return GenerateNonce(nonce);
+  }
+
+  bool taken = false;
+  {
+    lock_guard<mutex> lock(impl.m_mutex);
+    if (!impl.m_nonces.empty()) {
+      nonce = impl.m_nonces.back();
+      impl.m_nonces.pop_back();
+      taken = true;
+    }
+  }
+  impl.m_wake.notify_one();
+
+  // Generated here if the pool ran empty
+  return taken || GenerateNonce(nonce);
+}
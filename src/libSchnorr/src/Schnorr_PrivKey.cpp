@@ -105,23 +105,37 @@ bool PrivKey::Serialize(bytes& dst, unsigned int offset) const {
   return true;
 }
 
+bool PrivKey::Serialize(Serialized& dst) const {
+  return BIGNUMSerialize::SetNumber(dst.data(), dst.size(), m_d.get());
+}
+
 bool PrivKey::Deserialize(const bytes& src, unsigned int offset) {
-  shared_ptr<BIGNUM> result =
-      BIGNUMSerialize::GetNumber(src, offset, PRIV_KEY_SIZE);
+  if (offset > src.size()) {
+    // Offset beyond source size
+    return false;
+  }
 
-  if (result == nullptr) {
-    // BIGNUMSerialize::GetNumber failed
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
+
+bool PrivKey::Deserialize(const uint8_t* src, size_t size) {
+  if (size < PRIV_KEY_SIZE) {
+    // Source too short
     return false;
   }
 
-  if (BN_copy(m_d.get(), result.get()) == NULL) {
-    // PrivKey copy failed
+  if (!BIGNUMSerialize::GetNumber(m_d.get(), src, PRIV_KEY_SIZE)) {
+    // BIGNUMSerialize::GetNumber failed
     return false;
   }
 
   return true;
 }
 
+bool PrivKey::Deserialize(const Serialized& src) {
+  return Deserialize(src.data(), src.size());
+}
+
 // ============================================================================
 // Assignment and Comparison
 // ============================================================================
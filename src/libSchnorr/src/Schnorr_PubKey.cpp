@@ -19,8 +19,13 @@
 #include <openssl/ec.h>
 #include <openssl/err.h>
 
+#include <cstring>
+
 #include "Schnorr.h"
 #include "SchnorrInternal.h"
+#ifdef SCHNORR_NATIVE_SECP256K1
+#include "Secp256k1Group.h"
+#endif
 
 using namespace std;
 
@@ -50,11 +55,19 @@ PubKey::PubKey(const PrivKey& privkey)
     // Input private key is invalid
     return;
   }
+  ScratchFrame frame{SecretScratch()};
+#ifdef SCHNORR_NATIVE_SECP256K1
+  if (!secp256k1::MulGenerator(m_P.get(), privkey.m_d.get(), frame.Ctx())) {
+    // Public key generation failed
+    return;
+  }
+#else
   if (EC_POINT_mul(Schnorr::GetCurveGroup(), m_P.get(), privkey.m_d.get(), NULL,
-                   NULL, NULL) == 0) {
+                   NULL, frame.Ctx()) == 0) {
     // Public key generation failed
     return;
   }
+#endif
 }
 
 PubKey::PubKey(const bytes& src, unsigned int offset)
@@ -111,23 +124,66 @@ bool PubKey::Serialize(bytes& dst, unsigned int offset) const {
   return true;
 }
 
+bool PubKey::Serialize(Serialized& dst) const {
+  return ECPOINTSerialize::SetNumber(dst.data(), dst.size(), m_P.get());
+}
+
 bool PubKey::Deserialize(const bytes& src, unsigned int offset) {
-  shared_ptr<EC_POINT> result =
-      ECPOINTSerialize::GetNumber(src, offset, PUB_KEY_SIZE);
+  if (offset > src.size()) {
+    // Offset beyond source size
+    return false;
+  }
 
-  if (result == nullptr) {
-    // ECPOINTSerialize::GetNumber failed
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
+
+bool PubKey::Deserialize(const uint8_t* src, size_t size) {
+  if (size < PUB_KEY_SIZE) {
+    // Source too short
     return false;
   }
 
-  if (!EC_POINT_copy(m_P.get(), result.get())) {
-    // PubKey copy failed
+  if (!ECPOINTSerialize::GetNumber(m_P.get(), src, PUB_KEY_SIZE)) {
+    // ECPOINTSerialize::GetNumber failed
     return false;
   }
 
   return true;
 }
 
+bool PubKey::Deserialize(const Serialized& src) {
+  return Deserialize(src.data(), src.size());
+}
+
+bool PubKey::SerializeAll(const vector<PubKey>& keys, bytes& dst) {
+  dst.resize(keys.size() * PUB_KEY_SIZE);
+  uint8_t* records = dst.data();
+  auto encode = [&keys, records](size_t i) {
+    return ECPOINTSerialize::SetNumber(records + i * PUB_KEY_SIZE,
+                                       PUB_KEY_SIZE, keys[i].m_P.get());
+  };
+  return ParallelForChunks(keys.size(), BULK_CHUNK_SIZE, encode);
+}
+
+bool PubKey::DeserializeAll(const uint8_t* src, size_t size,
+                            vector<PubKey>& keys) {
+  if (size % PUB_KEY_SIZE != 0) {
+    // Source not made of whole records
+    return false;
+  }
+
+  // The keys are allocated here, so that the batch threads only decode
+  keys.resize(size / PUB_KEY_SIZE);
+  auto decode = [src, &keys](size_t i) {
+    return keys[i].Deserialize(src + i * PUB_KEY_SIZE, PUB_KEY_SIZE);
+  };
+  return ParallelForChunks(keys.size(), BULK_CHUNK_SIZE, decode);
+}
+
+bool PubKey::DeserializeAll(const bytes& src, vector<PubKey>& keys) {
+  return DeserializeAll(src.data(), src.size(), keys);
+}
+
 // ============================================================================
 // Assignment and Comparison
 // ============================================================================
@@ -139,43 +195,35 @@ PubKey& PubKey::operator=(const PubKey& src) {
   return *this;
 }
 
-bool PubKey::comparePreChecks(const PubKey& r, shared_ptr<BIGNUM>& lhs_bnvalue,
-                              shared_ptr<BIGNUM>& rhs_bnvalue) const {
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    // Memory allocation failure
-    throw std::bad_alloc();
-  }
-
-  lhs_bnvalue.reset(
-      EC_POINT_point2bn(Schnorr::GetCurveGroup(), m_P.get(),
-                        POINT_CONVERSION_COMPRESSED, NULL, ctx.get()),
-      BN_clear_free);
-  rhs_bnvalue.reset(
-      EC_POINT_point2bn(Schnorr::GetCurveGroup(), r.m_P.get(),
-                        POINT_CONVERSION_COMPRESSED, NULL, ctx.get()),
-      BN_clear_free);
-
-  if ((lhs_bnvalue == nullptr) || (rhs_bnvalue == nullptr)) {
-    // Memory allocation failure
-    throw std::bad_alloc();
-  }
-
-  return true;
+bool PubKey::comparePreChecks(const PubKey& r, CompressedPoint& lhs_value,
+                              CompressedPoint& rhs_value) const {
+  // The point at infinity encodes to a single zero byte, and every other point
+  // to a 33-byte string starting with 0x02 or 0x03. With zero padding, memcmp
+  // on the buffers thus orders keys the same way as BN_cmp on their encodings.
+  ScratchFrame frame;
+  lhs_value.fill(0x00);
+  rhs_value.fill(0x00);
+
+  return (EC_POINT_point2oct(Schnorr::GetCurveGroup(), m_P.get(),
+                             POINT_CONVERSION_COMPRESSED, lhs_value.data(),
+                             lhs_value.size(), frame.Ctx()) != 0) &&
+         (EC_POINT_point2oct(Schnorr::GetCurveGroup(), r.m_P.get(),
+                             POINT_CONVERSION_COMPRESSED, rhs_value.data(),
+                             rhs_value.size(), frame.Ctx()) != 0);
 }
 
 bool PubKey::operator<(const PubKey& r) const {
-  shared_ptr<BIGNUM> lhs_bnvalue, rhs_bnvalue;
-  return comparePreChecks(r, lhs_bnvalue, rhs_bnvalue) &&
-         BN_cmp(lhs_bnvalue.get(), rhs_bnvalue.get()) == -1;
+  CompressedPoint lhs_value, rhs_value;
+  return comparePreChecks(r, lhs_value, rhs_value) &&
+         memcmp(lhs_value.data(), rhs_value.data(), lhs_value.size()) < 0;
 }
 
 bool PubKey::operator>(const PubKey& r) const { return r < *this; }
 
 bool PubKey::operator==(const PubKey& r) const {
-  shared_ptr<BIGNUM> lhs_bnvalue, rhs_bnvalue;
-  return comparePreChecks(r, lhs_bnvalue, rhs_bnvalue) &&
-         BN_cmp(lhs_bnvalue.get(), rhs_bnvalue.get()) == 0;
+  CompressedPoint lhs_value, rhs_value;
+  return comparePreChecks(r, lhs_value, rhs_value) &&
+         memcmp(lhs_value.data(), rhs_value.data(), lhs_value.size()) == 0;
 }
 
 bool PubKey::operator!=(const PubKey& r) const { return !(*this == r); }
@@ -83,30 +83,42 @@ bool Signature::Serialize(bytes& dst, unsigned int offset) const {
   return true;
 }
 
-bool Signature::Deserialize(const bytes& src, unsigned int offset) {
-  shared_ptr<BIGNUM> result_r =
-      BIGNUMSerialize::GetNumber(src, offset, SIGNATURE_CHALLENGE_SIZE);
-  shared_ptr<BIGNUM> result_s = BIGNUMSerialize::GetNumber(
-      src, offset + SIGNATURE_CHALLENGE_SIZE, SIGNATURE_RESPONSE_SIZE);
+bool Signature::Serialize(Serialized& dst) const {
+  return BIGNUMSerialize::SetNumber(dst.data(), SIGNATURE_CHALLENGE_SIZE,
+                                    m_r.get()) &&
+         BIGNUMSerialize::SetNumber(dst.data() + SIGNATURE_CHALLENGE_SIZE,
+                                    SIGNATURE_RESPONSE_SIZE, m_s.get());
+}
 
-  if ((result_r == nullptr) || (result_s == nullptr)) {
-    // BIGNUMSerialize::GetNumber failed
+bool Signature::Deserialize(const bytes& src, unsigned int offset) {
+  if (offset > src.size()) {
+    // Offset beyond source size
     return false;
   }
 
-  if (BN_copy(m_r.get(), result_r.get()) == NULL) {
-    // Signature challenge copy failed
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
+
+bool Signature::Deserialize(const uint8_t* src, size_t size) {
+  if (size < SIGNATURE_CHALLENGE_SIZE + SIGNATURE_RESPONSE_SIZE) {
+    // Source too short
     return false;
   }
 
-  if (BN_copy(m_s.get(), result_s.get()) == NULL) {
-    // Signature response copy failed
+  if (!BIGNUMSerialize::GetNumber(m_r.get(), src, SIGNATURE_CHALLENGE_SIZE) ||
+      !BIGNUMSerialize::GetNumber(m_s.get(), src + SIGNATURE_CHALLENGE_SIZE,
+                                  SIGNATURE_RESPONSE_SIZE)) {
+    // BIGNUMSerialize::GetNumber failed
     return false;
   }
 
   return true;
 }
 
+bool Signature::Deserialize(const Serialized& src) {
+  return Deserialize(src.data(), src.size());
+}
+
 // ============================================================================
 // Assignment and Comparison
 // ============================================================================
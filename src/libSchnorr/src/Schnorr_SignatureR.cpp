@@ -0,0 +1,424 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+
+#include "Schnorr.h"
+#include "SchnorrInternal.h"
+#ifdef SCHNORR_NATIVE_SECP256K1
+#include "Secp256k1Group.h"
+#endif
+
+using namespace std;
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+namespace {
+
+/// Converts the commitment and response of an R-form signature, checking
+/// that R is not the point at infinity and s is in [1, ..., order-1].
+bool LoadSignatureR(secp256k1::GeAffine& R, secp256k1::Scalar& s,
+                    const SignatureR& sig, BN_CTX* ctx) {
+  if (!secp256k1::LoadPoint(R, sig.m_R.get(), ctx) || R.infinity) {
+    // Commitment not a valid point
+    return false;
+  }
+  return secp256k1::LoadSignatureScalar(s, sig.m_s.get());
+}
+
+/// Converts a public key, checking that it is not the point at infinity.
+bool LoadPubKey(secp256k1::GeAffine& P, const PubKey& pubkey, BN_CTX* ctx) {
+  return secp256k1::LoadPoint(P, pubkey.m_P.get(), ctx) && !P.infinity;
+}
+
+/// Computes the challenge e = H(R, kpub, m) of Sign and Verify from the
+/// compressed encodings of R and kpub.
+void ComputeChallenge(secp256k1::Scalar& e, const secp256k1::GeAffine& R,
+                      const secp256k1::GeAffine& P, const uint8_t* message,
+                      size_t size) {
+  bytes encoded(2 * PUB_KEY_SIZE);
+  R.GetCompressed(encoded.data());
+  P.GetCompressed(encoded.data() + PUB_KEY_SIZE);
+
+  SHA2<HashType::HASH_VARIANT_256> sha2;
+  sha2.Update(encoded);
+  sha2.Update(message, size);
+  const bytes digest = sha2.Finalize();
+  e.SetB32(digest.data());
+}
+
+}  // namespace
+#endif
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+bool SignatureR::constructPreChecks() {
+  return ((m_R != nullptr) && (m_s != nullptr));
+}
+
+SignatureR::SignatureR()
+    : m_R(EC_POINT_new(Schnorr::GetCurveGroup()), EC_POINT_clear_free),
+      m_s(BN_new(), BN_clear_free) {
+  if (!constructPreChecks()) {
+    // constructPreChecks failed
+    throw std::bad_alloc();
+  }
+}
+
+SignatureR::SignatureR(const bytes& src, unsigned int offset)
+    : m_R(EC_POINT_new(Schnorr::GetCurveGroup()), EC_POINT_clear_free),
+      m_s(BN_new(), BN_clear_free) {
+  if (!constructPreChecks()) {
+    // constructPreChecks failed
+    throw std::bad_alloc();
+  }
+
+  if (!Deserialize(src, offset)) {
+    // We failed to init SignatureR from stream
+  }
+}
+
+SignatureR::SignatureR(const SignatureR& src)
+    : m_R(EC_POINT_new(Schnorr::GetCurveGroup()), EC_POINT_clear_free),
+      m_s(BN_new(), BN_clear_free) {
+  if (!constructPreChecks()) {
+    // constructPreChecks failed
+    throw std::bad_alloc();
+  }
+
+  if (!EC_POINT_copy(m_R.get(), src.m_R.get())) {
+    // Signature commitment copy failed
+    return;
+  }
+
+  if (BN_copy(m_s.get(), src.m_s.get()) == NULL) {
+    // Signature response copy failed
+  }
+}
+
+SignatureR::~SignatureR() {}
+
+// ============================================================================
+// Serialization
+// ============================================================================
+
+bool SignatureR::Serialize(bytes& dst, unsigned int offset) const {
+  ECPOINTSerialize::SetNumber(dst, offset, SIGNATURE_COMMIT_SIZE, m_R);
+  BIGNUMSerialize::SetNumber(dst, offset + SIGNATURE_COMMIT_SIZE,
+                             SIGNATURE_RESPONSE_SIZE, m_s);
+  return true;
+}
+
+bool SignatureR::Serialize(Serialized& dst) const {
+  return ECPOINTSerialize::SetNumber(dst.data(), SIGNATURE_COMMIT_SIZE,
+                                     m_R.get()) &&
+         BIGNUMSerialize::SetNumber(dst.data() + SIGNATURE_COMMIT_SIZE,
+                                    SIGNATURE_RESPONSE_SIZE, m_s.get());
+}
+
+bool SignatureR::Deserialize(const bytes& src, unsigned int offset) {
+  if (offset > src.size()) {
+    // Offset beyond source size
+    return false;
+  }
+
+  return Deserialize(src.data() + offset, src.size() - offset);
+}
+
+bool SignatureR::Deserialize(const uint8_t* src, size_t size) {
+  if (size < SIGNATURE_COMMIT_SIZE + SIGNATURE_RESPONSE_SIZE) {
+    // Source too short
+    return false;
+  }
+
+  if (!ECPOINTSerialize::GetNumber(m_R.get(), src, SIGNATURE_COMMIT_SIZE) ||
+      !BIGNUMSerialize::GetNumber(m_s.get(), src + SIGNATURE_COMMIT_SIZE,
+                                  SIGNATURE_RESPONSE_SIZE)) {
+    // ECPOINTSerialize::GetNumber or BIGNUMSerialize::GetNumber failed
+    return false;
+  }
+
+  return true;
+}
+
+bool SignatureR::Deserialize(const Serialized& src) {
+  return Deserialize(src.data(), src.size());
+}
+
+// ============================================================================
+// Assignment and Comparison
+// ============================================================================
+
+SignatureR& SignatureR::operator=(const SignatureR& src) {
+  if (!EC_POINT_copy(m_R.get(), src.m_R.get())) {
+    // Signature commitment copy failed
+  }
+
+  if (BN_copy(m_s.get(), src.m_s.get()) == NULL) {
+    // Signature response copy failed
+  }
+
+  return *this;
+}
+
+bool SignatureR::operator==(const SignatureR& r) const {
+  ScratchFrame frame;
+  return (EC_POINT_cmp(Schnorr::GetCurveGroup(), m_R.get(), r.m_R.get(),
+                       frame.Ctx()) == 0) &&
+         (BN_cmp(m_s.get(), r.m_s.get()) == 0);
+}
+
+SignatureR::operator std::string() const {
+  std::string output;
+  if (!SerializableCryptoToHexStr(*this, output)) {
+    return "";
+  }
+  return "0x" + output;
+}
+
+std::ostream& operator<<(std::ostream& os, const SignatureR& s) {
+  std::string output;
+  if (!SerializableCryptoToHexStr(s, output)) {
+    os << "";
+  } else {
+    os << "0x" << output;
+  }
+  return os;
+}
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+// ============================================================================
+// Signing and Verification
+// ============================================================================
+
+bool Schnorr::SignR(const bytes& message, const PrivKey& privkey,
+                    const PubKey& pubkey, SignatureR& result) {
+  return SignR(message, 0, message.size(), privkey, pubkey, result);
+}
+
+bool Schnorr::SignR(const bytes& message, unsigned int offset,
+                    unsigned int size, const PrivKey& privkey,
+                    const PubKey& pubkey, SignatureR& result) {
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
+    return false;
+  }
+
+  return SignR(message.data() + offset, size, privkey, pubkey, result);
+}
+
+bool Schnorr::SignR(const uint8_t* message, size_t size,
+                    const PrivKey& privkey, const PubKey& pubkey,
+                    SignatureR& result) {
+  // Initial checks
+
+  if (size == 0) {
+    // Empty message
+    return false;
+  }
+
+  // Same procedure as Sign, keeping the commitment Q = kG in place of the
+  // challenge r = H(Q, kpub, m)
+
+  ScratchFrame frame{SecretScratch()};
+  BIGNUM* k = frame.GetBN();
+  BN_CTX* ctx = frame.Ctx();
+
+  secp256k1::Scalar d, nonce, r, s;
+  secp256k1::GeAffine P, Q;
+  if ((k == nullptr) || !secp256k1::LoadSignatureScalar(d, privkey.m_d.get())) {
+    // Input private key is invalid
+    return false;
+  }
+
+  if (!LoadPubKey(P, pubkey, ctx)) {
+    // Input public key is invalid
+    d.Clear();
+    return false;
+  }
+
+  do {
+    // 1. Generate a random k from [1,..., order-1]
+    do {
+      if ((BN_generate_dsa_nonce(k, GetCurveOrder(), privkey.m_d.get(),
+                                 message, size, ctx) == 0) ||
+          !secp256k1::LoadScalar(nonce, k)) {
+        // Random generation failed
+        d.Clear();
+        return false;
+      }
+    } while (nonce.IsZero());
+
+    // 2. Compute the commitment Q = kG from the precomputed table of G
+    secp256k1::GeJacobian commit;
+    secp256k1::EcMultGen(commit, nonce);
+    Q.SetJacobianVar(commit);
+
+    // 3. Compute the challenge r = H(Q, kpub, m)
+    ComputeChallenge(r, Q, P, message, size);
+
+    // 4. Compute s = k - r*kpriv
+    s.Mul(r, d);
+    s.Sub(nonce, s);
+    nonce.Clear();
+  } while (r.IsZero() || s.IsZero());
+  d.Clear();
+
+  if (!secp256k1::StorePoint(result.m_R.get(), Q, ctx) ||
+      !secp256k1::StoreScalar(result.m_s.get(), s)) {
+    // Signature conversion failed
+    return false;
+  }
+
+  return true;
+}
+
+bool Schnorr::VerifyR(const bytes& message, const SignatureR& toverify,
+                      const PubKey& pubkey) {
+  return VerifyR(message, 0, message.size(), toverify, pubkey);
+}
+
+bool Schnorr::VerifyR(const bytes& message, unsigned int offset,
+                      unsigned int size, const SignatureR& toverify,
+                      const PubKey& pubkey) {
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
+    return false;
+  }
+
+  return VerifyR(message.data() + offset, size, toverify, pubkey);
+}
+
+bool Schnorr::VerifyR(const uint8_t* message, size_t size,
+                      const SignatureR& toverify, const PubKey& pubkey) {
+  // Initial checks
+
+  if (size == 0) {
+    // Empty message
+    return false;
+  }
+
+  try {
+    // 1. Check that Q is a point other than O and s is in [1, ..., order-1]
+    ScratchFrame frame;
+    secp256k1::GeAffine Q, P;
+    secp256k1::Scalar r, s;
+    if (!LoadSignatureR(Q, s, toverify, frame.Ctx())) {
+      // Invalid signature
+      return false;
+    }
+
+    if (!LoadPubKey(P, pubkey, frame.Ctx())) {
+      // Invalid public key
+      return false;
+    }
+
+    // 2. r = H(Q, kpub, m)
+    ComputeChallenge(r, Q, P, message, size);
+
+    // 3. return sG + r*kpub == Q
+    secp256k1::GeJacobian q;
+    secp256k1::EcMultDoubleVar(q, P, r, s);
+    return q.EqualAffineVar(Q);
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
+
+bool Schnorr::BatchVerifyR(const vector<bytes>& messages,
+                           const vector<SignatureR>& signatures,
+                           const vector<PubKey>& pubkeys) {
+  // Initial checks
+
+  const size_t count = signatures.size();
+  if ((messages.size() != count) || (pubkeys.size() != count)) {
+    // Mismatched input sizes
+    return false;
+  }
+
+  vector<MessageSegment> segments;
+  segments.reserve(count);
+  for (const bytes& message : messages) {
+    segments.push_back({message.data(), message.size()});
+  }
+  return BatchVerifyR(segments.data(), signatures.data(), pubkeys.data(),
+                      count);
+}
+
+bool Schnorr::BatchVerifyR(const MessageSegment* messages,
+                           const SignatureR* signatures, const PubKey* pubkeys,
+                           size_t count) {
+  // Initial checks
+
+  if (count == 0) {
+    // No signatures
+    return false;
+  }
+
+  try {
+    // With random weights z_i, every signature is valid (except with
+    // probability 2^-128) if
+    //   sum(z_i*s_i)*G + sum(z_i*r_i*kpub_i) - sum(z_i*Q_i) = O
+    // so the points are Q_i and kpub_i, with scalars -z_i and z_i*r_i
+    vector<secp256k1::Scalar> weights(count);
+    if (!secp256k1::RandomBatchWeights(weights.data(), count)) {
+      // Random generation failed
+      return false;
+    }
+
+    ScratchFrame frame;
+    vector<secp256k1::GeAffine> points(2 * count);
+    vector<secp256k1::Scalar> scalars(2 * count);
+    secp256k1::ScalarSum weighted_sum;
+    for (size_t i = 0; i < count; i++) {
+      if (messages[i].size == 0) {
+        // Empty message
+        return false;
+      }
+
+      secp256k1::GeAffine& Q = points[2 * i];
+      secp256k1::GeAffine& P = points[2 * i + 1];
+      secp256k1::Scalar r, s;
+      if (!LoadSignatureR(Q, s, signatures[i], frame.Ctx())) {
+        // Invalid signature
+        return false;
+      }
+
+      if (!LoadPubKey(P, pubkeys[i], frame.Ctx())) {
+        // Invalid public key
+        return false;
+      }
+
+      ComputeChallenge(r, Q, P, messages[i].data, messages[i].size);
+
+      scalars[2 * i].Negate(weights[i]);
+      scalars[2 * i + 1].Mul(weights[i], r);
+      s.Mul(weights[i], s);
+      weighted_sum.Add(s);
+    }
+
+    secp256k1::GeJacobian result;
+    secp256k1::EcMultMultiVar(result, points.data(), scalars.data(),
+                              points.size(), weighted_sum.Get());
+    return result.infinity;
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
+#endif  // SCHNORR_NATIVE_SECP256K1
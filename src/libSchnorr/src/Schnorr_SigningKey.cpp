@@ -0,0 +1,387 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/bn.h>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+#include "Schnorr.h"
+#include "SchnorrInternal.h"
+#include "Secp256k1Group.h"
+
+using namespace std;
+
+namespace {
+
+/// Returns true if all count message segments are empty.
+bool MessageEmpty(const MessageSegment* segments, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (segments[i].size != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+class SigningKey::Impl {
+ public:
+  secp256k1::Scalar m_d{};
+  array<uint8_t, PRIV_KEY_SIZE> m_d_bytes{};
+  PubKey m_pubkey;
+  array<uint8_t, PUB_KEY_SIZE> m_compressed{};
+  bool m_valid = false;
+
+  explicit Impl(const PrivKey& privkey) {
+    if (BN_is_zero(privkey.m_d.get()) ||
+        (BN_cmp(privkey.m_d.get(), Schnorr::GetCurveOrder()) != -1)) {
+      // Input private key is invalid
+      return;
+    }
+
+    if (!secp256k1::LoadScalar(m_d, privkey.m_d.get())) {
+      // Private key conversion failed
+      return;
+    }
+    m_d.GetB32(m_d_bytes.data());
+
+    secp256k1::GeJacobian pj;
+    secp256k1::EcMultGen(pj, m_d);
+    secp256k1::GeAffine p;
+    p.SetJacobianVar(pj);
+    p.GetCompressed(m_compressed.data());
+
+    ScratchFrame frame;
+    if (!secp256k1::StorePoint(m_pubkey.m_P.get(), p, frame.Ctx())) {
+      // Public key conversion failed
+      return;
+    }
+    m_valid = true;
+  }
+
+  Impl(const Impl&) = default;
+
+  ~Impl() {
+    m_d.Clear();
+    OPENSSL_cleanse(m_d_bytes.data(), m_d_bytes.size());
+  }
+
+  Impl& operator=(const Impl&) = delete;
+
+  /// Derives a nonce in the manner of BN_generate_dsa_nonce: the SHA-512
+  /// hash of the private key, the message segments and 32 random bytes,
+  /// reduced modulo the order.
+  bool GenerateNonce(secp256k1::Scalar& k, const MessageSegment* segments,
+                     size_t count) const {
+    array<uint8_t, 32> random_bytes;
+    if (RAND_bytes(random_bytes.data(), random_bytes.size()) != 1) {
+      // Random generation failed
+      return false;
+    }
+
+    array<uint8_t, SHA512_DIGEST_LENGTH> digest;
+    SHA512_CTX nonce_hash;
+    SHA512_Init(&nonce_hash);
+    SHA512_Update(&nonce_hash, m_d_bytes.data(), m_d_bytes.size());
+    for (size_t i = 0; i < count; i++) {
+      SHA512_Update(&nonce_hash, segments[i].data, segments[i].size);
+    }
+    SHA512_Update(&nonce_hash, random_bytes.data(), random_bytes.size());
+    SHA512_Final(digest.data(), &nonce_hash);
+
+    uint64_t wide[8];
+    for (unsigned int i = 0; i < 8; i++) {
+      wide[i] = 0;
+      for (unsigned int j = 0; j < 8; j++) {
+        wide[i] = (wide[i] << 8) | digest[(7 - i) * 8 + j];
+      }
+    }
+    k.SetWide(wide);
+
+    OPENSSL_cleanse(wide, sizeof(wide));
+    OPENSSL_cleanse(&nonce_hash, sizeof(nonce_hash));
+    OPENSSL_cleanse(digest.data(), digest.size());
+    OPENSSL_cleanse(random_bytes.data(), random_bytes.size());
+    return true;
+  }
+
+  /// Generates a nonce k from [1, ..., order-1] for the message segments,
+  /// with its commitment Q = kG.
+  bool NextNonce(secp256k1::Scalar& k, secp256k1::GeAffine& commit,
+                 const MessageSegment* segments, size_t count) const {
+    // 1. Generate a random k from [1,..., order-1]
+    do {
+      if (!GenerateNonce(k, segments, count)) {
+        return false;
+      }
+    } while (k.IsZero());
+
+    // 2. Compute the commitment Q = kG from the precomputed table of G
+    secp256k1::GeJacobian commit_jacobian;
+    secp256k1::EcMultGen(commit_jacobian, k);
+    commit.SetJacobianVar(commit_jacobian);
+    return true;
+  }
+
+  /// Computes the challenge r, the response s and the commitment Q of a
+  /// signature on the concatenated message segments. Same procedure as Sign
+  /// with a PrivKey, on native scalars and with the cached public key
+  /// encoding.
+  bool Sign(const MessageSegment* segments, size_t count,
+            secp256k1::Scalar& r, secp256k1::Scalar& s,
+            secp256k1::GeAffine& commit) const {
+    return Sign(segments, count, r, s, commit,
+                [this, segments, count](secp256k1::Scalar& k,
+                                        secp256k1::GeAffine& Q) {
+                  return NextNonce(k, Q, segments, count);
+                });
+  }
+
+  /// Same as above, with steps 1 and 2 done by nextNonce(k, Q), which sets
+  /// a nonce k from [1, ..., order-1] and its commitment Q = kG.
+  template <class NonceSource>
+  bool Sign(const MessageSegment* segments, size_t count,
+            secp256k1::Scalar& r, secp256k1::Scalar& s,
+            secp256k1::GeAffine& commit, NonceSource nextNonce) const {
+    // The commitment followed by the public key, as hashed into the challenge
+    array<uint8_t, 2 * PUB_KEY_SIZE> encoded;
+    copy(m_compressed.begin(), m_compressed.end(),
+         encoded.begin() + PUB_KEY_SIZE);
+
+    secp256k1::Scalar k;
+    do {
+      if (!nextNonce(k, commit)) {
+        return false;
+      }
+      commit.GetCompressed(encoded.data());
+
+      // 3. Compute the challenge r = H(Q, kpub, m), with a raw SHA256_CTX
+      // as SHA2 allocates its output
+      array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+      SHA256_CTX challenge_hash;
+      SHA256_Init(&challenge_hash);
+      SHA256_Update(&challenge_hash, encoded.data(), encoded.size());
+      for (size_t i = 0; i < count; i++) {
+        SHA256_Update(&challenge_hash, segments[i].data, segments[i].size);
+      }
+      SHA256_Final(digest.data(), &challenge_hash);
+      r.SetB32(digest.data());
+
+      // 4. Compute s = k - r*kpriv
+      s.Mul(r, m_d);
+      s.Sub(k, s);
+      k.Clear();
+    } while (r.IsZero() || s.IsZero());
+
+    return true;
+  }
+};
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+SigningKey::SigningKey(const PrivKey& privkey)
+    : m_impl(make_unique<Impl>(privkey)) {}
+
+SigningKey::SigningKey(const SigningKey& src)
+    : m_impl(make_unique<Impl>(*src.m_impl)) {}
+
+SigningKey::~SigningKey() {}
+
+SigningKey& SigningKey::operator=(const SigningKey& src) {
+  if (this != &src) {
+    m_impl = make_unique<Impl>(*src.m_impl);
+  }
+  return *this;
+}
+
+const PubKey& SigningKey::GetPubKey() const { return m_impl->m_pubkey; }
+
+const array<uint8_t, 33>& SigningKey::GetCompressed() const {
+  return m_impl->m_compressed;
+}
+
+// ============================================================================
+// Signing
+// ============================================================================
+
+bool Schnorr::Sign(const bytes& message, const SigningKey& key,
+                   Signature& result) {
+  return Sign(message, 0, message.size(), key, result);
+}
+
+bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
+                   const SigningKey& key, Signature& result) {
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
+    return false;
+  }
+
+  return Sign(message.data() + offset, size, key, result);
+}
+
+bool Schnorr::Sign(const uint8_t* message, size_t size, const SigningKey& key,
+                   Signature& result) {
+  const MessageSegment segment = {message, size};
+  return Sign(&segment, 1, key, result);
+}
+
+bool Schnorr::Sign(const MessageSegment* segments, size_t count,
+                   const SigningKey& key, Signature& result) {
+  // Initial checks
+
+  if (MessageEmpty(segments, count)) {
+    // Empty message
+    return false;
+  }
+
+  const SigningKey::Impl& impl = *key.m_impl;
+  if (!impl.m_valid) {
+    // Invalid private key
+    return false;
+  }
+
+  secp256k1::Scalar r, s;
+  secp256k1::GeAffine commit;
+  if (!impl.Sign(segments, count, r, s, commit)) {
+    return false;
+  }
+
+  if (!secp256k1::StoreScalar(result.m_r.get(), r) ||
+      !secp256k1::StoreScalar(result.m_s.get(), s)) {
+    // Signature conversion failed
+    return false;
+  }
+
+  return true;
+}
+
+bool Schnorr::Sign(const bytes& message, const SigningKey& key, NoncePool& pool,
+                   Signature& result) {
+  return Sign(message, 0, message.size(), key, pool, result);
+}
+
+bool Schnorr::Sign(const bytes& message, unsigned int offset, unsigned int size,
+                   const SigningKey& key, NoncePool& pool, Signature& result) {
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
+    return false;
+  }
+
+  return Sign(message.data() + offset, size, key, pool, result);
+}
+
+bool Schnorr::Sign(const uint8_t* message, size_t size, const SigningKey& key,
+                   NoncePool& pool, Signature& result) {
+  // Initial checks
+
+  if (size == 0) {
+    // Empty message
+    return false;
+  }
+
+  const SigningKey::Impl& impl = *key.m_impl;
+  if (!impl.m_valid) {
+    // Invalid private key
+    return false;
+  }
+
+  // Steps 1 and 2 are a pool pop
+  const MessageSegment segment = {message, size};
+  secp256k1::Scalar r, s;
+  secp256k1::GeAffine commit;
+  if (!impl.Sign(&segment, 1, r, s, commit,
+                 [&pool](secp256k1::Scalar& k, secp256k1::GeAffine& Q) {
+                   PooledNonce nonce;
+                   if (!pool.take(nonce)) {
+                     // Random generation failed
+                     return false;
+                   }
+                   k.SetB32(nonce.k.data());
+                   Q.x.SetB32(nonce.commit.data());
+                   Q.y.SetB32(nonce.commit.data() +
+                              COMPACT_COMMIT_POINT_SIZE / 2);
+                   Q.infinity = false;
+                   return true;
+                 })) {
+    return false;
+  }
+
+  if (!secp256k1::StoreScalar(result.m_r.get(), r) ||
+      !secp256k1::StoreScalar(result.m_s.get(), s)) {
+    // Signature conversion failed
+    return false;
+  }
+
+  return true;
+}
+
+bool Schnorr::SignR(const bytes& message, const SigningKey& key,
+                    SignatureR& result) {
+  return SignR(message, 0, message.size(), key, result);
+}
+
+bool Schnorr::SignR(const bytes& message, unsigned int offset,
+                    unsigned int size, const SigningKey& key,
+                    SignatureR& result) {
+  if (!MessageRangeValid(message, offset, size)) {
+    // Offset and size beyond message size
+    return false;
+  }
+
+  return SignR(message.data() + offset, size, key, result);
+}
+
+bool Schnorr::SignR(const uint8_t* message, size_t size, const SigningKey& key,
+                    SignatureR& result) {
+  const MessageSegment segment = {message, size};
+  return SignR(&segment, 1, key, result);
+}
+
+bool Schnorr::SignR(const MessageSegment* segments, size_t count,
+                    const SigningKey& key, SignatureR& result) {
+  // Initial checks
+
+  if (MessageEmpty(segments, count)) {
+    // Empty message
+    return false;
+  }
+
+  const SigningKey::Impl& impl = *key.m_impl;
+  if (!impl.m_valid) {
+    // Invalid private key
+    return false;
+  }
+
+  secp256k1::Scalar r, s;
+  secp256k1::GeAffine commit;
+  if (!impl.Sign(segments, count, r, s, commit)) {
+    return false;
+  }
+
+  ScratchFrame frame;
+  if (!secp256k1::StorePoint(result.m_R.get(), commit, frame.Ctx()) ||
+      !secp256k1::StoreScalar(result.m_s.get(), s)) {
+    // Signature conversion failed
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "Schnorr.h"
+#include "SchnorrInternal.h"
+
+using namespace std;
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+VerifyBatchItem::VerifyBatchItem(const bytes& message,
+                                 const Signature& signature,
+                                 const PubKey& pubkey)
+    : VerifyBatchItem(message, 0, message.size(), signature, pubkey) {}
+
+VerifyBatchItem::VerifyBatchItem(const bytes& message, unsigned int offset,
+                                 unsigned int size, const Signature& signature,
+                                 const PubKey& pubkey)
+    : message(nullptr), size(0), signature(&signature), pubkey(&pubkey) {
+  // Left empty on a bad range, so that Verify rejects the item
+  if (MessageRangeValid(message, offset, size)) {
+    this->message = message.data() + offset;
+    this->size = size;
+  }
+}
+
+VerifyBatchItem::VerifyBatchItem(const uint8_t* message, size_t size,
+                                 const Signature& signature,
+                                 const PubKey& pubkey)
+    : message(message), size(size), signature(&signature), pubkey(&pubkey) {}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+void Schnorr::SetBatchThreads(unsigned int threads) {
+  WorkerPool::Get().SetThreads(threads);
+}
+
+unsigned int Schnorr::GetBatchThreads() {
+  return WorkerPool::Get().GetThreads();
+}
+
+// ============================================================================
+// Verification
+// ============================================================================
+
+bool Schnorr::VerifyBatch(const vector<VerifyBatchItem>& items,
+                          vector<bool>& valid) {
+  return VerifyBatch(items.data(), items.size(), valid);
+}
+
+bool Schnorr::VerifyBatch(const VerifyBatchItem* items, size_t count,
+                          vector<bool>& valid) {
+  // The workers write whole bytes, since neighbouring bits of valid would
+  // share a word
+  vector<uint8_t> results(count);
+  WorkerPool::Get().ParallelFor(count, [items, &results](size_t i) {
+    const VerifyBatchItem& item = items[i];
+    results[i] =
+        Verify(item.message, item.size, *item.signature, *item.pubkey);
+  });
+
+  valid.assign(results.begin(), results.end());
+  return (count != 0) &&
+         (find(results.begin(), results.end(), 0) == results.end());
+}
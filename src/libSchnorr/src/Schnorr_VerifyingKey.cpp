@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/sha.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "Schnorr.h"
+#include "SchnorrInternal.h"
+#include "Secp256k1Group.h"
+
+using namespace std;
+
+namespace {
+
+atomic<size_t> table_memory_limit{VerifyingKey::DEFAULT_TABLE_MEMORY_LIMIT};
+atomic<size_t> table_memory_usage{0};
+
+/// Reserves size bytes of table memory. Returns false if that would exceed
+/// the limit.
+bool ReserveTableMemory(size_t size) {
+  size_t usage = table_memory_usage.load();
+  do {
+    if ((usage > table_memory_limit.load()) ||
+        (size > table_memory_limit.load() - usage)) {
+      return false;
+    }
+  } while (!table_memory_usage.compare_exchange_weak(usage, usage + size));
+  return true;
+}
+
+}  // namespace
+
+class VerifyingKey::Impl {
+ public:
+  PubKey m_pubkey;
+  secp256k1::GeAffine m_point;
+  array<uint8_t, PUB_KEY_SIZE> m_compressed{};
+  secp256k1::GeTable m_table;
+  size_t m_table_size = 0;
+
+  Impl(const PubKey& pubkey, unsigned int window) : m_pubkey(pubkey) {
+    ScratchFrame frame;
+    if (!secp256k1::LoadPoint(m_point, m_pubkey.m_P.get(), frame.Ctx())) {
+      // Public key conversion failed
+      m_point.infinity = true;
+    }
+    if (m_point.infinity) {
+      // Invalid public key: every verification fails
+      return;
+    }
+    m_point.GetCompressed(m_compressed.data());
+
+    const size_t size = secp256k1::GeTable::SizeForWindow(window);
+    if (ReserveTableMemory(size)) {
+      m_table_size = size;
+      m_table.Build(m_point, window);
+    }
+  }
+
+  ~Impl() { table_memory_usage -= m_table_size; }
+
+  Impl(const Impl&) = delete;
+  Impl& operator=(const Impl&) = delete;
+
+  /// Recovers the commitment Q of a signature (r, s), failing unless r and
+  /// s are in [1, ..., order-1] and Q is not the neutral point.
+  bool RecoverCommit(const Signature& toverify, secp256k1::Scalar& r,
+                     secp256k1::GeAffine& q) const {
+    // 1. Check if r,s is in [1, ..., order-1]
+    secp256k1::Scalar s;
+    if (!secp256k1::LoadSignatureScalar(r, toverify.m_r.get())) {
+      // Challenge not in range
+      return false;
+    }
+
+    if (!secp256k1::LoadSignatureScalar(s, toverify.m_s.get())) {
+      // Response not in range
+      return false;
+    }
+
+    // 2. Compute Q = sG + r*kpub, with the table of kpub if there is one
+    secp256k1::GeJacobian qj;
+    if (m_table_size != 0) {
+      secp256k1::EcMultDoubleVar(qj, m_table, r, s);
+    } else {
+      secp256k1::EcMultDoubleVar(qj, m_point, r, s);
+    }
+
+    // 3. If Q = O (the neutral point), return 0;
+    q.SetJacobianVar(qj);
+    if (q.infinity) {
+      // Commit at infinity
+      return false;
+    }
+
+    return true;
+  }
+};
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+const unsigned int VerifyingKey::MIN_WINDOW;
+const unsigned int VerifyingKey::MAX_WINDOW;
+const unsigned int VerifyingKey::DEFAULT_WINDOW;
+const size_t VerifyingKey::DEFAULT_TABLE_MEMORY_LIMIT;
+
+VerifyingKey::VerifyingKey(const PubKey& pubkey, unsigned int window)
+    : m_impl(make_shared<const Impl>(
+          pubkey, min(max(window, MIN_WINDOW), MAX_WINDOW))) {}
+
+const PubKey& VerifyingKey::GetPubKey() const { return m_impl->m_pubkey; }
+
+const array<uint8_t, 33>& VerifyingKey::GetCompressed() const {
+  return m_impl->m_compressed;
+}
+
+size_t VerifyingKey::GetTableSize() const { return m_impl->m_table_size; }
+
+void VerifyingKey::SetTableMemoryLimit(size_t limit) {
+  table_memory_limit = limit;
+}
+
+size_t VerifyingKey::GetTableMemoryLimit() { return table_memory_limit; }
+
+size_t VerifyingKey::GetTableMemoryUsage() { return table_memory_usage; }
+
+// ============================================================================
+// Verification
+// ============================================================================
+
+bool VerifyingKey::verify(const bytes& prefix, const uint8_t* message,
+                          size_t size, const Signature& toverify) const {
+  // Initial checks
+
+  if (size == 0) {
+    // Empty message
+    return false;
+  }
+
+  if (m_impl->m_point.infinity) {
+    // Invalid public key
+    return false;
+  }
+
+  try {
+    // 1. to 3. Recover the commitment Q = sG + r*kpub
+    secp256k1::Scalar r;
+    secp256k1::GeAffine q;
+    if (!m_impl->RecoverCommit(toverify, r, q)) {
+      return false;
+    }
+
+    // 4. r' = H(prefix, Q, kpub, m), using the cached encoding of kpub
+    bytes encoded(2 * PUB_KEY_SIZE);
+    q.GetCompressed(encoded.data());
+    copy(m_impl->m_compressed.begin(), m_impl->m_compressed.end(),
+         encoded.begin() + PUB_KEY_SIZE);
+
+    SHA2<HashType::HASH_VARIANT_256> sha2;
+    if (!prefix.empty()) {
+      sha2.Update(prefix);
+    }
+    sha2.Update(encoded);
+    sha2.Update(message, size);
+    const bytes digest = sha2.Finalize();
+
+    // 5. return r' == r
+    secp256k1::Scalar challenge;
+    challenge.SetB32(digest.data());
+    return challenge.Equal(r);
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
+
+// ============================================================================
+// Streaming
+// ============================================================================
+
+class Verifier::Impl {
+ public:
+  const VerifyingKey m_key;
+  secp256k1::Scalar m_r;
+  SHA2<HashType::HASH_VARIANT_256> m_hash;
+  uint64_t m_size = 0;
+  bool m_initialized = false;
+  bool m_finalized = false;
+
+  Impl(const VerifyingKey& key, const Signature& toverify) : m_key(key) {
+    const VerifyingKey::Impl& impl = *m_key.m_impl;
+    if (impl.m_point.infinity) {
+      // Invalid public key
+      return;
+    }
+
+    // Steps 1 to 3 of VerifyingKey::verify, before the message
+    secp256k1::GeAffine q;
+    if (!impl.RecoverCommit(toverify, m_r, q)) {
+      return;
+    }
+
+    array<uint8_t, 2 * PUB_KEY_SIZE> encoded;
+    q.GetCompressed(encoded.data());
+    copy(impl.m_compressed.begin(), impl.m_compressed.end(),
+         encoded.begin() + PUB_KEY_SIZE);
+    m_hash.Update(encoded.data(), encoded.size());
+    m_initialized = true;
+  }
+
+  Impl(const Impl&) = delete;
+  Impl& operator=(const Impl&) = delete;
+};
+
+Verifier::Verifier(const VerifyingKey& key, const Signature& toverify)
+    : m_impl(make_unique<Impl>(key, toverify)) {}
+
+Verifier::~Verifier() {}
+
+bool Verifier::Initialized() const { return m_impl->m_initialized; }
+
+bool Verifier::Update(const uint8_t* data, size_t size) {
+  Impl& impl = *m_impl;
+  if (!impl.m_initialized || impl.m_finalized) {
+    // Verifier not initialized or already finalized
+    return false;
+  }
+
+  impl.m_hash.Update(data, size);
+  impl.m_size += size;
+  return true;
+}
+
+bool Verifier::Update(const bytes& message) {
+  return Update(message.data(), message.size());
+}
+
+bool Verifier::Update(const MessageSegment* segments, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (!Update(segments[i].data, segments[i].size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Verifier::Finalize() {
+  Impl& impl = *m_impl;
+  if (!impl.m_initialized || impl.m_finalized) {
+    // Verifier not initialized or already finalized
+    return false;
+  }
+  impl.m_finalized = true;
+
+  if (impl.m_size == 0) {
+    // Empty message
+    return false;
+  }
+
+  // 4. r' = H(Q, kpub, m)
+  array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+  impl.m_hash.Finalize(digest.data());
+
+  // 5. return r' == r
+  secp256k1::Scalar challenge;
+  challenge.SetB32(digest.data());
+  return challenge.Equal(impl.m_r);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+
+#include "Schnorr.h"
+#include "SchnorrInternal.h"
+
+using namespace std;
+
+// ============================================================================
+// ScratchPool
+// ============================================================================
+
+ScratchPool::ScratchPool() : m_ctx(BN_CTX_new(), BN_CTX_free) {
+  if (m_ctx == nullptr) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+}
+
+ScratchPool& ScratchPool::Get() {
+  // The curve group and order are only ever read after static initialization,
+  // so this is the only OpenSSL state that needs to be kept per thread
+  thread_local ScratchPool pool;
+  return pool;
+}
+
+// ============================================================================
+// ScratchFrame
+// ============================================================================
+
+ScratchFrame::ScratchFrame()
+    : m_pool(ScratchPool::Get()),
+      m_secretCtx(nullptr, BN_CTX_free),
+      m_firstPoint(m_pool.m_pointsInUse) {
+  BN_CTX_start(Ctx());
+}
+
+ScratchFrame::ScratchFrame(SecretScratch)
+    : m_pool(ScratchPool::Get()),
+      m_secretCtx(BN_CTX_secure_new(), BN_CTX_free),
+      m_firstPoint(m_pool.m_pointsInUse) {
+  if (m_secretCtx == nullptr) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+  BN_CTX_start(Ctx());
+}
+
+ScratchFrame::~ScratchFrame() {
+  for (unsigned int i = 0; i < m_numBignums; i++) {
+    BN_clear(m_bignums[i]);
+  }
+  // BN_CTX_free clears every BIGNUM of a secret frame's BN_CTX
+  BN_CTX_end(Ctx());
+  m_pool.m_pointsInUse = m_firstPoint;
+}
+
+BN_CTX* ScratchFrame::Ctx() const {
+  return (m_secretCtx != nullptr) ? m_secretCtx.get() : m_pool.m_ctx.get();
+}
+
+BIGNUM* ScratchFrame::GetBN() {
+  if (m_numBignums == MAX_BIGNUMS) {
+    // Frame exhausted
+    throw std::bad_alloc();
+  }
+
+  BIGNUM* bn = BN_CTX_get(Ctx());
+  if (bn == nullptr) {
+    // Memory allocation failure
+    throw std::bad_alloc();
+  }
+
+  m_bignums[m_numBignums++] = bn;
+  return bn;
+}
+
+EC_POINT* ScratchFrame::GetPoint() {
+  if (m_pool.m_pointsInUse == m_pool.m_points.size()) {
+    m_pool.m_points.emplace_back(EC_POINT_new(Schnorr::GetCurveGroup()),
+                                 EC_POINT_clear_free);
+    if (m_pool.m_points.back() == nullptr) {
+      // Memory allocation failure
+      m_pool.m_points.pop_back();
+      throw std::bad_alloc();
+    }
+  }
+
+  return m_pool.m_points[m_pool.m_pointsInUse++].get();
+}
@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ZILLIQA_SRC_LIBSCHNORR_SRC_SECP256K1FIELD_H_
+#define ZILLIQA_SRC_LIBSCHNORR_SRC_SECP256K1FIELD_H_
+
+#include <cstdint>
+
+namespace secp256k1 {
+
+/// Element of the secp256k1 base field GF(p), p = 2^256 - 2^32 - 977.
+///
+/// The value is held as five unsigned 64-bit limbs in radix 2^52, so that
+/// sums can be accumulated lazily and limb products fit in 128 bits.
+///
+/// Operations track an implicit "magnitude" m, which bounds the limbs:
+/// limbs 0..3 are below m * 2^53 and limb 4 is below m * 2^49. Results of
+/// Mul, Sqr and NormalizeWeak have magnitude 1; Add sums the magnitudes of its
+/// operands; Negate(a, m) has magnitude m + 1. Mul and Sqr accept inputs of
+/// magnitude up to 8. A "normalized" element has magnitude 1 and is fully
+/// reduced below p, which is required by GetB32, IsZero, IsOdd and Equal.
+class FieldElem {
+  static const uint64_t M52 = 0xFFFFFFFFFFFFFULL;
+  static const uint64_t M48 = 0xFFFFFFFFFFFFULL;
+  /// 2^256 mod p.
+  static const uint64_t R256 = 0x1000003D1ULL;
+  /// 2^260 mod p.
+  static const uint64_t R260 = 0x1000003D10ULL;
+
+  using uint128 = unsigned __int128;
+
+  /// Reduces the nine product columns of a multiplication into *this.
+  void Reduce(uint128 c0, uint128 c1, uint128 c2, uint128 c3, uint128 c4,
+              uint128 c5, uint128 c6, uint128 c7, uint128 c8) {
+    // Split the high columns into 52-bit limbs first, so that multiplying
+    // them by 2^260 mod p still fits in 128 bits
+    c6 += c5 >> 52;
+    const uint64_t d5 = static_cast<uint64_t>(c5) & M52;
+    c7 += c6 >> 52;
+    const uint64_t d6 = static_cast<uint64_t>(c6) & M52;
+    c8 += c7 >> 52;
+    const uint64_t d7 = static_cast<uint64_t>(c7) & M52;
+    const uint64_t d8 = static_cast<uint64_t>(c8) & M52;
+    const uint64_t d9 = static_cast<uint64_t>(c8 >> 52);
+
+    // Column 5 + i has weight 2^(52 * i) * 2^260
+    c0 += static_cast<uint128>(d5) * R260;
+    c1 += static_cast<uint128>(d6) * R260;
+    c2 += static_cast<uint128>(d7) * R260;
+    c3 += static_cast<uint128>(d8) * R260;
+    c4 += static_cast<uint128>(d9) * R260;
+
+    c1 += c0 >> 52;
+    c2 += c1 >> 52;
+    c3 += c2 >> 52;
+    c4 += c3 >> 52;
+
+    // Bits from 2^256 upwards fold back in as multiples of 2^256 mod p
+    const uint128 t = (static_cast<uint64_t>(c0) & M52) + (c4 >> 48) * R256;
+    n[0] = static_cast<uint64_t>(t) & M52;
+    n[1] = (static_cast<uint64_t>(c1) & M52) + static_cast<uint64_t>(t >> 52);
+    n[2] = static_cast<uint64_t>(c2) & M52;
+    n[3] = static_cast<uint64_t>(c3) & M52;
+    n[4] = static_cast<uint64_t>(c4) & M48;
+  }
+
+ public:
+  /// Limbs, least significant first.
+  uint64_t n[5];
+
+  /// Sets the element to a small integer.
+  void SetInt(uint32_t a) {
+    n[0] = a;
+    n[1] = n[2] = n[3] = n[4] = 0;
+  }
+
+  /// Sets the element from 32 big-endian bytes. Returns false (leaving the
+  /// reduced value) if the input is not below p.
+  bool SetB32(const uint8_t* b) {
+    uint64_t w[4];
+    for (unsigned int i = 0; i < 4; i++) {
+      w[i] = 0;
+      for (unsigned int j = 0; j < 8; j++) {
+        w[i] = (w[i] << 8) | b[(3 - i) * 8 + j];
+      }
+    }
+    n[0] = w[0] & M52;
+    n[1] = ((w[0] >> 52) | (w[1] << 12)) & M52;
+    n[2] = ((w[1] >> 40) | (w[2] << 24)) & M52;
+    n[3] = ((w[2] >> 28) | (w[3] << 36)) & M52;
+    n[4] = w[3] >> 16;
+
+    const bool overflow = (n[4] == M48) && ((n[3] & n[2] & n[1]) == M52) &&
+                          (n[0] >= 0xFFFFEFFFFFC2FULL);
+    if (overflow) {
+      Normalize();
+    }
+    return !overflow;
+  }
+
+  /// Writes the element as 32 big-endian bytes. Requires normalization.
+  void GetB32(uint8_t* b) const {
+    const uint64_t w[4] = {n[0] | (n[1] << 52), (n[1] >> 12) | (n[2] << 40),
+                           (n[2] >> 24) | (n[3] << 28),
+                           (n[3] >> 36) | (n[4] << 16)};
+    for (unsigned int i = 0; i < 4; i++) {
+      for (unsigned int j = 0; j < 8; j++) {
+        b[(3 - i) * 8 + j] = static_cast<uint8_t>(w[i] >> (56 - 8 * j));
+      }
+    }
+  }
+
+  /// Reduces the magnitude to 1 without fully reducing modulo p.
+  void NormalizeWeak() {
+    uint64_t t0 = n[0], t1 = n[1], t2 = n[2], t3 = n[3], t4 = n[4];
+
+    const uint64_t x = t4 >> 48;
+    t4 &= M48;
+
+    t0 += x * R256;
+    t1 += t0 >> 52;
+    t0 &= M52;
+    t2 += t1 >> 52;
+    t1 &= M52;
+    t3 += t2 >> 52;
+    t2 &= M52;
+    t4 += t3 >> 52;
+    t3 &= M52;
+
+    n[0] = t0;
+    n[1] = t1;
+    n[2] = t2;
+    n[3] = t3;
+    n[4] = t4;
+  }
+
+  /// Fully reduces the element modulo p (constant time).
+  void Normalize() {
+    NormalizeWeak();
+
+    // The value is now below 2p: subtract p once if it is at least 2^256
+    // (bit 48 of the top limb) or lies in [p, 2^256)
+    uint64_t t0 = n[0], t1 = n[1], t2 = n[2], t3 = n[3], t4 = n[4];
+    const uint64_t x =
+        (t4 >> 48) | ((t4 == M48) & ((t3 & t2 & t1) == M52) &
+                      (t0 >= 0xFFFFEFFFFFC2FULL));
+
+    t0 += x * R256;
+    t1 += t0 >> 52;
+    t0 &= M52;
+    t2 += t1 >> 52;
+    t1 &= M52;
+    t3 += t2 >> 52;
+    t2 &= M52;
+    t4 += t3 >> 52;
+    t3 &= M52;
+    t4 &= M48;
+
+    n[0] = t0;
+    n[1] = t1;
+    n[2] = t2;
+    n[3] = t3;
+    n[4] = t4;
+  }
+
+  /// Returns whether the element is zero modulo p (any magnitude).
+  bool NormalizesToZero() const {
+    FieldElem t = *this;
+    t.Normalize();
+    return t.IsZero();
+  }
+
+  /// Returns whether the element is zero. Requires normalization.
+  bool IsZero() const { return (n[0] | n[1] | n[2] | n[3] | n[4]) == 0; }
+
+  /// Returns whether the element is odd. Requires normalization.
+  bool IsOdd() const { return (n[0] & 1) != 0; }
+
+  /// Returns whether two elements are equal. Requires normalization.
+  bool Equal(const FieldElem& b) const {
+    return ((n[0] ^ b.n[0]) | (n[1] ^ b.n[1]) | (n[2] ^ b.n[2]) |
+            (n[3] ^ b.n[3]) | (n[4] ^ b.n[4])) == 0;
+  }
+
+  /// Sets *this to -a, where a has magnitude at most m (m < 2^19).
+  void Negate(const FieldElem& a, uint32_t m) {
+    const uint64_t k = 2 * (static_cast<uint64_t>(m) + 1);
+    n[0] = 0xFFFFEFFFFFC2FULL * k - a.n[0];
+    n[1] = M52 * k - a.n[1];
+    n[2] = M52 * k - a.n[2];
+    n[3] = M52 * k - a.n[3];
+    n[4] = M48 * k - a.n[4];
+  }
+
+  /// Adds a to *this.
+  void Add(const FieldElem& a) {
+    n[0] += a.n[0];
+    n[1] += a.n[1];
+    n[2] += a.n[2];
+    n[3] += a.n[3];
+    n[4] += a.n[4];
+  }
+
+  /// Multiplies *this by a small integer (the magnitude scales by k).
+  void MulInt(uint32_t k) {
+    n[0] *= k;
+    n[1] *= k;
+    n[2] *= k;
+    n[3] *= k;
+    n[4] *= k;
+  }
+
+  /// Halves *this modulo p (magnitude m becomes m / 2 + 1).
+  void Half() {
+    uint64_t t0 = n[0], t1 = n[1], t2 = n[2], t3 = n[3], t4 = n[4];
+
+    // Add p if the value is odd, so that the shift is exact
+    const uint64_t mask = (0 - (t0 & 1)) >> 12;
+    t0 += 0xFFFFEFFFFFC2FULL & mask;
+    t1 += mask;
+    t2 += mask;
+    t3 += mask;
+    t4 += mask >> 4;
+
+    n[0] = (t0 >> 1) + ((t1 & 1) << 51);
+    n[1] = (t1 >> 1) + ((t2 & 1) << 51);
+    n[2] = (t2 >> 1) + ((t3 & 1) << 51);
+    n[3] = (t3 >> 1) + ((t4 & 1) << 51);
+    n[4] = t4 >> 1;
+  }
+
+  /// Sets *this to a * b. Aliasing is allowed.
+  void Mul(const FieldElem& a, const FieldElem& b) {
+    const uint64_t a0 = a.n[0], a1 = a.n[1], a2 = a.n[2], a3 = a.n[3],
+                   a4 = a.n[4];
+    const uint64_t b0 = b.n[0], b1 = b.n[1], b2 = b.n[2], b3 = b.n[3],
+                   b4 = b.n[4];
+
+    Reduce(static_cast<uint128>(a0) * b0,
+           static_cast<uint128>(a0) * b1 + static_cast<uint128>(a1) * b0,
+           static_cast<uint128>(a0) * b2 + static_cast<uint128>(a1) * b1 +
+               static_cast<uint128>(a2) * b0,
+           static_cast<uint128>(a0) * b3 + static_cast<uint128>(a1) * b2 +
+               static_cast<uint128>(a2) * b1 + static_cast<uint128>(a3) * b0,
+           static_cast<uint128>(a0) * b4 + static_cast<uint128>(a1) * b3 +
+               static_cast<uint128>(a2) * b2 + static_cast<uint128>(a3) * b1 +
+               static_cast<uint128>(a4) * b0,
+           static_cast<uint128>(a1) * b4 + static_cast<uint128>(a2) * b3 +
+               static_cast<uint128>(a3) * b2 + static_cast<uint128>(a4) * b1,
+           static_cast<uint128>(a2) * b4 + static_cast<uint128>(a3) * b3 +
+               static_cast<uint128>(a4) * b2,
+           static_cast<uint128>(a3) * b4 + static_cast<uint128>(a4) * b3,
+           static_cast<uint128>(a4) * b4);
+  }
+
+  /// Sets *this to a^2. Aliasing is allowed.
+  void Sqr(const FieldElem& a) {
+    const uint64_t a0 = a.n[0], a1 = a.n[1], a2 = a.n[2], a3 = a.n[3],
+                   a4 = a.n[4];
+    const uint64_t d0 = a0 * 2, d1 = a1 * 2, d2 = a2 * 2, d3 = a3 * 2;
+
+    Reduce(static_cast<uint128>(a0) * a0, static_cast<uint128>(d0) * a1,
+           static_cast<uint128>(d0) * a2 + static_cast<uint128>(a1) * a1,
+           static_cast<uint128>(d0) * a3 + static_cast<uint128>(d1) * a2,
+           static_cast<uint128>(d0) * a4 + static_cast<uint128>(d1) * a3 +
+               static_cast<uint128>(a2) * a2,
+           static_cast<uint128>(d1) * a4 + static_cast<uint128>(d2) * a3,
+           static_cast<uint128>(d2) * a4 + static_cast<uint128>(a3) * a3,
+           static_cast<uint128>(d3) * a4, static_cast<uint128>(a4) * a4);
+  }
+
+  /// Replaces *this by a if flag is set (constant time).
+  void Cmov(const FieldElem& a, bool flag) {
+    const uint64_t mask = 0 - static_cast<uint64_t>(flag);
+    for (unsigned int i = 0; i < 5; i++) {
+      n[i] ^= mask & (n[i] ^ a.n[i]);
+    }
+  }
+
+  /// Sets *this to a^(2^k) * b, i.e. squares a k times then multiplies by b.
+  /// Used by the exponentiation chains below.
+  void SqrNMul(const FieldElem& a, unsigned int k, const FieldElem& b) {
+    FieldElem t = a;
+    for (unsigned int i = 0; i < k; i++) {
+      t.Sqr(t);
+    }
+    Mul(t, b);
+  }
+
+  /// Computes a^(2^223 - 1) and the intermediate powers a^(2^k - 1) for
+  /// k = 2 and 22 shared by Inv and Sqrt.
+  static void Pow223(const FieldElem& a, FieldElem& x2, FieldElem& x22,
+                     FieldElem& x223) {
+    FieldElem x3, x6, x9, x11, x44, x88, x176, x220;
+    x2.Sqr(a);
+    x2.Mul(x2, a);
+    x3.Sqr(x2);
+    x3.Mul(x3, a);
+    x6.SqrNMul(x3, 3, x3);
+    x9.SqrNMul(x6, 3, x3);
+    x11.SqrNMul(x9, 2, x2);
+    x22.SqrNMul(x11, 11, x11);
+    x44.SqrNMul(x22, 22, x22);
+    x88.SqrNMul(x44, 44, x44);
+    x176.SqrNMul(x88, 88, x88);
+    x220.SqrNMul(x176, 44, x44);
+    x223.SqrNMul(x220, 3, x3);
+  }
+
+  /// Sets *this to 1/a (a^(p-2)); the inverse of zero is zero.
+  void Inv(const FieldElem& a) {
+    FieldElem x2, x22, t;
+    Pow223(a, x2, x22, t);
+    t.SqrNMul(t, 23, x22);
+    t.SqrNMul(t, 5, a);
+    t.SqrNMul(t, 3, x2);
+    SqrNMul(t, 2, a);
+  }
+
+  /// Sets *this to a square root of a (a^((p+1)/4)). Returns whether a is a
+  /// quadratic residue, i.e. whether the result is actually a root.
+  bool Sqrt(const FieldElem& a) {
+    FieldElem x2, x22, t;
+    Pow223(a, x2, x22, t);
+    t.SqrNMul(t, 23, x22);
+    t.SqrNMul(t, 6, x2);
+    t.Sqr(t);
+    Sqr(t);
+
+    FieldElem check, ref = a;
+    check.Sqr(*this);
+    check.Normalize();
+    ref.Normalize();
+    return check.Equal(ref);
+  }
+};
+
+}  // namespace secp256k1
+
+#endif  // ZILLIQA_SRC_LIBSCHNORR_SRC_SECP256K1FIELD_H_
@@ -0,0 +1,1096 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "Schnorr.h"
+#include "SchnorrInternal.h"
+#include "Secp256k1Group.h"
+
+using namespace std;
+
+namespace secp256k1 {
+
+namespace {
+
+/// Window size of the static table of odd multiples of G.
+const unsigned int WINDOW_G = 10;
+
+/// Window size of the per-call table of odd multiples of the variable point.
+const unsigned int WINDOW_A = 5;
+
+/// Number of wNAF digits needed for a 256-bit scalar.
+const unsigned int WNAF_BITS = 257;
+
+/// Bits of the GLV-split scalars recoded by Pippenger's method, which leaves
+/// room for the carry out of the top signed digit.
+const unsigned int PIPPENGER_BITS = 130;
+
+/// Largest bucket window of Pippenger's method (2^(w-1) buckets).
+const unsigned int PIPPENGER_MAX_WINDOW = 14;
+
+/// Shape of the comb table for G: one row per 4-bit window of the scalar.
+const unsigned int COMB_BITS = 4;
+const unsigned int COMB_ROWS = 256 / COMB_BITS;
+const unsigned int COMB_COLUMNS = 1U << COMB_BITS;
+
+const uint8_t GENERATOR_UNCOMPRESSED[65] = {
+    0x04, 0x79, 0xBE, 0x66, 0x7E, 0xF9, 0xDC, 0xBB, 0xAC, 0x55, 0xA0,
+    0x62, 0x95, 0xCE, 0x87, 0x0B, 0x07, 0x02, 0x9B, 0xFC, 0xDB, 0x2D,
+    0xCE, 0x28, 0xD9, 0x59, 0xF2, 0x81, 0x5B, 0x16, 0xF8, 0x17, 0x98,
+    0x48, 0x3A, 0xDA, 0x77, 0x26, 0xA3, 0xC4, 0x65, 0x5D, 0xA4, 0xFB,
+    0xFC, 0x0E, 0x11, 0x08, 0xA8, 0xFD, 0x17, 0xB4, 0x48, 0xA6, 0x85,
+    0x54, 0x19, 0x9C, 0x47, 0xD0, 0x8F, 0xFB, 0x10, 0xD4, 0xB8};
+
+/// Fills table with the odd multiples a, 3a, ..., (2 * size - 1)a.
+void OddMultiplesVar(GeJacobian* table, unsigned int size,
+                     const GeJacobian& a) {
+  GeJacobian a2;
+  a2.Double(a);
+  table[0] = a;
+  for (unsigned int i = 1; i < size; i++) {
+    table[i].AddVar(table[i - 1], a2);
+  }
+}
+
+/// Recodes a scalar into width-w NAF: every non-zero digit is odd and below
+/// 2^(w-1) in absolute value, and any w consecutive digits contain at most
+/// one non-zero. Scalars above n/2 are recoded as the negation of n - a,
+/// which keeps the split GLV scalars at 129 digits. Returns the number of
+/// digits up to the last non-zero one.
+int Wnaf(int* wnaf, const Scalar& a, unsigned int w) {
+  Scalar abs = a;
+  int sign = 1;
+  if (a.GetBits(255, 1) != 0) {
+    abs.Negate(a);
+    sign = -1;
+  }
+
+  // One extra zero limb lets the windows run past bit 255
+  const uint64_t s[5] = {abs.d[0], abs.d[1], abs.d[2], abs.d[3], 0};
+  auto bits = [&s](unsigned int offset, unsigned int count) {
+    uint64_t v = s[offset >> 6] >> (offset & 0x3F);
+    if (((offset & 0x3F) + count) > 64) {
+      v |= s[(offset >> 6) + 1] << (64 - (offset & 0x3F));
+    }
+    return static_cast<int>(v & ((1ULL << count) - 1));
+  };
+
+  int last_set_bit = -1;
+  int carry = 0;
+  unsigned int bit = 0;
+
+  for (unsigned int i = 0; i < WNAF_BITS; i++) {
+    wnaf[i] = 0;
+  }
+
+  while (bit < WNAF_BITS) {
+    if (bits(bit, 1) == carry) {
+      bit++;
+      continue;
+    }
+
+    unsigned int now = w;
+    if (now > WNAF_BITS - bit) {
+      now = WNAF_BITS - bit;
+    }
+
+    int word = bits(bit, now) + carry;
+    carry = (word >> (w - 1)) & 1;
+    word -= carry << w;
+
+    wnaf[bit] = sign * word;
+    last_set_bit = static_cast<int>(bit);
+    bit += now;
+  }
+
+  return last_set_bit + 1;
+}
+
+/// Returns the affine odd multiples of base for the static wNAF tables.
+vector<GeAffine> OddMultiplesAffine(const GeJacobian& base) {
+  const unsigned int size = 1U << (WINDOW_G - 2);
+  vector<GeJacobian> jacobian(size);
+  OddMultiplesVar(jacobian.data(), size, base);
+
+  vector<GeAffine> affine(size);
+  GeAffine::SetAllJacobianVar(affine.data(), jacobian.data(), size);
+  return affine;
+}
+
+/// Static table of the odd multiples of G, built on first use.
+const vector<GeAffine>& GeneratorTable() {
+  static const vector<GeAffine> table = []() {
+    GeJacobian g;
+    g.SetAffine(GeAffine::Generator());
+    return OddMultiplesAffine(g);
+  }();
+  return table;
+}
+
+/// Static table of the odd multiples of 2^128 * G, built on first use.
+const vector<GeAffine>& Generator128Table() {
+  static const vector<GeAffine> table = []() {
+    GeJacobian g;
+    g.SetAffine(GeAffine::Generator());
+    for (unsigned int i = 0; i < 128; i++) {
+      g.Double(g);
+    }
+    return OddMultiplesAffine(g);
+  }();
+  return table;
+}
+
+/// Returns beta, the cube root of unity in GF(p) for which
+/// lambda * (x, y) = (beta * x, y).
+const FieldElem& Beta() {
+  static const FieldElem beta = []() {
+    const uint8_t bytes[32] = {
+        0x7A, 0xE9, 0x6A, 0x2B, 0x65, 0x7C, 0x07, 0x10, 0x6E, 0x64, 0x47,
+        0x9E, 0xAC, 0x34, 0x34, 0xE9, 0x9C, 0xF0, 0x49, 0x75, 0x12, 0xF5,
+        0x89, 0x95, 0xC1, 0x39, 0x6C, 0x28, 0x71, 0x95, 0x01, 0xEE};
+    FieldElem b;
+    b.SetB32(bytes);
+    return b;
+  }();
+  return beta;
+}
+
+/// Adds the table entry for wNAF digit n (if non-zero) to r.
+void AddDigitVar(GeJacobian& r, const GeJacobian* table, int n) {
+  if (n > 0) {
+    r.AddVar(r, table[(n - 1) / 2]);
+  } else if (n < 0) {
+    GeJacobian neg;
+    neg.Neg(table[(-n - 1) / 2]);
+    r.AddVar(r, neg);
+  }
+}
+
+/// Adds the affine table entry for wNAF digit n (if non-zero) to r.
+void AddDigitVar(GeJacobian& r, const GeAffine* table, int n) {
+  if (n > 0) {
+    r.AddAffineVar(r, table[(n - 1) / 2]);
+  } else if (n < 0) {
+    GeAffine neg;
+    neg.Neg(table[(-n - 1) / 2]);
+    r.AddAffineVar(r, neg);
+  }
+}
+
+/// Splits a into lo + hi * 2^128 with both parts below 2^128.
+void SplitHalves(const Scalar& a, Scalar& lo, Scalar& hi) {
+  lo.d[0] = a.d[0];
+  lo.d[1] = a.d[1];
+  lo.d[2] = lo.d[3] = 0;
+  hi.d[0] = a.d[2];
+  hi.d[1] = a.d[3];
+  hi.d[2] = hi.d[3] = 0;
+}
+
+/// Returns whether a or n - a is below 2^128, so that a needs no GLV split.
+bool IsShort(const Scalar& a) {
+  Scalar neg;
+  neg.Negate(a);
+  return ((a.d[2] | a.d[3]) == 0) || ((neg.d[2] | neg.d[3]) == 0);
+}
+
+/// Returns the bucket window that minimizes the additions of Pippenger's
+/// method over m scalars: each window adds every point into a bucket and
+/// then sums the buckets with about two additions per bucket.
+unsigned int PippengerWindow(size_t m) {
+  unsigned int best = 2;
+  size_t best_cost = 0;
+  for (unsigned int w = 2; w <= PIPPENGER_MAX_WINDOW; w++) {
+    const size_t windows = (PIPPENGER_BITS + w - 1) / w;
+    const size_t cost = windows * (m + (size_t{1} << w));
+    if ((w == 2) || (cost < best_cost)) {
+      best = w;
+      best_cost = cost;
+    }
+  }
+  return best;
+}
+
+/// Computes r = na * a + ng * G from the odd multiples of a and lambda * a
+/// for wNAF digits of width window, skipping na * a if table_a is null.
+/// na is split with the GLV endomorphism and ng into 128-bit halves, so that
+/// all four wNAF expansions have at most 129 digits and share one chain of
+/// doublings.
+template <typename Entry>
+void EcMultDoubleTableVar(GeJacobian& r, const Entry* table_a,
+                          const Entry* table_lam, unsigned int window,
+                          const Scalar& na, const Scalar& ng) {
+  array<int, WNAF_BITS> wnaf_na1;
+  array<int, WNAF_BITS> wnaf_na2;
+  array<int, WNAF_BITS> wnaf_ng1;
+  array<int, WNAF_BITS> wnaf_ng128;
+
+  int bits_na1 = 0;
+  int bits_na2 = 0;
+  if (table_a != nullptr) {
+    Scalar na1, na2;
+    na.SplitLambda(na1, na2);
+    bits_na1 = Wnaf(wnaf_na1.data(), na1, window);
+    bits_na2 = Wnaf(wnaf_na2.data(), na2, window);
+  }
+
+  Scalar ng1, ng128;
+  SplitHalves(ng, ng1, ng128);
+  const int bits_ng1 = Wnaf(wnaf_ng1.data(), ng1, WINDOW_G);
+  const int bits_ng128 = Wnaf(wnaf_ng128.data(), ng128, WINDOW_G);
+  const GeAffine* table_g = GeneratorTable().data();
+  const GeAffine* table_g128 = Generator128Table().data();
+
+  const int bits = max(max(bits_na1, bits_na2), max(bits_ng1, bits_ng128));
+
+  r.SetInfinity();
+  for (int i = bits - 1; i >= 0; i--) {
+    r.Double(r);
+    if (i < bits_na1) {
+      AddDigitVar(r, table_a, wnaf_na1[i]);
+    }
+    if (i < bits_na2) {
+      AddDigitVar(r, table_lam, wnaf_na2[i]);
+    }
+    if (i < bits_ng1) {
+      AddDigitVar(r, table_g, wnaf_ng1[i]);
+    }
+    if (i < bits_ng128) {
+      AddDigitVar(r, table_g128, wnaf_ng128[i]);
+    }
+  }
+}
+
+/// Returns a curve point with no known discrete logarithm with respect to G:
+/// the first valid x coordinate in a chain of SHA-256 hashes of a fixed label.
+GeAffine BlindingPoint() {
+  const string label = "Zilliqa Schnorr generator table blinding";
+  bytes digest(label.begin(), label.end());
+  GeAffine h;
+  while (true) {
+    SHA2<HashType::HASH_VARIANT_256> sha2;
+    sha2.Update(digest);
+    digest = sha2.Finalize();
+
+    FieldElem x;
+    if (x.SetB32(digest.data()) && h.SetXOVar(x, false)) {
+      return h;
+    }
+  }
+}
+
+/// Comb table of G: row i holds C_i + j * 16^i * G for j = 0..15, where
+/// C_i = 2^i * H for the rows below the last and the last row's offset
+/// cancels them all. The offsets keep every entry and every partial sum away
+/// from the point at infinity and from each other, so EcMultGen can use the
+/// branch-free addition.
+const vector<GeAffine>& CombTable() {
+  static const vector<GeAffine> table = []() {
+    vector<GeJacobian> jacobian(COMB_ROWS * COMB_COLUMNS);
+
+    GeJacobian base;
+    base.SetAffine(GeAffine::Generator());
+    GeJacobian offset;
+    offset.SetAffine(BlindingPoint());
+    GeJacobian offset_sum;
+    offset_sum.SetInfinity();
+
+    for (unsigned int i = 0; i < COMB_ROWS; i++) {
+      GeJacobian* row = &jacobian[i * COMB_COLUMNS];
+      if (i + 1 < COMB_ROWS) {
+        row[0] = offset;
+        offset_sum.AddVar(offset_sum, offset);
+        offset.Double(offset);
+      } else {
+        row[0].Neg(offset_sum);
+      }
+
+      for (unsigned int j = 1; j < COMB_COLUMNS; j++) {
+        row[j].AddVar(row[j - 1], base);
+      }
+
+      for (unsigned int k = 0; k < COMB_BITS; k++) {
+        base.Double(base);
+      }
+    }
+
+    vector<GeAffine> affine(jacobian.size());
+    GeAffine::SetAllJacobianVar(affine.data(), jacobian.data(),
+                                jacobian.size());
+    return affine;
+  }();
+  return table;
+}
+
+}  // namespace
+
+const GeAffine& GeAffine::Generator() {
+  static const GeAffine generator = []() {
+    GeAffine g;
+    g.ParseVar(GENERATOR_UNCOMPRESSED, sizeof(GENERATOR_UNCOMPRESSED));
+    return g;
+  }();
+  return generator;
+}
+
+bool GeAffine::SetXOVar(const FieldElem& fx, bool odd) {
+  FieldElem x2, c;
+  x2.Sqr(fx);
+  c.SetInt(7);
+  x2.Mul(x2, fx);
+  c.Add(x2);
+  if (!y.Sqrt(c)) {
+    return false;
+  }
+  y.Normalize();
+  if (y.IsOdd() != odd) {
+    y.Negate(y, 1);
+    y.Normalize();
+  }
+  x = fx;
+  x.Normalize();
+  infinity = false;
+  return true;
+}
+
+void GeAffine::SetJacobianVar(const GeJacobian& a) {
+  if (a.infinity) {
+    infinity = true;
+    return;
+  }
+
+  FieldElem zi, zi2, zi3;
+  zi.Inv(a.z);
+  zi2.Sqr(zi);
+  zi3.Mul(zi2, zi);
+  x.Mul(a.x, zi2);
+  y.Mul(a.y, zi3);
+  x.Normalize();
+  y.Normalize();
+  infinity = false;
+}
+
+void GeAffine::SetAllJacobianVar(GeAffine* r, const GeJacobian* a,
+                                 size_t len) {
+  // Montgomery's trick: prefix[i] holds the product of the z coordinates of
+  // the finite points before index i
+  vector<FieldElem> prefix(len);
+  FieldElem acc;
+  acc.SetInt(1);
+  bool any = false;
+  for (size_t i = 0; i < len; i++) {
+    prefix[i] = acc;
+    if (!a[i].infinity) {
+      acc.Mul(acc, a[i].z);
+      any = true;
+    }
+  }
+
+  FieldElem inv;
+  if (any) {
+    inv.Inv(acc);
+  }
+
+  for (size_t i = len; i-- > 0;) {
+    if (a[i].infinity) {
+      r[i].infinity = true;
+      continue;
+    }
+
+    FieldElem zi, zi2, zi3;
+    zi.Mul(inv, prefix[i]);
+    inv.Mul(inv, a[i].z);
+    zi2.Sqr(zi);
+    zi3.Mul(zi2, zi);
+    r[i].x.Mul(a[i].x, zi2);
+    r[i].y.Mul(a[i].y, zi3);
+    r[i].x.Normalize();
+    r[i].y.Normalize();
+    r[i].infinity = false;
+  }
+}
+
+void GeAffine::Neg(const GeAffine& a) {
+  *this = a;
+  if (!infinity) {
+    y.Negate(y, 1);
+    y.Normalize();
+  }
+}
+
+bool GeAffine::IsValidVar() const {
+  if (infinity) {
+    return false;
+  }
+
+  FieldElem y2, x3;
+  y2.Sqr(y);
+  x3.Sqr(x);
+  x3.Mul(x3, x);
+  FieldElem c;
+  c.SetInt(7);
+  x3.Add(c);
+  y2.Normalize();
+  x3.Normalize();
+  return y2.Equal(x3);
+}
+
+bool GeAffine::ParseVar(const uint8_t* in, size_t len) {
+  if ((len == PUB_KEY_SIZE) && ((in[0] == 0x02) || (in[0] == 0x03))) {
+    FieldElem fx;
+    if (!fx.SetB32(in + 1)) {
+      // x not below the field prime
+      return false;
+    }
+    return SetXOVar(fx, in[0] == 0x03);
+  }
+
+  if ((len == 65) && (in[0] == 0x04)) {
+    if (!x.SetB32(in + 1) || !y.SetB32(in + 33)) {
+      // Coordinate not below the field prime
+      return false;
+    }
+    infinity = false;
+    return IsValidVar();
+  }
+
+  return false;
+}
+
+void GeAffine::GetCompressed(uint8_t* out) const {
+  out[0] = y.IsOdd() ? 0x03 : 0x02;
+  x.GetB32(out + 1);
+}
+
+void GeAffine::GetUncompressed(uint8_t* out) const {
+  out[0] = 0x04;
+  x.GetB32(out + 1);
+  y.GetB32(out + 33);
+}
+
+void GeJacobian::SetInfinity() {
+  x.SetInt(0);
+  y.SetInt(0);
+  z.SetInt(0);
+  infinity = true;
+}
+
+void GeJacobian::SetAffine(const GeAffine& a) {
+  x = a.x;
+  y = a.y;
+  z.SetInt(1);
+  infinity = a.infinity;
+}
+
+void GeJacobian::Neg(const GeJacobian& a) {
+  *this = a;
+  y.Negate(y, 1);
+  y.NormalizeWeak();
+}
+
+void GeJacobian::MulLambda(const GeJacobian& a) {
+  *this = a;
+  x.Mul(x, Beta());
+}
+
+bool GeJacobian::EqualAffineVar(const GeAffine& b) const {
+  if (infinity || b.infinity) {
+    return infinity && b.infinity;
+  }
+
+  // Compare x * z^-2 and y * z^-3 with b by scaling b instead
+  FieldElem z2, z3, t;
+  z2.Sqr(z);
+  z3.Mul(z2, z);
+
+  t.Mul(b.x, z2);
+  t.Negate(t, 1);
+  t.Add(x);
+  if (!t.NormalizesToZero()) {
+    return false;
+  }
+
+  t.Mul(b.y, z3);
+  t.Negate(t, 1);
+  t.Add(y);
+  return t.NormalizesToZero();
+}
+
+void GeJacobian::Double(const GeJacobian& a) {
+  // Doubling with the result scaled by 1/2, so that z3 = y1 * z1:
+  // L = 3/2 x1^2, x3 = L^2 - 2 x1 y1^2, y3 = -(L (x3 - x1 y1^2) + y1^4)
+  infinity = a.infinity;
+  if (infinity) {
+    return;
+  }
+
+  FieldElem l, s, t;
+  z.Mul(a.z, a.y);
+  s.Sqr(a.y);
+  l.Sqr(a.x);
+  l.MulInt(3);
+  l.Half();
+  t.Negate(s, 1);
+  t.Mul(t, a.x);
+  x.Sqr(l);
+  x.Add(t);
+  x.Add(t);
+  s.Sqr(s);
+  t.Add(x);
+  y.Mul(t, l);
+  y.Add(s);
+  y.Negate(y, 2);
+  x.NormalizeWeak();
+  y.NormalizeWeak();
+}
+
+void GeJacobian::AddVar(const GeJacobian& a, const GeJacobian& b) {
+  if (a.infinity) {
+    *this = b;
+    return;
+  }
+  if (b.infinity) {
+    *this = a;
+    return;
+  }
+
+  FieldElem z12, z22, u1, u2, s1, s2, h, i, zz;
+  z22.Sqr(b.z);
+  z12.Sqr(a.z);
+  u1.Mul(a.x, z22);
+  u2.Mul(b.x, z12);
+  s1.Mul(a.y, z22);
+  s1.Mul(s1, b.z);
+  s2.Mul(b.y, z12);
+  s2.Mul(s2, a.z);
+  h.Negate(u1, 1);
+  h.Add(u2);
+  i.Negate(s2, 1);
+  i.Add(s1);
+
+  if (h.NormalizesToZero()) {
+    if (i.NormalizesToZero()) {
+      Double(a);
+    } else {
+      SetInfinity();
+    }
+    return;
+  }
+
+  zz.Mul(a.z, b.z);
+  AddFinish(zz, u1, s1, h, i);
+}
+
+void GeJacobian::AddAffineVar(const GeJacobian& a, const GeAffine& b) {
+  if (a.infinity) {
+    SetAffine(b);
+    return;
+  }
+  if (b.infinity) {
+    *this = a;
+    return;
+  }
+
+  FieldElem u1, s1, h, i;
+  AddAffineStart(a, b, u1, s1, h, i);
+
+  if (h.NormalizesToZero()) {
+    if (i.NormalizesToZero()) {
+      Double(a);
+    } else {
+      SetInfinity();
+    }
+    return;
+  }
+
+  AddFinish(a.z, u1, s1, h, i);
+}
+
+void GeJacobian::AddAffine(const GeJacobian& a, const GeAffine& b) {
+  FieldElem u1, s1, h, i;
+  AddAffineStart(a, b, u1, s1, h, i);
+  AddFinish(a.z, u1, s1, h, i);
+}
+
+void GeJacobian::AddAffineStart(const GeJacobian& a, const GeAffine& b,
+                                FieldElem& u1, FieldElem& s1, FieldElem& h,
+                                FieldElem& i) {
+  FieldElem z12, u2, s2;
+  z12.Sqr(a.z);
+  u1 = a.x;
+  u2.Mul(b.x, z12);
+  s1 = a.y;
+  s2.Mul(b.y, z12);
+  s2.Mul(s2, a.z);
+  h.Negate(u1, 1);
+  h.Add(u2);
+  i.Negate(s2, 1);
+  i.Add(s1);
+}
+
+void GeJacobian::AddFinish(const FieldElem& zz, const FieldElem& u1,
+                           const FieldElem& s1, const FieldElem& h,
+                           const FieldElem& i) {
+  // With h = u2 - u1 and i = s1 - s2 (the negated usual r):
+  // x3 = i^2 - h^3 - 2 u1 h^2, y3 = i (u1 h^2 - x3) - s1 h^3, z3 = zz h
+  FieldElem h2, h3, t;
+  z.Mul(zz, h);
+  infinity = false;
+
+  h2.Sqr(h);
+  h2.Negate(h2, 1);
+  h3.Mul(h2, h);
+  t.Mul(u1, h2);
+  x.Sqr(i);
+  x.Add(h3);
+  x.Add(t);
+  x.Add(t);
+  t.Add(x);
+  y.Mul(t, i);
+  h3.Mul(h3, s1);
+  y.Add(h3);
+  x.NormalizeWeak();
+  y.NormalizeWeak();
+}
+
+void EcMultGen(GeJacobian& r, const Scalar& k) {
+  const vector<GeAffine>& table = CombTable();
+
+  GeAffine add;
+  add.infinity = false;
+  for (unsigned int i = 0; i < COMB_ROWS; i++) {
+    const unsigned int bits = k.GetBits(i * COMB_BITS, COMB_BITS);
+
+    // Read every entry of the row so that the access pattern does not
+    // depend on the secret scalar
+    const GeAffine* row = &table[i * COMB_COLUMNS];
+    add.x = row[0].x;
+    add.y = row[0].y;
+    for (unsigned int j = 1; j < COMB_COLUMNS; j++) {
+      add.x.Cmov(row[j].x, j == bits);
+      add.y.Cmov(row[j].y, j == bits);
+    }
+
+    if (i == 0) {
+      r.SetAffine(add);
+    } else {
+      r.AddAffine(r, add);
+    }
+  }
+
+  // The offsets cancel to the point at infinity only for k = 0
+  r.infinity = r.z.NormalizesToZero();
+}
+
+void GeTable::Build(const GeAffine& p, unsigned int w) {
+  const unsigned int size = 1U << (w - 2);
+  vector<GeJacobian> jacobian(size);
+  GeJacobian pj;
+  pj.SetAffine(p);
+  OddMultiplesVar(jacobian.data(), size, pj);
+
+  window = w;
+  a.resize(size);
+  GeAffine::SetAllJacobianVar(a.data(), jacobian.data(), size);
+  lambda = a;
+  for (GeAffine& entry : lambda) {
+    entry.x.Mul(entry.x, Beta());
+    entry.x.Normalize();
+  }
+}
+
+size_t GeTable::SizeForWindow(unsigned int w) {
+  return 2 * (size_t{1} << (w - 2)) * sizeof(GeAffine);
+}
+
+void EcMultDoubleVar(GeJacobian& r, const GeAffine& a, const Scalar& na,
+                     const Scalar& ng) {
+  // The per-call table holds the odd multiples of a in Jacobian coordinates,
+  // which saves the inversion a conversion to affine would take
+  array<GeJacobian, 1U << (WINDOW_A - 2)> table_a;
+  array<GeJacobian, 1U << (WINDOW_A - 2)> table_lam;
+  const bool use_a = !a.infinity && !na.IsZero();
+  if (use_a) {
+    GeJacobian aj;
+    aj.SetAffine(a);
+    OddMultiplesVar(table_a.data(), table_a.size(), aj);
+    for (unsigned int i = 0; i < table_a.size(); i++) {
+      table_lam[i].MulLambda(table_a[i]);
+    }
+  }
+
+  EcMultDoubleTableVar(r, use_a ? table_a.data() : nullptr, table_lam.data(),
+                       WINDOW_A, na, ng);
+}
+
+void EcMultDoubleVar(GeJacobian& r, const GeTable& table, const Scalar& na,
+                     const Scalar& ng) {
+  const bool use_a = !table.a.empty() && !na.IsZero();
+  EcMultDoubleTableVar(r, use_a ? table.a.data() : nullptr,
+                       table.lambda.data(), table.window, na, ng);
+}
+
+void EcMultMultiVar(GeJacobian& r, const GeAffine* a, const Scalar* na,
+                    size_t n, const Scalar& ng) {
+  if (n <= STRAUS_MAX_POINTS) {
+    EcMultStrausVar(r, a, na, n, ng);
+  } else {
+    EcMultPippengerVar(r, a, na, n, ng);
+  }
+}
+
+void EcMultStrausVar(GeJacobian& r, const GeAffine* a, const Scalar* na,
+                     size_t n, const Scalar& ng) {
+  const size_t table_size = 1U << (WINDOW_A - 2);
+
+  // Only points that contribute get a table and an expansion
+  vector<size_t> used;
+  used.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    if (!a[i].infinity && !na[i].IsZero()) {
+      used.push_back(i);
+    }
+  }
+  const size_t m = used.size();
+
+  // Odd multiples of all points, converted to affine together
+  vector<GeJacobian> jacobian(m * table_size);
+  for (size_t j = 0; j < m; j++) {
+    GeJacobian aj;
+    aj.SetAffine(a[used[j]]);
+    OddMultiplesVar(&jacobian[j * table_size], table_size, aj);
+  }
+  vector<GeAffine> affine(m * table_size);
+  GeAffine::SetAllJacobianVar(affine.data(), jacobian.data(), affine.size());
+
+  // A short scalar gets one expansion over the point's table, any other
+  // scalar one per GLV part over the table and over its lambda images
+  vector<bool> split(m);
+  size_t num_split = 0;
+  for (size_t j = 0; j < m; j++) {
+    split[j] = !IsShort(na[used[j]]);
+    num_split += split[j] ? 1 : 0;
+  }
+
+  const size_t expansions = m + num_split;
+  vector<GeAffine> lambda(num_split * table_size);
+  vector<const GeAffine*> table(expansions);
+  vector<int> wnaf(expansions * WNAF_BITS);
+  vector<int> bits(expansions);
+  size_t e = 0;
+  size_t l = 0;
+  for (size_t j = 0; j < m; j++) {
+    const GeAffine* base = &affine[j * table_size];
+    if (!split[j]) {
+      table[e] = base;
+      bits[e] = Wnaf(&wnaf[e * WNAF_BITS], na[used[j]], WINDOW_A);
+      e++;
+      continue;
+    }
+
+    GeAffine* lam = &lambda[l * table_size];
+    for (size_t i = 0; i < table_size; i++) {
+      lam[i] = base[i];
+      lam[i].x.Mul(lam[i].x, Beta());
+      lam[i].x.Normalize();
+    }
+    l++;
+
+    Scalar n1, n2;
+    na[used[j]].SplitLambda(n1, n2);
+    table[e] = base;
+    bits[e] = Wnaf(&wnaf[e * WNAF_BITS], n1, WINDOW_A);
+    e++;
+    table[e] = lam;
+    bits[e] = Wnaf(&wnaf[e * WNAF_BITS], n2, WINDOW_A);
+    e++;
+  }
+
+  Scalar ng1, ng128;
+  SplitHalves(ng, ng1, ng128);
+  array<int, WNAF_BITS> wnaf_ng1;
+  array<int, WNAF_BITS> wnaf_ng128;
+  const int bits_ng1 = Wnaf(wnaf_ng1.data(), ng1, WINDOW_G);
+  const int bits_ng128 = Wnaf(wnaf_ng128.data(), ng128, WINDOW_G);
+  const GeAffine* table_g = GeneratorTable().data();
+  const GeAffine* table_g128 = Generator128Table().data();
+
+  int max_bits = max(bits_ng1, bits_ng128);
+  for (int b : bits) {
+    max_bits = max(max_bits, b);
+  }
+
+  r.SetInfinity();
+  for (int i = max_bits - 1; i >= 0; i--) {
+    r.Double(r);
+    for (size_t k = 0; k < expansions; k++) {
+      if (i < bits[k]) {
+        AddDigitVar(r, table[k], wnaf[k * WNAF_BITS + i]);
+      }
+    }
+    if (i < bits_ng1) {
+      AddDigitVar(r, table_g, wnaf_ng1[i]);
+    }
+    if (i < bits_ng128) {
+      AddDigitVar(r, table_g128, wnaf_ng128[i]);
+    }
+  }
+}
+
+void EcMultPippengerVar(GeJacobian& r, const GeAffine* a, const Scalar* na,
+                        size_t n, const Scalar& ng) {
+  // Every scalar is turned into two of at most 128 bits, the GLV parts for
+  // the points and the 128-bit halves for G and 2^128 * G, with the sign of
+  // a negative part moved onto its point
+  vector<GeAffine> points;
+  vector<Scalar> scalars;
+  points.reserve(2 * n + 2);
+  scalars.reserve(2 * n + 2);
+  auto add_term = [&points, &scalars](const GeAffine& p, const Scalar& k) {
+    if (p.infinity || k.IsZero()) {
+      return;
+    }
+    if (k.GetBits(255, 1) != 0) {
+      Scalar neg;
+      neg.Negate(k);
+      GeAffine neg_p;
+      neg_p.Neg(p);
+      points.push_back(neg_p);
+      scalars.push_back(neg);
+    } else {
+      points.push_back(p);
+      scalars.push_back(k);
+    }
+  };
+
+  for (size_t i = 0; i < n; i++) {
+    if (a[i].infinity || na[i].IsZero()) {
+      continue;
+    }
+
+    // Scalars that are already short, such as random batch weights, need
+    // no split
+    if (IsShort(na[i])) {
+      add_term(a[i], na[i]);
+      continue;
+    }
+
+    Scalar n1, n2;
+    na[i].SplitLambda(n1, n2);
+    GeAffine lam = a[i];
+    lam.x.Mul(lam.x, Beta());
+    lam.x.Normalize();
+    add_term(a[i], n1);
+    add_term(lam, n2);
+  }
+
+  Scalar ng1, ng128;
+  SplitHalves(ng, ng1, ng128);
+  add_term(GeAffine::Generator(), ng1);
+  add_term(Generator128Table()[0], ng128);
+
+  // Signed digits in [-2^(w-1), 2^(w-1)), stored window by window
+  const size_t m = points.size();
+  const unsigned int w = PippengerWindow(m);
+  const unsigned int windows = (PIPPENGER_BITS + w - 1) / w;
+  vector<int> digits(windows * m);
+  for (size_t j = 0; j < m; j++) {
+    int carry = 0;
+    for (unsigned int k = 0; k < windows; k++) {
+      int digit = static_cast<int>(scalars[j].GetBitsVar(k * w, w)) + carry;
+      carry = (digit >= (1 << (w - 1))) ? 1 : 0;
+      digit -= carry << w;
+      digits[k * m + j] = digit;
+    }
+  }
+
+  // Bucket b collects the points whose digit is +-(b + 1)
+  vector<GeJacobian> buckets(size_t{1} << (w - 1));
+  r.SetInfinity();
+  for (unsigned int k = windows; k-- > 0;) {
+    for (unsigned int i = 0; i < w; i++) {
+      r.Double(r);
+    }
+
+    for (GeJacobian& bucket : buckets) {
+      bucket.SetInfinity();
+    }
+    const int* window_digits = &digits[k * m];
+    for (size_t j = 0; j < m; j++) {
+      const int digit = window_digits[j];
+      if (digit > 0) {
+        buckets[digit - 1].AddAffineVar(buckets[digit - 1], points[j]);
+      } else if (digit < 0) {
+        GeAffine neg;
+        neg.Neg(points[j]);
+        buckets[-digit - 1].AddAffineVar(buckets[-digit - 1], neg);
+      }
+    }
+
+    // sum((b + 1) * buckets[b]) as a sum of running sums
+    GeJacobian running, sum;
+    running.SetInfinity();
+    sum.SetInfinity();
+    for (size_t b = buckets.size(); b-- > 0;) {
+      running.AddVar(running, buckets[b]);
+      sum.AddVar(sum, running);
+    }
+    r.AddVar(r, sum);
+  }
+}
+
+bool RandomBatchWeights(Scalar* r, size_t n) {
+  vector<uint8_t> random(n * 16);
+  if (RAND_bytes(random.data(), random.size()) != 1) {
+    // Random generation failed
+    return false;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    // 16 random bytes, padded to 32
+    array<uint8_t, 32> buf{};
+    copy(random.begin() + 16 * i, random.begin() + 16 * (i + 1),
+         buf.begin() + 16);
+    r[i].SetB32(buf.data());
+    if (r[i].IsZero()) {
+      r[i].SetInt(1);
+    }
+  }
+  return true;
+}
+
+bool LoadPoint(GeAffine& r, const EC_POINT* p, BN_CTX* ctx) {
+  if (EC_POINT_is_at_infinity(Schnorr::GetCurveGroup(), p)) {
+    r.infinity = true;
+    return true;
+  }
+
+  array<uint8_t, 65> buf;
+  if (EC_POINT_point2oct(Schnorr::GetCurveGroup(), p,
+                         POINT_CONVERSION_UNCOMPRESSED, buf.data(),
+                         buf.size(), ctx) != buf.size()) {
+    // Point octet conversion failed
+    return false;
+  }
+
+  return r.ParseVar(buf.data(), buf.size());
+}
+
+bool StorePoint(EC_POINT* r, const GeAffine& a, BN_CTX* ctx) {
+  if (a.infinity) {
+    return EC_POINT_set_to_infinity(Schnorr::GetCurveGroup(), r) != 0;
+  }
+
+  array<uint8_t, 65> buf;
+  a.GetUncompressed(buf.data());
+  return EC_POINT_oct2point(Schnorr::GetCurveGroup(), r, buf.data(),
+                            buf.size(), ctx) != 0;
+}
+
+bool LoadScalar(Scalar& r, const BIGNUM* bn) {
+  if (BN_is_negative(bn) || (BN_num_bytes(bn) > 32)) {
+    // Out of range
+    return false;
+  }
+
+  array<uint8_t, 32> buf{};
+  BN_bn2bin(bn, buf.data() + buf.size() - BN_num_bytes(bn));
+  r.SetB32(buf.data());
+  OPENSSL_cleanse(buf.data(), buf.size());
+  return true;
+}
+
+bool LoadSignatureScalar(Scalar& r, const BIGNUM* bn) {
+  if (BN_is_zero(bn) || BN_is_negative(bn) ||
+      (BN_cmp(bn, Schnorr::GetCurveOrder()) != -1)) {
+    // Not in range
+    return false;
+  }
+  return LoadScalar(r, bn);
+}
+
+bool StoreScalar(BIGNUM* r, const Scalar& a) {
+  array<uint8_t, 32> buf;
+  a.GetB32(buf.data());
+  const bool ok = (BN_bin2bn(buf.data(), buf.size(), r) != nullptr);
+  OPENSSL_cleanse(buf.data(), buf.size());
+  return ok;
+}
+
+bool MulGenerator(EC_POINT* r, const BIGNUM* k, BN_CTX* ctx) {
+  Scalar nk;
+  if (!LoadScalar(nk, k)) {
+    // Scalar conversion failed
+    return false;
+  }
+
+  GeJacobian rj;
+  EcMultGen(rj, nk);
+  nk.Clear();
+
+  GeAffine ra;
+  ra.SetJacobianVar(rj);
+  return StorePoint(r, ra, ctx);
+}
+
+bool CheckCommitment(const BIGNUM* s, const BIGNUM* r, const EC_POINT* P,
+                     const EC_POINT* Q, BN_CTX* ctx) {
+  Scalar ns, nr;
+  GeAffine p, q;
+  if (!LoadScalar(ns, s) || !LoadScalar(nr, r) || !LoadPoint(p, P, ctx) ||
+      !LoadPoint(q, Q, ctx)) {
+    // Invalid input
+    return false;
+  }
+
+  GeJacobian qj;
+  EcMultDoubleVar(qj, p, nr, ns);
+  return qj.EqualAffineVar(q);
+}
+
+bool VerifyCommitment(const BIGNUM* s, const BIGNUM* r, const EC_POINT* P,
+                      uint8_t* Q_out, uint8_t* P_out, BN_CTX* ctx) {
+  Scalar ns, nr;
+  GeAffine p;
+  if (!LoadScalar(ns, s) || !LoadScalar(nr, r) || !LoadPoint(p, P, ctx) ||
+      p.infinity) {
+    // Invalid input
+    return false;
+  }
+
+  GeJacobian qj;
+  EcMultDoubleVar(qj, p, nr, ns);
+
+  GeAffine q;
+  q.SetJacobianVar(qj);
+  if (q.infinity) {
+    // Commit at infinity
+    return false;
+  }
+
+  q.GetCompressed(Q_out);
+  p.GetCompressed(P_out);
+  return true;
+}
+
+}  // namespace secp256k1
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ZILLIQA_SRC_LIBSCHNORR_SRC_SECP256K1GROUP_H_
+#define ZILLIQA_SRC_LIBSCHNORR_SRC_SECP256K1GROUP_H_
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Secp256k1Field.h"
+#include "Secp256k1Scalar.h"
+
+/// Native arithmetic on the secp256k1 curve y^2 = x^3 + 7, used in place of
+/// the generic OpenSSL EC code on the hot paths. All functions with a "Var"
+/// suffix run in variable time and must only be given public data.
+namespace secp256k1 {
+
+struct GeJacobian;
+
+/// Curve point in affine coordinates. Unless infinity is set, x and y are
+/// normalized and the point lies on the curve.
+struct GeAffine {
+  FieldElem x;
+  FieldElem y;
+  bool infinity;
+
+  /// Returns the base point G.
+  static const GeAffine& Generator();
+
+  /// Sets the point with the given x coordinate and y parity. Returns false
+  /// if x is not the abscissa of a curve point.
+  bool SetXOVar(const FieldElem& x, bool odd);
+
+  /// Sets the point from the converted form of a Jacobian point.
+  void SetJacobianVar(const GeJacobian& a);
+
+  /// Converts len Jacobian points using a single field inversion.
+  static void SetAllJacobianVar(GeAffine* r, const GeJacobian* a,
+                                std::size_t len);
+
+  /// Sets *this to -a.
+  void Neg(const GeAffine& a);
+
+  /// Returns whether the coordinates satisfy the curve equation.
+  bool IsValidVar() const;
+
+  /// Parses a 33-byte compressed or 65-byte uncompressed SEC1 encoding.
+  bool ParseVar(const uint8_t* in, std::size_t len);
+
+  /// Writes the 33-byte compressed SEC1 encoding. Requires a finite point.
+  void GetCompressed(uint8_t* out) const;
+
+  /// Writes the 65-byte uncompressed SEC1 encoding. Requires a finite point.
+  void GetUncompressed(uint8_t* out) const;
+};
+
+/// Curve point in Jacobian coordinates (x / z^2, y / z^3). Every operation
+/// leaves the coordinates with magnitude 1.
+struct GeJacobian {
+  FieldElem x;
+  FieldElem y;
+  FieldElem z;
+  bool infinity;
+
+  /// Sets the point at infinity.
+  void SetInfinity();
+
+  /// Sets the point from affine coordinates.
+  void SetAffine(const GeAffine& a);
+
+  /// Sets *this to -a.
+  void Neg(const GeJacobian& a);
+
+  /// Sets *this to lambda * a = (beta * x, y, z), using the endomorphism.
+  void MulLambda(const GeJacobian& a);
+
+  /// Returns whether *this and b are the same point.
+  bool EqualAffineVar(const GeAffine& b) const;
+
+  /// Sets *this to 2 * a.
+  void Double(const GeJacobian& a);
+
+  /// Sets *this to a + b.
+  void AddVar(const GeJacobian& a, const GeJacobian& b);
+
+  /// Sets *this to a + b for an affine b.
+  void AddAffineVar(const GeJacobian& a, const GeAffine& b);
+
+  /// Sets *this to a + b in constant time. Both points must be finite and
+  /// a != +-b; otherwise the result has z = 0.
+  void AddAffine(const GeJacobian& a, const GeAffine& b);
+
+ private:
+  /// Computes the terms of a + b shared by the affine additions.
+  static void AddAffineStart(const GeJacobian& a, const GeAffine& b,
+                             FieldElem& u1, FieldElem& s1, FieldElem& h,
+                             FieldElem& i);
+
+  /// Completes an addition from its terms, zz being the product of the input
+  /// z coordinates. Requires h != 0.
+  void AddFinish(const FieldElem& zz, const FieldElem& u1, const FieldElem& s1,
+                 const FieldElem& h, const FieldElem& i);
+};
+
+/// Odd multiples of a fixed point and of its endomorphism image, in affine
+/// coordinates, for repeated double multiplications with the same point.
+struct GeTable {
+  unsigned int window = 0;
+  std::vector<GeAffine> a;
+  std::vector<GeAffine> lambda;
+
+  /// Builds the 2^(window - 2) odd multiples of the finite point p, for
+  /// wNAF digits of the given window (2 or more).
+  void Build(const GeAffine& p, unsigned int window);
+
+  /// Returns the number of bytes held by a table of the given window.
+  static std::size_t SizeForWindow(unsigned int window);
+};
+
+/// Computes r = k * G in constant time from a precomputed comb table of G,
+/// built on first use.
+void EcMultGen(GeJacobian& r, const Scalar& k);
+
+/// Computes r = na * a + ng * G in variable time. na is split with the GLV
+/// endomorphism and ng into 128-bit halves, and the four half-length parts
+/// are combined with interleaved wNAF using a per-call table of odd multiples
+/// of a (and lambda * a) and static tables for G and 2^128 * G.
+void EcMultDoubleVar(GeJacobian& r, const GeAffine& a, const Scalar& na,
+                     const Scalar& ng);
+
+/// Computes r = na * a + ng * G in variable time like EcMultDoubleVar, with
+/// the odd multiples of a taken from a precomputed table.
+void EcMultDoubleVar(GeJacobian& r, const GeTable& table, const Scalar& na,
+                     const Scalar& ng);
+
+/// Number of points up to which EcMultMultiVar uses Straus' method.
+const std::size_t STRAUS_MAX_POINTS = 48;
+
+/// Computes r = ng * G + sum(na[i] * a[i]) over n points in variable time,
+/// with Straus' method for up to STRAUS_MAX_POINTS points and Pippenger's
+/// above. Points at infinity and zero scalars are allowed.
+void EcMultMultiVar(GeJacobian& r, const GeAffine* a, const Scalar* na,
+                    std::size_t n, const Scalar& ng);
+
+/// EcMultMultiVar with Straus' method: the scalars of all points, split with
+/// the GLV endomorphism unless already below 2^128 in absolute value, are
+/// combined with interleaved wNAF over one chain of doublings, using
+/// per-point tables converted to affine with a single inversion.
+void EcMultStrausVar(GeJacobian& r, const GeAffine* a, const Scalar* na,
+                     std::size_t n, const Scalar& ng);
+
+/// EcMultMultiVar with Pippenger's bucket method: the scalars, split like
+/// Straus', are recoded into signed digits of a window chosen from n, and
+/// each window sums its points into buckets by digit.
+void EcMultPippengerVar(GeJacobian& r, const GeAffine* a, const Scalar* na,
+                        std::size_t n, const Scalar& ng);
+
+/// Fills r with n random nonzero scalars below 2^128, the weights of a
+/// randomized batch check. Returns false if random generation fails.
+bool RandomBatchWeights(Scalar* r, std::size_t n);
+
+// Conversions from and to the OpenSSL objects used by the public API
+
+/// Converts an OpenSSL point on the secp256k1 group.
+bool LoadPoint(GeAffine& r, const EC_POINT* p, BN_CTX* ctx);
+
+/// Stores a native point into an OpenSSL point.
+bool StorePoint(EC_POINT* r, const GeAffine& a, BN_CTX* ctx);
+
+/// Converts a non-negative BIGNUM of at most 256 bits, reducing it modulo
+/// the order.
+bool LoadScalar(Scalar& r, const BIGNUM* bn);
+
+/// Converts a signature scalar, checking that it is in [1, ..., order-1].
+bool LoadSignatureScalar(Scalar& r, const BIGNUM* bn);
+
+/// Stores a native scalar into a BIGNUM.
+bool StoreScalar(BIGNUM* r, const Scalar& a);
+
+/// Computes r = k * G for a BIGNUM k with EcMultGen.
+bool MulGenerator(EC_POINT* r, const BIGNUM* k, BN_CTX* ctx);
+
+/// Returns whether s*G + r*P equals Q.
+bool CheckCommitment(const BIGNUM* s, const BIGNUM* r, const EC_POINT* P,
+                     const EC_POINT* Q, BN_CTX* ctx);
+
+/// Recomputes the commitment Q = s*G + r*P of a Schnorr verification and
+/// writes the compressed encodings of Q and P, both 33 bytes. Returns false
+/// if any input cannot be converted or Q is the point at infinity.
+bool VerifyCommitment(const BIGNUM* s, const BIGNUM* r, const EC_POINT* P,
+                      uint8_t* Q_out, uint8_t* P_out, BN_CTX* ctx);
+
+}  // namespace secp256k1
+
+#endif  // ZILLIQA_SRC_LIBSCHNORR_SRC_SECP256K1GROUP_H_
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/crypto.h>
+
+#include "Secp256k1Scalar.h"
+
+namespace secp256k1 {
+
+namespace {
+
+using uint128 = unsigned __int128;
+
+/// 2^256 - n, least significant limb first.
+const uint64_t NC[3] = {0x402DA1732FC9BEBFULL, 0x4551231950B75FC4ULL, 1};
+
+/// Constants of the GLV decomposition, least significant limb first: the
+/// endomorphism eigenvalue lambda, the negated lattice basis vectors -b1 and
+/// -b2, and g1 = round(2^384 * b2 / n), g2 = round(2^384 * (-b1) / n).
+const Scalar LAMBDA = {{0xDF02967C1B23BD72ULL, 0x122E22EA20816678ULL,
+                        0xA5261C028812645AULL, 0x5363AD4CC05C30E0ULL}};
+const Scalar MINUS_B1 = {{0x6F547FA90ABFE4C3ULL, 0xE4437ED6010E8828ULL, 0, 0}};
+const Scalar MINUS_B2 = {{0xD765CDA83DB1562CULL, 0x8A280AC50774346DULL,
+                          0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL}};
+const Scalar G1 = {{0xE893209A45DBB031ULL, 0x3DAA8A1471E8CA7FULL,
+                    0xE86C90E49284EB15ULL, 0x3086D221A7D46BCDULL}};
+const Scalar G2 = {{0x1571B4AE8AC47F71ULL, 0x221208AC9DF506C6ULL,
+                    0x6F547FA90ABFE4C4ULL, 0xE4437ED6010E8828ULL}};
+
+/// Computes the full 512-bit product of a and b.
+void MulWide(uint64_t* l, const Scalar& a, const Scalar& b) {
+  for (unsigned int i = 0; i < 8; i++) {
+    l[i] = 0;
+  }
+  for (unsigned int i = 0; i < 4; i++) {
+    uint128 carry = 0;
+    for (unsigned int j = 0; j < 4; j++) {
+      carry += static_cast<uint128>(a.d[i]) * b.d[j] + l[i + j];
+      l[i + j] = static_cast<uint64_t>(carry);
+      carry >>= 64;
+    }
+    l[i + 4] = static_cast<uint64_t>(carry);
+  }
+}
+
+/// Returns round(a * b / 2^384).
+Scalar MulShift384(const Scalar& a, const Scalar& b) {
+  uint64_t l[8];
+  MulWide(l, a, b);
+  const uint128 t = (static_cast<uint128>(l[7]) << 64) + l[6] + (l[5] >> 63);
+  Scalar r;
+  r.d[0] = static_cast<uint64_t>(t);
+  r.d[1] = static_cast<uint64_t>(t >> 64);
+  r.d[2] = 0;
+  r.d[3] = 0;
+  return r;
+}
+
+/// Computes out[0..outlen) = lo[0..4) + hi[0..hilen) * (2^256 - n), which
+/// is congruent to lo + hi * 2^256 modulo n. The caller sizes outlen so that
+/// the result cannot overflow. The lengths are template parameters so that
+/// the loops unroll completely.
+template <unsigned int outlen, unsigned int hilen>
+void FoldHigh(uint64_t* out, const uint64_t* lo, const uint64_t* hi) {
+  for (unsigned int i = 0; i < outlen; i++) {
+    out[i] = (i < 4) ? lo[i] : 0;
+  }
+
+  for (unsigned int i = 0; i < hilen; i++) {
+    uint128 carry = 0;
+    for (unsigned int j = 0; j < 3; j++) {
+      carry += static_cast<uint128>(hi[i]) * NC[j] + out[i + j];
+      out[i + j] = static_cast<uint64_t>(carry);
+      carry >>= 64;
+    }
+    for (unsigned int k = i + 3; k < outlen; k++) {
+      carry += out[k];
+      out[k] = static_cast<uint64_t>(carry);
+      carry >>= 64;
+    }
+  }
+}
+
+}  // namespace
+
+void Scalar::SetWide(const uint64_t* l) {
+  // 512 bits -> at most 385 bits -> at most 258 bits -> 256 bits plus a
+  // carry, each step folding the part above 2^256 by 2^256 - n (129 bits)
+  uint64_t m[7];
+  FoldHigh<7, 4>(m, l, l + 4);
+  uint64_t p[5];
+  FoldHigh<5, 3>(p, m, m + 4);
+  uint64_t q[5];
+  FoldHigh<5, 1>(q, p, p + 4);
+
+  d[0] = q[0];
+  d[1] = q[1];
+  d[2] = q[2];
+  d[3] = q[3];
+  Reduce(static_cast<unsigned int>(q[4]) + CheckOverflow());
+}
+
+void Scalar::Mul(const Scalar& a, const Scalar& b) {
+  uint64_t l[8];
+  MulWide(l, a, b);
+  SetWide(l);
+}
+
+void Scalar::SplitLambda(Scalar& r1, Scalar& r2) const {
+  // r2 = c1 * (-b1) + c2 * (-b2), r1 = k - r2 * lambda, with c1 and c2 the
+  // rounded projections of k on the lattice basis
+  Scalar c1 = MulShift384(*this, G1);
+  Scalar c2 = MulShift384(*this, G2);
+  c1.Mul(c1, MINUS_B1);
+  c2.Mul(c2, MINUS_B2);
+  r2.Add(c1, c2);
+  r1.Mul(r2, LAMBDA);
+  r1.Sub(*this, r1);
+}
+
+void Scalar::Clear() { OPENSSL_cleanse(d, sizeof(d)); }
+
+Scalar ScalarSum::Get() const {
+  const uint64_t l[8] = {m_d[0], m_d[1], m_d[2], m_d[3], m_d[4], 0, 0, 0};
+  Scalar r;
+  r.SetWide(l);
+  return r;
+}
+
+}  // namespace secp256k1
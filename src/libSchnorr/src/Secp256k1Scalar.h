@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ZILLIQA_SRC_LIBSCHNORR_SRC_SECP256K1SCALAR_H_
+#define ZILLIQA_SRC_LIBSCHNORR_SRC_SECP256K1SCALAR_H_
+
+#include <cstdint>
+
+namespace secp256k1 {
+
+/// Integer modulo the secp256k1 group order n, as four 64-bit limbs (least
+/// significant first). Values are always kept fully reduced below n. All
+/// arithmetic runs in constant time.
+class Scalar {
+  static const uint64_t N0 = 0xBFD25E8CD0364141ULL;
+  static const uint64_t N1 = 0xBAAEDCE6AF48A03BULL;
+  static const uint64_t N2 = 0xFFFFFFFFFFFFFFFEULL;
+  static const uint64_t N3 = 0xFFFFFFFFFFFFFFFFULL;
+  /// 2^256 - n.
+  static const uint64_t NC0 = 0x402DA1732FC9BEBFULL;
+  static const uint64_t NC1 = 0x4551231950B75FC4ULL;
+  static const uint64_t NC2 = 1;
+
+  using uint128 = unsigned __int128;
+
+  /// Returns whether the limbs hold a value of at least n.
+  unsigned int CheckOverflow() const {
+    unsigned int yes = 0;
+    unsigned int no = 0;
+    no |= (d[3] < N3);
+    no |= (d[2] < N2);
+    yes |= (d[2] > N2) & ~no;
+    no |= (d[1] < N1);
+    yes |= (d[1] > N1) & ~no;
+    yes |= (d[0] >= N0) & ~no;
+    return yes;
+  }
+
+  /// Subtracts n overflow times (overflow is 0 or 1) by adding 2^256 - n.
+  void Reduce(unsigned int overflow) {
+    uint128 t = static_cast<uint128>(d[0]) + overflow * NC0;
+    d[0] = static_cast<uint64_t>(t);
+    t >>= 64;
+    t += static_cast<uint128>(d[1]) + overflow * NC1;
+    d[1] = static_cast<uint64_t>(t);
+    t >>= 64;
+    t += static_cast<uint128>(d[2]) + overflow * NC2;
+    d[2] = static_cast<uint64_t>(t);
+    t >>= 64;
+    t += d[3];
+    d[3] = static_cast<uint64_t>(t);
+  }
+
+ public:
+  /// Limbs, least significant first.
+  uint64_t d[4];
+
+  /// Sets the scalar to a small integer.
+  void SetInt(uint32_t v) {
+    d[0] = v;
+    d[1] = d[2] = d[3] = 0;
+  }
+
+  /// Sets the scalar from 32 big-endian bytes, reducing modulo n. Returns
+  /// whether the input was below n.
+  bool SetB32(const uint8_t* b) {
+    for (unsigned int i = 0; i < 4; i++) {
+      d[i] = 0;
+      for (unsigned int j = 0; j < 8; j++) {
+        d[i] = (d[i] << 8) | b[(3 - i) * 8 + j];
+      }
+    }
+    const unsigned int overflow = CheckOverflow();
+    Reduce(overflow);
+    return overflow == 0;
+  }
+
+  /// Writes the scalar as 32 big-endian bytes.
+  void GetB32(uint8_t* b) const {
+    for (unsigned int i = 0; i < 4; i++) {
+      for (unsigned int j = 0; j < 8; j++) {
+        b[(3 - i) * 8 + j] = static_cast<uint8_t>(d[i] >> (56 - 8 * j));
+      }
+    }
+  }
+
+  /// Sets *this to a + b.
+  void Add(const Scalar& a, const Scalar& b) {
+    uint128 t = static_cast<uint128>(a.d[0]) + b.d[0];
+    d[0] = static_cast<uint64_t>(t);
+    t >>= 64;
+    t += static_cast<uint128>(a.d[1]) + b.d[1];
+    d[1] = static_cast<uint64_t>(t);
+    t >>= 64;
+    t += static_cast<uint128>(a.d[2]) + b.d[2];
+    d[2] = static_cast<uint64_t>(t);
+    t >>= 64;
+    t += static_cast<uint128>(a.d[3]) + b.d[3];
+    d[3] = static_cast<uint64_t>(t);
+    t >>= 64;
+    Reduce(static_cast<unsigned int>(t) + CheckOverflow());
+  }
+
+  /// Sets *this to -a.
+  void Negate(const Scalar& a) {
+    const uint64_t nonzero = 0 - static_cast<uint64_t>(!a.IsZero());
+    uint128 t = static_cast<uint128>(~a.d[0]) + N0 + 1;
+    d[0] = static_cast<uint64_t>(t) & nonzero;
+    t >>= 64;
+    t += static_cast<uint128>(~a.d[1]) + N1;
+    d[1] = static_cast<uint64_t>(t) & nonzero;
+    t >>= 64;
+    t += static_cast<uint128>(~a.d[2]) + N2;
+    d[2] = static_cast<uint64_t>(t) & nonzero;
+    t >>= 64;
+    t += static_cast<uint128>(~a.d[3]) + N3;
+    d[3] = static_cast<uint64_t>(t) & nonzero;
+  }
+
+  /// Sets *this to a - b.
+  void Sub(const Scalar& a, const Scalar& b) {
+    Scalar nb;
+    nb.Negate(b);
+    Add(a, nb);
+  }
+
+  /// Sets *this to the 512-bit value l (least significant limb first)
+  /// reduced modulo n.
+  void SetWide(const uint64_t* l);
+
+  /// Sets *this to a * b. Aliasing is allowed.
+  void Mul(const Scalar& a, const Scalar& b);
+
+  /// Splits *this into r1 + r2 * lambda (mod n), where lambda is the cube
+  /// root of unity of the secp256k1 endomorphism. Each part is below 2^128
+  /// in absolute value, i.e. either r or n - r is below 2^128.
+  void SplitLambda(Scalar& r1, Scalar& r2) const;
+
+  /// Clears the limbs in a way the compiler cannot elide.
+  void Clear();
+
+  /// Returns whether two scalars are equal.
+  bool Equal(const Scalar& b) const {
+    return ((d[0] ^ b.d[0]) | (d[1] ^ b.d[1]) | (d[2] ^ b.d[2]) |
+            (d[3] ^ b.d[3])) == 0;
+  }
+
+  /// Returns whether the scalar is zero.
+  bool IsZero() const { return (d[0] | d[1] | d[2] | d[3]) == 0; }
+
+  /// Returns count (1 to 32) bits starting at offset, which must not cross a
+  /// limb boundary.
+  unsigned int GetBits(unsigned int offset, unsigned int count) const {
+    return static_cast<unsigned int>((d[offset >> 6] >> (offset & 0x3F)) &
+                                     ((1ULL << count) - 1));
+  }
+
+  /// Returns count (1 to 32) bits starting at offset, which may span limbs.
+  unsigned int GetBitsVar(unsigned int offset, unsigned int count) const {
+    if ((offset + count - 1) >> 6 == offset >> 6) {
+      return GetBits(offset, count);
+    }
+    return static_cast<unsigned int>(
+        ((d[offset >> 6] >> (offset & 0x3F)) |
+         (d[(offset >> 6) + 1] << (64 - (offset & 0x3F)))) &
+        ((1ULL << count) - 1));
+  }
+};
+
+/// Running sum of scalars with deferred reduction: each Add is a plain
+/// 256-bit addition into a 320-bit accumulator, and the sum is reduced
+/// modulo n once in Get. Up to 2^64 terms can be accumulated.
+class ScalarSum {
+  uint64_t m_d[5]{};
+
+ public:
+  /// Adds a to the sum.
+  void Add(const Scalar& a) {
+    unsigned __int128 t = static_cast<unsigned __int128>(m_d[0]) + a.d[0];
+    m_d[0] = static_cast<uint64_t>(t);
+    t >>= 64;
+    t += static_cast<unsigned __int128>(m_d[1]) + a.d[1];
+    m_d[1] = static_cast<uint64_t>(t);
+    t >>= 64;
+    t += static_cast<unsigned __int128>(m_d[2]) + a.d[2];
+    m_d[2] = static_cast<uint64_t>(t);
+    t >>= 64;
+    t += static_cast<unsigned __int128>(m_d[3]) + a.d[3];
+    m_d[3] = static_cast<uint64_t>(t);
+    m_d[4] += static_cast<uint64_t>(t >> 64);
+  }
+
+  /// Returns the sum reduced modulo n.
+  Scalar Get() const;
+};
+
+}  // namespace secp256k1
+
+#endif  // ZILLIQA_SRC_LIBSCHNORR_SRC_SECP256K1SCALAR_H_
@@ -69,6 +69,16 @@ class SHA2 {
     SHA256_Update(&m_context, input.data() + offset, size);
   }
 
+  /// Hash update function.
+  void Update(const uint8_t* input, size_t size) {
+    if (size == 0) {
+      // Nothing to update
+      return;
+    }
+
+    SHA256_Update(&m_context, input, size);
+  }
+
   /// Resets the algorithm.
   void Reset() { SHA256_Init(&m_context); }
 
@@ -83,6 +93,9 @@ class SHA2 {
     }
     return output;
   }
+
+  /// Hash finalize function, writing the digest to dst without allocating.
+  void Finalize(uint8_t* dst) { SHA256_Final(dst, &m_context); }
 };
 
 #endif  // ZILLIQA_SRC_LIBSCHNORR_SRC_SHA2_H_
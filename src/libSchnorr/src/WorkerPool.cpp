@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "SchnorrInternal.h"
+
+using namespace std;
+
+namespace {
+
+unsigned int DefaultThreads() {
+  return max(thread::hardware_concurrency(), 1u);
+}
+
+}  // namespace
+
+/// Tasks of one ParallelFor or Submit call. Threads claim indices until the
+/// count is reached, so a job left in the queue after its last claim is
+/// never run. Submitted tasks are owned by their job.
+struct WorkerPool::Job {
+  const function<void(size_t)>* task;
+  function<void(size_t)> ownedTask;
+  size_t count;
+  atomic<size_t> next{0};
+  atomic<size_t> done{0};
+  condition_variable finished;
+
+  /// Runs tasks until none are left to claim. Returns true if this thread
+  /// completed the last one.
+  bool Run() {
+    bool last = false;
+    for (size_t i = next++; i < count; i = next++) {
+      (*task)(i);
+      last = (++done == count);
+    }
+    return last;
+  }
+};
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+WorkerPool::WorkerPool() { startWorkers(DefaultThreads()); }
+
+WorkerPool::~WorkerPool() { stopWorkers(); }
+
+WorkerPool& WorkerPool::Get() {
+  static WorkerPool pool;
+  return pool;
+}
+
+void WorkerPool::startWorkers(unsigned int threads) {
+  m_threads = threads;
+  for (unsigned int i = 1; i < threads; i++) {
+    m_workers.emplace_back(&WorkerPool::workerLoop, this);
+  }
+}
+
+void WorkerPool::stopWorkers() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+  m_workers.clear();
+  m_stop = false;
+}
+
+void WorkerPool::drainJobs() {
+  unique_lock<mutex> lock(m_mutex);
+  while (!m_jobs.empty()) {
+    shared_ptr<Job> job = m_jobs.front();
+    m_jobs.pop_front();
+    lock.unlock();
+    const bool last = job->Run();
+    lock.lock();
+    if (last) {
+      job->finished.notify_all();
+    }
+  }
+}
+
+void WorkerPool::workerLoop() {
+  unique_lock<mutex> lock(m_mutex);
+  while (true) {
+    m_wake.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+    if (m_stop) {
+      return;
+    }
+
+    // Every claim on the front job is taken once it returns, so it leaves
+    // the queue for the next one
+    shared_ptr<Job> job = m_jobs.front();
+    lock.unlock();
+    const bool last = job->Run();
+    lock.lock();
+    if (!m_jobs.empty() && (m_jobs.front() == job)) {
+      m_jobs.pop_front();
+    }
+    if (last) {
+      job->finished.notify_all();
+    }
+  }
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+void WorkerPool::SetThreads(unsigned int threads) {
+  if (threads == 0) {
+    threads = DefaultThreads();
+  }
+
+  // Running calls finish on their own threads while the workers restart
+  lock_guard<mutex> lock(m_configMutex);
+  if (threads != m_threads) {
+    stopWorkers();
+    startWorkers(threads);
+
+    // Without workers, submitted tasks left in the queue run here
+    if (m_workers.empty()) {
+      drainJobs();
+    }
+  }
+}
+
+unsigned int WorkerPool::GetThreads() const { return m_threads; }
+
+// ============================================================================
+// Execution
+// ============================================================================
+
+void WorkerPool::ParallelFor(size_t count, const function<void(size_t)>& task) {
+  if ((count <= 1) || (m_threads == 1)) {
+    for (size_t i = 0; i < count; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  auto job = make_shared<Job>();
+  job->task = &task;
+  job->count = count;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_jobs.push_back(job);
+  }
+  m_wake.notify_all();
+
+  job->Run();
+
+  // Wait for the tasks claimed by workers, and drop the job if no worker
+  // got to it
+  unique_lock<mutex> lock(m_mutex);
+  job->finished.wait(lock, [&job]() { return job->done == job->count; });
+  auto it = find(m_jobs.begin(), m_jobs.end(), job);
+  if (it != m_jobs.end()) {
+    m_jobs.erase(it);
+  }
+}
+
+void WorkerPool::Submit(function<void()> task) {
+  auto job = make_shared<Job>();
+  job->ownedTask = [task](size_t) { task(); };
+  job->task = &job->ownedTask;
+  job->count = 1;
+
+  // Checked under the lock, so that a job is never queued after SetThreads
+  // has drained the queue of a pool without workers
+  unique_lock<mutex> lock(m_mutex);
+  if (m_threads == 1) {
+    lock.unlock();
+    task();
+    return;
+  }
+  m_jobs.push_back(job);
+  lock.unlock();
+  m_wake.notify_one();
+}
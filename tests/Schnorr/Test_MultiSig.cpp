@@ -15,13 +15,39 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <thread>
 #include "libSchnorr/include/MultiSig.h"
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
 #define BOOST_TEST_MODULE multisigtest
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 
 using namespace std;
+using namespace std::chrono;
+
+system_clock::time_point r_timer_start() { return system_clock::now(); }
+
+double r_timer_end(system_clock::time_point start_time) {
+  duration<double, std::micro> difference = system_clock::now() - start_time;
+  return difference.count();
+}
+
+/// Bytes in use on the main malloc arena, or 0 where unknown.
+size_t heap_in_use() {
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
 
 BOOST_AUTO_TEST_SUITE(multisigtest)
 
@@ -99,6 +125,20 @@ BOOST_AUTO_TEST_CASE(test_multisig) {
                                                *aggregatedPubkey) == false,
                       "Signature verification (wrong message) failed");
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+  /// Verify the signature with a prepared aggregated key
+  VerifyingKey aggregatedKey(*aggregatedPubkey);
+  BOOST_CHECK_MESSAGE(
+      MultiSig::MultiSigVerify(message_rand, *signature, aggregatedKey) == true,
+      "Signature verification (verifying key) failed");
+  BOOST_CHECK_MESSAGE(
+      MultiSig::MultiSigVerify(message_1, *signature, aggregatedKey) == false,
+      "Signature verification (verifying key, wrong message) failed");
+  BOOST_CHECK_MESSAGE(
+      Schnorr::Verify(message_rand, *signature, aggregatedKey) == false,
+      "Signature verification (verifying key, no domain separation) failed");
+#endif
+
   /// Check CommitPoint operator =
   CommitPoint cp_copy;
   cp_copy = *aggregatedCommit;
@@ -118,6 +158,814 @@ BOOST_AUTO_TEST_CASE(test_multisig) {
                       "Response operator= failed");
 }
 
+#ifdef SCHNORR_NATIVE_SECP256K1
+/**
+ * \brief test_verify_responses
+ *
+ * \details Test batch verification of responses against VerifyResponse
+ */
+BOOST_AUTO_TEST_CASE(test_verify_responses) {
+  const unsigned int nbsigners = 600;
+  vector<PrivKey> privkeys;
+  vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    PairOfKey keypair = Schnorr::GenKeyPair();
+    privkeys.emplace_back(keypair.first);
+    pubkeys.emplace_back(keypair.second);
+  }
+
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+
+  vector<CommitSecret> secrets(nbsigners);
+  vector<CommitPoint> points;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    points.emplace_back(secrets.at(i));
+  }
+
+  shared_ptr<PubKey> aggregatedPubkey = MultiSig::AggregatePubKeys(pubkeys);
+  shared_ptr<CommitPoint> aggregatedCommit = MultiSig::AggregateCommits(points);
+  Challenge challenge(*aggregatedCommit, *aggregatedPubkey, message);
+
+  vector<Response> responses;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    responses.emplace_back(secrets.at(i), challenge, privkeys.at(i));
+  }
+
+  /// All valid, for the whole committee and for small subsets (Straus)
+  BOOST_CHECK_MESSAGE(
+      MultiSig::VerifyResponses(responses, challenge, pubkeys, points),
+      "Batch verification failed");
+  for (unsigned int n : {1, 2, 47, 48, 49}) {
+    BOOST_CHECK_MESSAGE(
+        MultiSig::VerifyResponses(
+            vector<Response>(responses.begin(), responses.begin() + n),
+            challenge, vector<PubKey>(pubkeys.begin(), pubkeys.begin() + n),
+            vector<CommitPoint>(points.begin(), points.begin() + n)),
+        "Batch verification failed for " << n << " signers");
+  }
+
+  /// One wrong response, swapped commit points or a wrong challenge fail
+  vector<Response> wrong_responses(responses);
+  wrong_responses.at(nbsigners / 2) = responses.at(nbsigners / 2 + 1);
+  BOOST_CHECK_MESSAGE(
+      !MultiSig::VerifyResponses(wrong_responses, challenge, pubkeys, points),
+      "Batch verification passed with a wrong response");
+
+  vector<CommitPoint> swapped_points(points);
+  swap(swapped_points.at(0), swapped_points.at(1));
+  BOOST_CHECK_MESSAGE(!MultiSig::VerifyResponses(responses, challenge, pubkeys,
+                                                 swapped_points),
+                      "Batch verification passed with swapped commit points");
+
+  Challenge other(*aggregatedCommit, *aggregatedPubkey,
+                  std::vector<uint8_t>(1024, 0x01));
+  BOOST_CHECK_MESSAGE(
+      !MultiSig::VerifyResponses(responses, other, pubkeys, points),
+      "Batch verification passed with a wrong challenge");
+
+  /// Malformed input
+  BOOST_CHECK_MESSAGE(!MultiSig::VerifyResponses({}, challenge, {}, {}),
+                      "Batch verification passed without responses");
+  BOOST_CHECK_MESSAGE(
+      !MultiSig::VerifyResponses(
+          responses, challenge,
+          vector<PubKey>(pubkeys.begin(), pubkeys.end() - 1), points),
+      "Batch verification passed with mismatched sizes");
+  vector<Response> uninitialized(responses);
+  uninitialized.back() = Response();
+  BOOST_CHECK_MESSAGE(!MultiSig::VerifyResponses(uninitialized, challenge,
+                                                 pubkeys, points),
+                      "Batch verification passed with a missing response");
+
+  /// Faulty signers are identified by bisection
+  vector<unsigned int> faulty;
+  BOOST_CHECK_MESSAGE(MultiSig::FindFaultyResponses(responses, challenge,
+                                                    pubkeys, points, faulty),
+                      "FindFaultyResponses failed");
+  BOOST_CHECK_MESSAGE(faulty.empty(), "Faulty signers in a valid round");
+
+  const vector<unsigned int> bad = {0, 7, 8, 311, nbsigners - 1};
+  vector<Response> bad_responses(responses);
+  for (unsigned int i : bad) {
+    bad_responses.at(i) = responses.at((i + 1) % nbsigners);
+  }
+  bad_responses.at(100) = Response();
+  vector<unsigned int> expected = bad;
+  expected.insert(expected.begin() + 3, 100);
+  BOOST_CHECK_MESSAGE(MultiSig::FindFaultyResponses(bad_responses, challenge,
+                                                    pubkeys, points, faulty),
+                      "FindFaultyResponses failed");
+  BOOST_CHECK_MESSAGE(faulty == expected, "Wrong faulty signers found");
+
+  BOOST_CHECK_MESSAGE(
+      !MultiSig::FindFaultyResponses(bad_responses, Challenge(), pubkeys,
+                                     points, faulty),
+      "FindFaultyResponses passed without a challenge");
+  BOOST_CHECK_MESSAGE(faulty.empty(), "Faulty signers left on failure");
+
+  /// Compare with one VerifyResponse call per signer, for one faulty signer
+  /// and for all of the above
+  vector<Response> one_bad(responses);
+  one_bad.at(nbsigners / 3) = responses.at(0);
+  for (const auto* round : {&one_bad, &bad_responses}) {
+    auto t = r_timer_start();
+    for (unsigned int i = 0; i < nbsigners; i++) {
+      MultiSig::VerifyResponse(round->at(i), challenge, pubkeys.at(i),
+                               points.at(i));
+    }
+    const double single_time = r_timer_end(t);
+
+    t = r_timer_start();
+    MultiSig::FindFaultyResponses(*round, challenge, pubkeys, points, faulty);
+    const double isolate_time = r_timer_end(t);
+
+    cout << "Faulty signers             = " << faulty.size() << endl;
+    cout << "VerifyResponse (usec)      = " << single_time << endl;
+    cout << "FindFaultyResponses (usec) = " << isolate_time << endl;
+  }
+
+  /// Compare with one VerifyResponse call per signer
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    MultiSig::VerifyResponse(responses.at(i), challenge, pubkeys.at(i),
+                             points.at(i));
+  }
+  const double single_time = r_timer_end(t);
+
+  t = r_timer_start();
+  MultiSig::VerifyResponses(responses, challenge, pubkeys, points);
+  const double batch_time = r_timer_end(t);
+
+  cout << "Signers                  = " << nbsigners << endl;
+  cout << "VerifyResponse (usec)    = " << single_time << endl;
+  cout << "VerifyResponses (usec)   = " << batch_time << endl;
+}
+#endif
+
+/**
+ * \brief test_aggregation
+ *
+ * \details Test the aggregation of large committees against a serial sum,
+ * and its latency as the number of batch threads grows
+ */
+BOOST_AUTO_TEST_CASE(test_aggregation) {
+  const unsigned int nbsigners = 4000;
+  const unsigned int max_threads =
+      max(thread::hardware_concurrency(), (unsigned int)1);
+
+  vector<PrivKey> privkeys;
+  vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    PairOfKey keypair = Schnorr::GenKeyPair();
+    privkeys.emplace_back(keypair.first);
+    pubkeys.emplace_back(keypair.second);
+  }
+  vector<CommitSecret> secrets(nbsigners);
+  vector<CommitPoint> points;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    points.emplace_back(secrets.at(i));
+  }
+
+  /// Public keys match a serial EC_POINT_add sum around the chunk sizes,
+  /// also with a key at infinity
+  Schnorr::SetBatchThreads(3);
+  pubkeys.at(300) = PubKey();
+  for (unsigned int n : {1u, 2u, 255u, 256u, 257u, 513u, nbsigners}) {
+    PubKey expected(pubkeys.at(0));
+    for (unsigned int i = 1; i < n; i++) {
+      EC_POINT_add(Schnorr::GetCurveGroup(), expected.m_P.get(),
+                   expected.m_P.get(), pubkeys.at(i).m_P.get(), nullptr);
+    }
+    shared_ptr<PubKey> aggregated = MultiSig::AggregatePubKeys(
+        vector<PubKey>(pubkeys.begin(), pubkeys.begin() + n));
+    BOOST_CHECK_MESSAGE(aggregated != nullptr && *aggregated == expected,
+                        "Aggregated PubKey mismatch for " << n << " signers");
+  }
+  pubkeys.at(300) = PubKey(privkeys.at(300));
+
+  /// The aggregated commit and response form a valid multisignature
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+  shared_ptr<PubKey> aggregatedPubkey = MultiSig::AggregatePubKeys(pubkeys);
+  shared_ptr<CommitPoint> aggregatedCommit = MultiSig::AggregateCommits(points);
+  BOOST_REQUIRE(aggregatedPubkey != nullptr && aggregatedCommit != nullptr);
+  Challenge challenge(*aggregatedCommit, *aggregatedPubkey, message);
+  vector<Response> responses;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    responses.emplace_back(secrets.at(i), challenge, privkeys.at(i));
+  }
+  shared_ptr<Response> aggregatedResponse =
+      MultiSig::AggregateResponses(responses);
+  BOOST_REQUIRE(aggregatedResponse != nullptr);
+  shared_ptr<Signature> signature =
+      MultiSig::AggregateSign(challenge, *aggregatedResponse);
+  BOOST_CHECK_MESSAGE(
+      MultiSig::MultiSigVerify(message, *signature, *aggregatedPubkey),
+      "Aggregated multisignature verification failed");
+
+  /// Compare the latency with a serial EC_POINT_add sum
+  auto t = r_timer_start();
+  PubKey serial(pubkeys.at(0));
+  for (unsigned int i = 1; i < nbsigners; i++) {
+    EC_POINT_add(Schnorr::GetCurveGroup(), serial.m_P.get(), serial.m_P.get(),
+                 pubkeys.at(i).m_P.get(), nullptr);
+  }
+  cout << "Serial EC_POINT_add (usec) = " << r_timer_end(t) << endl;
+
+  /// Compare the latency with 1, 2, 4, ... threads up to the number of cores
+  for (unsigned int num_threads = 1;; num_threads *= 2) {
+    num_threads = min(num_threads, max_threads);
+    Schnorr::SetBatchThreads(num_threads);
+
+    t = r_timer_start();
+    shared_ptr<PubKey> pubkey = MultiSig::AggregatePubKeys(pubkeys);
+    const double pubkey_time = r_timer_end(t);
+
+    t = r_timer_start();
+    shared_ptr<CommitPoint> commit = MultiSig::AggregateCommits(points);
+    const double commit_time = r_timer_end(t);
+
+    t = r_timer_start();
+    shared_ptr<Response> response = MultiSig::AggregateResponses(responses);
+    const double response_time = r_timer_end(t);
+
+    BOOST_CHECK_MESSAGE(*pubkey == *aggregatedPubkey &&
+                            *commit == *aggregatedCommit &&
+                            *response == *aggregatedResponse,
+                        "Aggregation mismatch for " << num_threads
+                                                    << " threads");
+
+    cout << "Batch threads              = " << num_threads << endl;
+    cout << "AggregatePubKeys (usec)    = " << pubkey_time << endl;
+    cout << "AggregateCommits (usec)    = " << commit_time << endl;
+    cout << "AggregateResponses (usec)  = " << response_time << endl;
+
+    if (num_threads == max_threads) {
+      break;
+    }
+  }
+  Schnorr::SetBatchThreads(0);
+}
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+/**
+ * \brief test_committee_key_set
+ *
+ * \details Test the aggregated keys of signer subsets derived from a
+ * CommitteeKeySet against MultiSig::AggregatePubKeys
+ */
+BOOST_AUTO_TEST_CASE(test_committee_key_set) {
+  const unsigned int nbmembers = 1000;
+  vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    pubkeys.emplace_back(Schnorr::GenKeyPair().second);
+  }
+
+  const CommitteeKeySet committee(pubkeys);
+  BOOST_REQUIRE(committee.Initialized());
+  BOOST_CHECK_MESSAGE(committee.Size() == nbmembers, "Committee size mismatch");
+  BOOST_CHECK_MESSAGE(
+      committee.GetAggregatedPubKey() == *MultiSig::AggregatePubKeys(pubkeys),
+      "Committee aggregated PubKey mismatch");
+
+  /// Subsets from a single signer to the whole committee, on both sides of
+  /// the add / subtract threshold
+  for (unsigned int absent : {0u, 1u, 10u, 499u, 500u, 501u, 990u, 999u}) {
+    vector<bool> signers(nbmembers, true);
+    for (unsigned int i = 0; i < absent; i++) {
+      signers.at((i * 7919) % nbmembers) = false;
+    }
+
+    vector<PubKey> present;
+    for (unsigned int i = 0; i < nbmembers; i++) {
+      if (signers.at(i)) {
+        present.emplace_back(pubkeys.at(i));
+      }
+    }
+
+    shared_ptr<PubKey> aggregated = committee.AggregatePubKeys(signers);
+    BOOST_CHECK_MESSAGE(
+        aggregated != nullptr &&
+            *aggregated == *MultiSig::AggregatePubKeys(present),
+        "Subset aggregated PubKey mismatch for " << absent << " absent");
+  }
+
+  /// No signer, a wrong bitmap size or an empty committee fail
+  BOOST_CHECK_MESSAGE(
+      committee.AggregatePubKeys(vector<bool>(nbmembers, false)) == nullptr,
+      "Aggregation passed without signers");
+  BOOST_CHECK_MESSAGE(
+      committee.AggregatePubKeys(vector<bool>(nbmembers + 1, true)) == nullptr,
+      "Aggregation passed with a wrong bitmap size");
+  BOOST_CHECK_MESSAGE(!CommitteeKeySet({}).Initialized(),
+                      "Empty committee initialized");
+
+  /// Compare with rebuilding the list of signers for a round with 10 absent
+  vector<bool> signers(nbmembers, true);
+  for (unsigned int i = 0; i < 10; i++) {
+    signers.at(i * 97) = false;
+  }
+  auto t = r_timer_start();
+  vector<PubKey> present;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    if (signers.at(i)) {
+      present.emplace_back(pubkeys.at(i));
+    }
+  }
+  MultiSig::AggregatePubKeys(present);
+  const double rebuild_time = r_timer_end(t);
+
+  t = r_timer_start();
+  committee.AggregatePubKeys(signers);
+  const double bitmap_time = r_timer_end(t);
+
+  cout << "Committee members          = " << nbmembers << endl;
+  cout << "AggregatePubKeys (usec)    = " << rebuild_time << endl;
+  cout << "CommitteeKeySet (usec)     = " << bitmap_time << endl;
+}
+#endif
+
+/**
+ * \brief test_partial_aggregate
+ *
+ * \details Test the merge and serialization of partial aggregates along a
+ * multi-level aggregation tree
+ */
+BOOST_AUTO_TEST_CASE(test_partial_aggregate) {
+  const unsigned int nbmembers = 64;
+  const unsigned int fanout = 4;
+  vector<PrivKey> privkeys;
+  vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    PairOfKey keypair = Schnorr::GenKeyPair();
+    privkeys.emplace_back(keypair.first);
+    pubkeys.emplace_back(keypair.second);
+  }
+  vector<CommitSecret> secrets(nbmembers);
+  vector<CommitPoint> points;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    points.emplace_back(secrets.at(i));
+  }
+
+  /// Merges the partials of each level in groups of fanout, sending every
+  /// merged partial over the wire, until one is left
+  const unsigned int wire_size = PartialAggregate::SerializedSize(nbmembers);
+  auto merge_tree = [&](vector<PartialAggregate> level) {
+    while (level.size() > 1) {
+      vector<PartialAggregate> next;
+      for (unsigned int i = 0; i < level.size(); i += fanout) {
+        const unsigned int end = min(i + fanout, (unsigned int)level.size());
+        PartialAggregate merged(level.at(i));
+        for (unsigned int j = i + 1; j < end; j++) {
+          BOOST_CHECK_MESSAGE(merged.Merge(level.at(j)), "Merge failed");
+        }
+
+        std::vector<uint8_t> wire;
+        BOOST_CHECK_MESSAGE(merged.Serialize(wire, 0), "Serialize failed");
+        BOOST_CHECK_MESSAGE(wire.size() == wire_size, "Wire size changed");
+        next.emplace_back(wire, 0);
+        BOOST_CHECK_MESSAGE(next.back() == merged, "Deserialize mismatch");
+      }
+      level = next;
+    }
+    return level.at(0);
+  };
+
+  /// Commit phase: the root holds the aggregates of the whole committee
+  vector<PartialAggregate> commits;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    commits.emplace_back(nbmembers, i, pubkeys.at(i), points.at(i));
+  }
+  const PartialAggregate commit_root = merge_tree(commits);
+  BOOST_CHECK_MESSAGE(commit_root.GetSignerCount() == nbmembers,
+                      "Signer count mismatch");
+  BOOST_CHECK_MESSAGE(!commit_root.HasResponse(), "Unexpected response");
+  BOOST_CHECK_MESSAGE(
+      commit_root.GetCommit() == *MultiSig::AggregateCommits(points),
+      "Aggregated commit mismatch");
+  BOOST_CHECK_MESSAGE(
+      commit_root.GetPubKey() == *MultiSig::AggregatePubKeys(pubkeys),
+      "Aggregated PubKey mismatch");
+
+  /// Response phase: the root yields a valid multisignature
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+  Challenge challenge(commit_root.GetCommit(), commit_root.GetPubKey(),
+                      message);
+  vector<Response> responses;
+  vector<PartialAggregate> contributions;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    responses.emplace_back(secrets.at(i), challenge, privkeys.at(i));
+    contributions.emplace_back(nbmembers, i, pubkeys.at(i), points.at(i),
+                               responses.at(i));
+  }
+  const PartialAggregate root = merge_tree(contributions);
+  BOOST_CHECK_MESSAGE(root.HasResponse(), "Missing response");
+  BOOST_CHECK_MESSAGE(
+      root.GetResponse() == *MultiSig::AggregateResponses(responses),
+      "Aggregated response mismatch");
+  BOOST_CHECK_MESSAGE(
+      MultiSig::VerifyResponse(root.GetResponse(), challenge,
+                               root.GetPubKey(), root.GetCommit()),
+      "Aggregated response verification failed");
+  shared_ptr<Signature> signature =
+      MultiSig::AggregateSign(challenge, root.GetResponse());
+  BOOST_CHECK_MESSAGE(
+      MultiSig::MultiSigVerify(message, *signature, root.GetPubKey()),
+      "Multisignature verification failed");
+
+  /// A subset of signers matches the committee registry
+  PartialAggregate subset(contributions.at(3));
+  for (unsigned int i : {5, 17, 40, 63}) {
+    BOOST_CHECK_MESSAGE(subset.Merge(contributions.at(i)), "Merge failed");
+  }
+#ifdef SCHNORR_NATIVE_SECP256K1
+  BOOST_CHECK_MESSAGE(
+      subset.GetPubKey() ==
+          *CommitteeKeySet(pubkeys).AggregatePubKeys(subset.GetSigners()),
+      "Subset PubKey mismatch");
+#endif
+
+  /// Overlapping signers, other committees, mixed phases and uninitialized
+  /// partials are not merged
+  const PartialAggregate before(subset);
+  BOOST_CHECK_MESSAGE(!subset.Merge(contributions.at(17)),
+                      "Merge passed with a repeated signer");
+  BOOST_CHECK_MESSAGE(
+      !subset.Merge(PartialAggregate(nbmembers + 1, 0, pubkeys.at(0),
+                                     points.at(0), responses.at(0))),
+      "Merge passed with another committee size");
+  BOOST_CHECK_MESSAGE(!subset.Merge(commits.at(0)),
+                      "Merge passed with a commit phase partial");
+  BOOST_CHECK_MESSAGE(!subset.Merge(PartialAggregate()),
+                      "Merge passed with an uninitialized partial");
+  BOOST_CHECK_MESSAGE(subset == before, "Failed merge changed the partial");
+  BOOST_CHECK_MESSAGE(
+      !PartialAggregate(nbmembers, nbmembers, pubkeys.at(0), points.at(0))
+           .Initialized(),
+      "Partial initialized with a signer beyond the committee");
+
+  /// Truncated streams and set padding bits are rejected
+  std::vector<uint8_t> wire;
+  PartialAggregate odd(nbmembers - 3, 0, pubkeys.at(0), points.at(0));
+  BOOST_CHECK_MESSAGE(odd.Serialize(wire, 0), "Serialize failed");
+  BOOST_CHECK_MESSAGE(PartialAggregate(wire, 0) == odd, "Deserialize failed");
+  BOOST_CHECK_MESSAGE(
+      !PartialAggregate(std::vector<uint8_t>(wire.begin(), wire.end() - 1), 0)
+           .Initialized(),
+      "Deserialize passed with a truncated stream");
+  wire.at(4 + (nbmembers - 3) / 8) |= 0x01;
+  BOOST_CHECK_MESSAGE(!PartialAggregate(wire, 0).Initialized(),
+                      "Deserialize passed with padding bits set");
+}
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+/**
+ * \brief test_commit_nonce_pool
+ *
+ * \details Test a multisignature round with commitments taken from a
+ * NoncePool
+ */
+BOOST_AUTO_TEST_CASE(test_commit_nonce_pool) {
+  const unsigned int nbsigners = 32;
+  vector<PrivKey> privkeys;
+  vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    PairOfKey keypair = Schnorr::GenKeyPair();
+    privkeys.emplace_back(keypair.first);
+    pubkeys.emplace_back(keypair.second);
+  }
+
+  NoncePool pool(nbsigners);
+  BOOST_REQUIRE(pool.WaitUntilFull(std::chrono::seconds(30)));
+
+  /// The taken commit point and hash match the secret
+  vector<CommitSecret> secrets;
+  vector<CommitPoint> points(nbsigners);
+  vector<CommitPointHash> hashes(nbsigners);
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    secrets.emplace_back(pool, points.at(i), hashes.at(i));
+  }
+  const double pooled = r_timer_end(t) / nbsigners;
+
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    BOOST_CHECK_MESSAGE(secrets.at(i).Initialized(), "Secret not taken");
+    BOOST_CHECK_MESSAGE(points.at(i) == CommitPoint(secrets.at(i)),
+                        "Commit point mismatch");
+    BOOST_CHECK_MESSAGE(hashes.at(i) == CommitPointHash(points.at(i)),
+                        "Commit point hash mismatch");
+    for (unsigned int j = 0; j < i; j++) {
+      BOOST_CHECK_MESSAGE(!(secrets.at(i) == secrets.at(j)),
+                          "Nonce used twice");
+    }
+  }
+
+  /// The round completes as usual
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+  shared_ptr<PubKey> aggregated_pubkey = MultiSig::AggregatePubKeys(pubkeys);
+  Challenge challenge(*MultiSig::AggregateCommits(points), *aggregated_pubkey,
+                      message);
+  vector<Response> responses;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    responses.emplace_back(secrets.at(i), challenge, privkeys.at(i));
+  }
+  BOOST_CHECK_MESSAGE(
+      MultiSig::VerifyResponses(responses, challenge, pubkeys, points),
+      "Response verification failed");
+  shared_ptr<Signature> signature = MultiSig::AggregateSign(
+      challenge, *MultiSig::AggregateResponses(responses));
+  BOOST_CHECK_MESSAGE(
+      MultiSig::MultiSigVerify(message, *signature, *aggregated_pubkey),
+      "Multisignature verification failed");
+
+  t = r_timer_start();
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    CommitSecret secret;
+    CommitPoint point(secret);
+    CommitPointHash hash(point);
+  }
+  const double inline_commit = r_timer_end(t) / nbsigners;
+
+  cout << "Commit inline (usec)        = " << inline_commit << endl;
+  cout << "Commit from NoncePool (usec)= " << pooled << endl;
+}
+
+/**
+ * \brief test_compact_round
+ *
+ * \details Test aggregation and verification from a CompactRound against the
+ * per-object round state, and compare their memory use
+ */
+BOOST_AUTO_TEST_CASE(test_compact_round) {
+  const unsigned int nbmembers = 10000;
+  vector<PrivKey> privkeys;
+  vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    PairOfKey keypair = Schnorr::GenKeyPair();
+    privkeys.emplace_back(keypair.first);
+    pubkeys.emplace_back(keypair.second);
+  }
+  vector<CommitSecret> secrets(nbmembers);
+  std::vector<uint8_t> wire_points(nbmembers * 33);
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    CommitPoint(secrets.at(i)).Serialize(wire_points, i * 33);
+  }
+  const CommitteeKeySet committee(pubkeys);
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+
+  /// Commit phase, as received from the wire
+  size_t heap = heap_in_use();
+  vector<CommitPoint> points;
+  vector<CommitPointHash> hashes;
+  vector<PubKey> round_pubkeys(pubkeys);
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    points.emplace_back(wire_points, i * 33);
+    hashes.emplace_back(points.back());
+  }
+  const size_t vector_commit_heap = heap_in_use() - heap;
+
+  heap = heap_in_use();
+  vector<unsigned int> indices(nbmembers);
+  iota(indices.begin(), indices.end(), 0);
+  CompactRound round(committee, indices);
+  BOOST_REQUIRE(round.Initialized());
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    const CommitPoint point(wire_points, i * 33);
+    round.SetCommitPointHash(i, CommitPointHash(point));
+    round.SetCommitPoint(i, point);
+  }
+  const size_t compact_commit_heap = heap_in_use() - heap;
+
+  bool hashes_match = true;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    hashes_match = hashes_match && round.CheckCommitPointHash(i);
+  }
+  BOOST_CHECK_MESSAGE(hashes_match, "Commit point hash mismatch");
+
+  auto t = r_timer_start();
+  shared_ptr<CommitPoint> aggregated_commit =
+      MultiSig::AggregateCommits(points);
+  const double vector_aggregate_time = r_timer_end(t);
+  t = r_timer_start();
+  shared_ptr<CommitPoint> compact_commit = MultiSig::AggregateCommits(round);
+  const double compact_aggregate_time = r_timer_end(t);
+  BOOST_CHECK_MESSAGE(*compact_commit == *aggregated_commit,
+                      "Aggregated commit mismatch");
+  shared_ptr<PubKey> aggregated_pubkey = MultiSig::AggregatePubKeys(round);
+  BOOST_CHECK_MESSAGE(
+      *aggregated_pubkey == *MultiSig::AggregatePubKeys(pubkeys),
+      "Aggregated PubKey mismatch");
+
+  /// Response phase
+  const Challenge challenge(*aggregated_commit, *aggregated_pubkey, message);
+  heap = heap_in_use();
+  vector<Response> responses;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    responses.emplace_back(secrets.at(i), challenge, privkeys.at(i));
+  }
+  const size_t vector_response_heap = heap_in_use() - heap;
+
+  heap = heap_in_use();
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    round.SetResponse(i, responses.at(i));
+  }
+  const size_t compact_response_heap = heap_in_use() - heap;
+
+  t = r_timer_start();
+  BOOST_CHECK_MESSAGE(
+      MultiSig::VerifyResponses(responses, challenge, round_pubkeys, points),
+      "Response verification failed");
+  const double vector_verify_time = r_timer_end(t);
+  t = r_timer_start();
+  BOOST_CHECK_MESSAGE(MultiSig::VerifyResponses(round, challenge),
+                      "Compact response verification failed");
+  const double compact_verify_time = r_timer_end(t);
+
+  shared_ptr<Response> aggregated_response =
+      MultiSig::AggregateResponses(round);
+  BOOST_CHECK_MESSAGE(
+      *aggregated_response == *MultiSig::AggregateResponses(responses),
+      "Aggregated response mismatch");
+  shared_ptr<Signature> signature =
+      MultiSig::AggregateSign(challenge, *aggregated_response);
+  BOOST_CHECK_MESSAGE(
+      MultiSig::MultiSigVerify(message, *signature, *aggregated_pubkey),
+      "Multisignature verification failed");
+
+  /// Faulty responses are found by slot
+  round.SetResponse(123, responses.at(124));
+  round.SetResponse(4567, responses.at(4568));
+  BOOST_CHECK_MESSAGE(!MultiSig::VerifyResponses(round, challenge),
+                      "Verification passed with faulty responses");
+  vector<unsigned int> faulty;
+  BOOST_CHECK_MESSAGE(MultiSig::FindFaultyResponses(round, challenge, faulty),
+                      "FindFaultyResponses failed");
+  BOOST_CHECK_MESSAGE(faulty == vector<unsigned int>({123, 4567}),
+                      "Faulty slots mismatch");
+
+  /// A subset of the committee, and invalid or incomplete rounds
+  CompactRound subset(committee, {7, 3, 9999});
+  BOOST_REQUIRE(subset.Initialized());
+  BOOST_CHECK_MESSAGE(
+      subset.GetKeyIndex(1) == 3 && subset.GetSigners().at(9999),
+      "Subset signers mismatch");
+  BOOST_CHECK_MESSAGE(
+      *MultiSig::AggregatePubKeys(subset) ==
+          *MultiSig::AggregatePubKeys(
+              {pubkeys.at(7), pubkeys.at(3), pubkeys.at(9999)}),
+      "Subset aggregated PubKey mismatch");
+  BOOST_CHECK_MESSAGE(MultiSig::AggregateCommits(subset) == nullptr,
+                      "Aggregation passed without commit points");
+  BOOST_CHECK_MESSAGE(!subset.CheckCommitPointHash(0),
+                      "Hash check passed without a commit point");
+  BOOST_CHECK_MESSAGE(!subset.SetResponse(3, responses.at(0)),
+                      "Response stored beyond the round");
+  BOOST_CHECK_MESSAGE(!CompactRound(committee, {1, 2, 1}).Initialized(),
+                      "Round initialized with a repeated key");
+  BOOST_CHECK_MESSAGE(!CompactRound(committee, {nbmembers}).Initialized(),
+                      "Round initialized with a key beyond the committee");
+
+  cout << "Round signers                  = " << nbmembers << endl;
+  cout << "Vector round heap (bytes)      = "
+       << vector_commit_heap + vector_response_heap << endl;
+  cout << "CompactRound heap (bytes)      = "
+       << compact_commit_heap + compact_response_heap << endl;
+  cout << "Vector AggregateCommits (usec) = " << vector_aggregate_time << endl;
+  cout << "Compact AggregateCommits (usec)= " << compact_aggregate_time << endl;
+  cout << "Vector VerifyResponses (usec)  = " << vector_verify_time << endl;
+  cout << "Compact VerifyResponses (usec) = " << compact_verify_time << endl;
+}
+
+/**
+ * \brief test_multisig_round
+ *
+ * \details Test a streaming round with invalid commits and responses checked
+ * in the background
+ */
+BOOST_AUTO_TEST_CASE(test_multisig_round) {
+  const unsigned int nbmembers = 200;
+  const unsigned int quorum = 150;
+  const unsigned int nbbadcommits = 10;
+  const unsigned int nblate = 10;
+  vector<PrivKey> privkeys;
+  vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    PairOfKey keypair = Schnorr::GenKeyPair();
+    privkeys.emplace_back(keypair.first);
+    pubkeys.emplace_back(keypair.second);
+  }
+  vector<CommitSecret> secrets(nbmembers);
+  vector<CommitPoint> points;
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    points.emplace_back(secrets.at(i));
+  }
+  const CommitteeKeySet committee(pubkeys);
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+
+  Schnorr::SetBatchThreads(3);
+
+  /// Commit phase: the first members send a hash of another point, and the
+  /// last ones only come after the quorum is reached. The checks may reach
+  /// the quorum before all commits are sent, so later ones can be refused
+  MultiSigRound round(committee, message, quorum);
+  BOOST_REQUIRE(round.Initialized());
+  const Challenge early(points.at(0), pubkeys.at(0), message);
+  BOOST_CHECK_MESSAGE(
+      !round.AddResponse(0, Response(secrets.at(0), early, privkeys.at(0))),
+      "Response accepted before the challenge");
+  for (unsigned int i = 0; i < nbmembers - nblate; i++) {
+    const CommitPointHash hash(points.at(i < nbbadcommits ? i + 1 : i));
+    round.AddCommit(i, points.at(i), hash);
+  }
+  BOOST_CHECK_MESSAGE(
+      !round.AddCommit(0, points.at(0), CommitPointHash(points.at(0))),
+      "Repeated commit accepted");
+  BOOST_CHECK_MESSAGE(!round.AddCommit(nbmembers, points.at(0),
+                                       CommitPointHash(points.at(0))),
+                      "Commit accepted beyond the committee");
+
+  shared_ptr<Challenge> challenge =
+      round.WaitForChallenge(std::chrono::seconds(30));
+  BOOST_REQUIRE(challenge != nullptr);
+  const vector<bool> signers = round.GetSigners();
+  BOOST_CHECK_MESSAGE(count(signers.begin(), signers.end(), true) == quorum,
+                      "Signer count mismatch");
+  BOOST_CHECK_MESSAGE(
+      *round.GetAggregatedPubKey() == *committee.AggregatePubKeys(signers),
+      "Aggregated PubKey mismatch");
+  const unsigned int late = nbmembers - 1;
+  BOOST_CHECK_MESSAGE(!round.AddCommit(late, points.at(late),
+                                       CommitPointHash(points.at(late))),
+                      "Commit accepted after the challenge");
+
+  /// Response phase: the signature is ready once every signer responded
+  for (unsigned int i = 0; i < nbmembers; i++) {
+    const Response response(secrets.at(i), *challenge, privkeys.at(i));
+    BOOST_CHECK_MESSAGE(round.AddResponse(i, response) == signers.at(i),
+                        "Response acceptance mismatch for " << i);
+  }
+  shared_ptr<Signature> signature =
+      round.WaitForSignature(std::chrono::seconds(30));
+  BOOST_REQUIRE(signature != nullptr);
+  BOOST_CHECK_MESSAGE(
+      MultiSig::MultiSigVerify(message, *signature,
+                               *round.GetAggregatedPubKey()),
+      "Multisignature verification failed");
+
+  vector<unsigned int> faulty = round.GetFaulty();
+  sort(faulty.begin(), faulty.end());
+  BOOST_CHECK_MESSAGE(faulty.size() == nbbadcommits, "Faulty count mismatch");
+  for (unsigned int i = 0; i < faulty.size(); i++) {
+    BOOST_CHECK_MESSAGE(faulty.at(i) == i, "Faulty commit not reported");
+  }
+
+  /// A signer responding with the wrong key stops the round
+  MultiSigRound failing(committee, message, 5);
+  for (unsigned int i = 0; i < 5; i++) {
+    failing.AddCommit(i, points.at(i), CommitPointHash(points.at(i)));
+  }
+  challenge = failing.WaitForChallenge(std::chrono::seconds(30));
+  BOOST_REQUIRE(challenge != nullptr);
+  for (unsigned int i = 0; i < 5; i++) {
+    failing.AddResponse(
+        i, Response(secrets.at(i), *challenge, privkeys.at(i == 2 ? 3 : i)));
+  }
+  BOOST_CHECK_MESSAGE(
+      failing.WaitForSignature(std::chrono::seconds(30)) == nullptr,
+      "Signature produced with an invalid response");
+  BOOST_CHECK_MESSAGE(failing.GetFaulty() == vector<unsigned int>{2},
+                      "Faulty response not reported");
+
+  /// A round over a buffer that is not a vector signs the same message
+  unique_ptr<uint8_t[]> buffer(new uint8_t[message.size()]);
+  copy(message.begin(), message.end(), buffer.get());
+  MultiSigRound buffered(committee, buffer.get(), message.size(), 5);
+  for (unsigned int i = 0; i < 5; i++) {
+    buffered.AddCommit(i, points.at(i), CommitPointHash(points.at(i)));
+  }
+  challenge = buffered.WaitForChallenge(std::chrono::seconds(30));
+  BOOST_REQUIRE(challenge != nullptr);
+  const vector<CommitPoint> first_points(points.begin(), points.begin() + 5);
+  const Challenge expected(*MultiSig::AggregateCommits(first_points),
+                           *buffered.GetAggregatedPubKey(), message);
+  BOOST_CHECK_MESSAGE(*challenge == expected,
+                      "Challenge mismatch for a round over a buffer");
+
+  BOOST_CHECK_MESSAGE(!MultiSigRound(committee, message, 0).Initialized(),
+                      "Round initialized with a zero quorum");
+  BOOST_CHECK_MESSAGE(
+      !MultiSigRound(committee, message, nbmembers + 1).Initialized(),
+      "Round initialized with a quorum beyond the committee");
+
+  Schnorr::SetBatchThreads(0);
+}
+#endif
+
 /**
  * \brief test_serialization
  *
@@ -202,6 +1050,11 @@ BOOST_AUTO_TEST_CASE(test_serialization) {
         MultiSig::VerifyResponse(responses.at(i), challenge, pubkeys.at(i),
                                  points.at(i)) == true,
         "Verify response failed");
+    // Verify response against another signer's commit point
+    BOOST_CHECK_MESSAGE(
+        MultiSig::VerifyResponse(responses.at(i), challenge, pubkeys.at(i),
+                                 points.at((i + 1) % nbsigners)) == false,
+        "Verify response with wrong commit point passed");
   }
 
   /// Aggregate responses
@@ -228,4 +1081,300 @@ BOOST_AUTO_TEST_CASE(test_serialization) {
                       "Signature verification (wrong message) failed");
 }
 
+/**
+ * \brief test_pointer_input
+ *
+ * \details Test the challenge, verification and deserialization from a
+ * pointer and a size
+ */
+BOOST_AUTO_TEST_CASE(test_pointer_input) {
+  const unsigned int nbsigners = 4;
+  vector<PairOfKey> keypairs;
+  vector<PubKey> pubkeys;
+  vector<CommitSecret> secrets(nbsigners);
+  vector<CommitPoint> points;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    keypairs.emplace_back(Schnorr::GenKeyPair());
+    pubkeys.emplace_back(keypairs.back().second);
+    points.emplace_back(secrets.at(i));
+  }
+  shared_ptr<PubKey> aggregatedPubkey = MultiSig::AggregatePubKeys(pubkeys);
+  shared_ptr<CommitPoint> aggregatedCommit = MultiSig::AggregateCommits(points);
+  BOOST_REQUIRE((aggregatedPubkey != nullptr) && (aggregatedCommit != nullptr));
+
+  /// The message sits in the middle of a larger buffer
+  std::vector<uint8_t> buffer(4096);
+  generate(buffer.begin(), buffer.end(), std::rand);
+  const uint8_t* message = buffer.data() + 100;
+  const size_t size = 2000;
+
+  Challenge challenge(*aggregatedCommit, *aggregatedPubkey, message, size);
+  BOOST_CHECK_MESSAGE(
+      challenge ==
+          Challenge(*aggregatedCommit, *aggregatedPubkey, buffer, 100, size),
+      "Challenge mismatch");
+  BOOST_CHECK_MESSAGE(
+      !Challenge(*aggregatedCommit, *aggregatedPubkey, message, 0)
+           .Initialized(),
+      "Challenge (empty message) failed");
+
+  vector<Response> responses;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    responses.emplace_back(secrets.at(i), challenge, keypairs.at(i).first);
+  }
+  shared_ptr<Response> aggregatedResponse =
+      MultiSig::AggregateResponses(responses);
+  BOOST_REQUIRE(aggregatedResponse != nullptr);
+  shared_ptr<Signature> signature =
+      MultiSig::AggregateSign(challenge, *aggregatedResponse);
+  BOOST_REQUIRE(signature != nullptr);
+
+  BOOST_CHECK_MESSAGE(
+      MultiSig::MultiSigVerify(message, size, *signature, *aggregatedPubkey),
+      "Verification (PubKey) failed");
+#ifdef SCHNORR_NATIVE_SECP256K1
+  BOOST_CHECK_MESSAGE(
+      MultiSig::MultiSigVerify(message, size, *signature,
+                               VerifyingKey(*aggregatedPubkey)),
+      "Verification (VerifyingKey) failed");
+#endif
+  BOOST_CHECK_MESSAGE(!MultiSig::MultiSigVerify(message + 1, size, *signature,
+                                                *aggregatedPubkey),
+                      "Verification (wrong message) failed");
+
+  /// Every type reads back from a raw buffer, and rejects a short one
+  std::vector<uint8_t> serialized;
+  points.at(0).Serialize(serialized, 0);
+  challenge.Serialize(serialized, serialized.size());
+  responses.at(0).Serialize(serialized, serialized.size());
+  PartialAggregate partial(nbsigners, 2, pubkeys.at(2), points.at(2));
+  partial.Serialize(serialized, serialized.size());
+
+  const uint8_t* pos = serialized.data();
+  const uint8_t* end = serialized.data() + serialized.size();
+  CommitPoint point;
+  Challenge challenge2;
+  Response response;
+  PartialAggregate partial2;
+  BOOST_CHECK_MESSAGE(point.Deserialize(pos, end - pos) &&
+                          (point == points.at(0)),
+                      "CommitPoint deserialization failed");
+  pos += 33;
+  BOOST_CHECK_MESSAGE(challenge2.Deserialize(pos, end - pos) &&
+                          (challenge2 == challenge),
+                      "Challenge deserialization failed");
+  pos += 32;
+  BOOST_CHECK_MESSAGE(response.Deserialize(pos, end - pos) &&
+                          (response == responses.at(0)),
+                      "Response deserialization failed");
+  pos += 32;
+  BOOST_CHECK_MESSAGE(partial2.Deserialize(pos, end - pos) &&
+                          (partial2 == partial),
+                      "PartialAggregate deserialization failed");
+  BOOST_CHECK_MESSAGE(!partial2.Deserialize(pos, end - pos - 1),
+                      "PartialAggregate deserialization (short) failed");
+  BOOST_CHECK_MESSAGE(!response.Deserialize(end - 31, 31),
+                      "Response deserialization (short) failed");
+}
+
+/**
+ * \brief test_fixed_size_serialization
+ *
+ * \details Test serialization of the multisig types into fixed-size buffers
+ */
+BOOST_AUTO_TEST_CASE(test_fixed_size_serialization) {
+  PairOfKey keypair = Schnorr::GenKeyPair();
+  CommitSecret secret;
+  CommitPoint point(secret);
+  CommitPointHash hash(point);
+  std::vector<uint8_t> message(256);
+  generate(message.begin(), message.end(), std::rand);
+  Challenge challenge(point, keypair.second, message);
+  Response response(secret, challenge, keypair.first);
+
+  CommitSecret::Serialized secret_bytes;
+  CommitPoint::Serialized point_bytes;
+  CommitPointHash::Serialized hash_bytes;
+  Challenge::Serialized challenge_bytes;
+  Response::Serialized response_bytes;
+  BOOST_REQUIRE(secret.Serialize(secret_bytes));
+  BOOST_REQUIRE(point.Serialize(point_bytes));
+  BOOST_REQUIRE(hash.Serialize(hash_bytes));
+  BOOST_REQUIRE(challenge.Serialize(challenge_bytes));
+  BOOST_REQUIRE(response.Serialize(response_bytes));
+
+  /// Objects loaded from a byte stream are decoded into again in place
+  std::vector<uint8_t> other(33, 0x00);
+  CommitSecret secret1(other, 0);
+  CommitPoint point1(other, 0);
+  CommitPointHash hash1(other, 0);
+  Challenge challenge1(other, 0);
+  Response response1(other, 0);
+  BOOST_CHECK(secret1.Deserialize(secret_bytes) && secret1 == secret);
+  BOOST_CHECK(point1.Deserialize(point_bytes) && point1 == point);
+  BOOST_CHECK(hash1.Deserialize(hash_bytes) && hash1 == hash);
+  BOOST_CHECK(challenge1.Deserialize(challenge_bytes) &&
+              challenge1 == challenge);
+  BOOST_CHECK(response1.Deserialize(response_bytes) && response1 == response);
+  BOOST_CHECK(MultiSig::VerifyResponse(response1, challenge1, keypair.second,
+                                       point1));
+
+  /// Uninitialized objects have nothing to serialize
+  BOOST_CHECK(!CommitPoint().Serialize(point_bytes));
+  BOOST_CHECK(!Response().Serialize(response_bytes));
+}
+
+/**
+ * \brief test_parallel_deserialization
+ *
+ * \details Test decoding committee keys and commits from many threads
+ */
+BOOST_AUTO_TEST_CASE(test_parallel_deserialization) {
+  const unsigned int nbsigners = 4096;
+  const unsigned int max_threads =
+      max(thread::hardware_concurrency(), (unsigned int)1);
+
+  /// Serialize one public key and one commitment point per signer
+  vector<PubKey> pubkeys;
+  vector<CommitPoint> points;
+  vector<std::vector<uint8_t>> pubkey_bytes(nbsigners);
+  vector<std::vector<uint8_t>> point_bytes(nbsigners);
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    pubkeys.emplace_back(Schnorr::GenKeyPair().second);
+    pubkeys.back().Serialize(pubkey_bytes[i], 0);
+    points.emplace_back(CommitSecret());
+    points.back().Serialize(point_bytes[i], 0);
+  }
+
+  /// Decode with 1, 2, 4, ... threads up to the number of cores
+  for (unsigned int num_threads = 1;; num_threads *= 2) {
+    num_threads = min(num_threads, max_threads);
+
+    vector<PubKey> pubkeys1(nbsigners);
+    vector<CommitPoint> points1(nbsigners);
+    atomic<unsigned int> failures(0);
+    vector<thread> decoders;
+    auto t = r_timer_start();
+    for (unsigned int n = 0; n < num_threads; n++) {
+      decoders.emplace_back([&, n]() {
+        for (unsigned int i = n; i < nbsigners; i += num_threads) {
+          if (!pubkeys1[i].Deserialize(pubkey_bytes[i], 0) ||
+              !points1[i].Deserialize(point_bytes[i], 0)) {
+            failures++;
+          }
+        }
+      });
+    }
+    for (auto& decoder : decoders) {
+      decoder.join();
+    }
+    const double elapsed = r_timer_end(t);
+
+    BOOST_CHECK_MESSAGE(failures == 0, "Parallel deserialization failed");
+    BOOST_CHECK_MESSAGE(pubkeys1 == pubkeys, "PubKey mismatch after decoding");
+    BOOST_CHECK_MESSAGE(points1 == points,
+                        "CommitPoint mismatch after decoding");
+
+    cout << "Threads                      = " << num_threads << endl;
+    cout << "Decode " << nbsigners
+         << " keys+commits (usec) = " << elapsed << endl;
+
+    if (num_threads == max_threads) {
+      break;
+    }
+  }
+
+  /// The point at infinity round-trips through an all-zero field
+  PubKey infinity;
+  PubKey infinity1(pubkeys.at(0));
+  std::vector<uint8_t> infinity_bytes;
+  infinity.Serialize(infinity_bytes, 0);
+  BOOST_CHECK(infinity_bytes == std::vector<uint8_t>(33, 0x00));
+  BOOST_CHECK(infinity1.Deserialize(infinity_bytes, 0) == true);
+  BOOST_CHECK(infinity1 == infinity);
+}
+
+/**
+ * \brief test_bulk_serialization
+ *
+ * \details Test serializing and decoding committee keys and commits as
+ * contiguous lists of records
+ */
+BOOST_AUTO_TEST_CASE(test_bulk_serialization) {
+  const unsigned int nbsigners = 10000;
+
+  vector<PubKey> pubkeys;
+  vector<CommitPoint> points;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    pubkeys.emplace_back(Schnorr::GenKeyPair().second);
+    points.emplace_back(CommitSecret());
+  }
+  pubkeys.at(7) = PubKey();
+
+  /// Same records as serializing one object at a time
+  Schnorr::SetBatchThreads(3);
+  std::vector<uint8_t> pubkey_bytes, point_bytes;
+  BOOST_REQUIRE(PubKey::SerializeAll(pubkeys, pubkey_bytes));
+  BOOST_REQUIRE(CommitPoint::SerializeAll(points, point_bytes));
+  std::vector<uint8_t> expected_pubkey_bytes, expected_point_bytes;
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    pubkeys.at(i).Serialize(expected_pubkey_bytes, i * 33);
+    points.at(i).Serialize(expected_point_bytes, i * 33);
+  }
+  BOOST_CHECK(pubkey_bytes == expected_pubkey_bytes);
+  BOOST_CHECK(point_bytes == expected_point_bytes);
+
+  /// Decoded into empty lists, then into the same lists again in place
+  vector<PubKey> pubkeys1;
+  vector<CommitPoint> points1;
+  BOOST_CHECK(PubKey::DeserializeAll(pubkey_bytes, pubkeys1));
+  BOOST_CHECK(CommitPoint::DeserializeAll(point_bytes, points1));
+  BOOST_CHECK(pubkeys1 == pubkeys);
+  BOOST_CHECK(points1 == points);
+  BOOST_CHECK(PubKey::DeserializeAll(pubkey_bytes.data(), 33 * 10, pubkeys1));
+  BOOST_CHECK(pubkeys1.size() == 10);
+  BOOST_CHECK(equal(pubkeys1.begin(), pubkeys1.end(), pubkeys.begin()));
+
+  /// Partial records, points not on the curve and uninitialized points fail
+  BOOST_CHECK(!PubKey::DeserializeAll(pubkey_bytes.data(), 33 * 10 + 1,
+                                      pubkeys1));
+  std::vector<uint8_t> bad_bytes(point_bytes);
+  fill(bad_bytes.begin() + 33 * 5000 + 1, bad_bytes.begin() + 33 * 5001, 0xFF);
+  BOOST_CHECK(!CommitPoint::DeserializeAll(bad_bytes, points1));
+  vector<CommitPoint> uninitialized(2);
+  uninitialized.at(0) = points.at(0);
+  BOOST_CHECK(!CommitPoint::SerializeAll(uninitialized, bad_bytes));
+  Schnorr::SetBatchThreads(0);
+
+  /// Compare the latency with decoding one object at a time
+  vector<PubKey> pubkeys2(nbsigners);
+  vector<CommitPoint> points2(nbsigners);
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < nbsigners; i++) {
+    pubkeys2[i].Deserialize(pubkey_bytes, i * 33);
+    points2[i].Deserialize(point_bytes, i * 33);
+  }
+  const double single = r_timer_end(t);
+
+  pubkeys2.clear();
+  points2.clear();
+  t = r_timer_start();
+  BOOST_CHECK(PubKey::DeserializeAll(pubkey_bytes, pubkeys2));
+  BOOST_CHECK(CommitPoint::DeserializeAll(point_bytes, points2));
+  const double bulk = r_timer_end(t);
+
+  t = r_timer_start();
+  BOOST_CHECK(PubKey::DeserializeAll(pubkey_bytes, pubkeys2));
+  BOOST_CHECK(CommitPoint::DeserializeAll(point_bytes, points2));
+  const double in_place = r_timer_end(t);
+  BOOST_CHECK(pubkeys2 == pubkeys && points2 == points);
+
+  cout << "Batch threads                      = "
+       << Schnorr::GetBatchThreads() << endl;
+  cout << "Decode " << nbsigners
+       << " keys+commits one by one (usec) = " << single << endl;
+  cout << "DeserializeAll (usec)              = " << bulk << endl;
+  cout << "DeserializeAll in place (usec)     = " << in_place << endl;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
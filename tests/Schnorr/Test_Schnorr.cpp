@@ -15,11 +15,20 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstring>
 #include <iostream>
+#include <thread>
 #include "libSchnorr/include/Schnorr.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #define BOOST_TEST_MODULE schnorrtest
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/output_test_stream.hpp>
@@ -35,6 +44,44 @@ double r_timer_end(system_clock::time_point start_time) {
   return difference.count();
 }
 
+// Heap allocations of the calling thread are counted by wrapping the glibc
+// allocator. Sanitizer builds replace the allocator themselves.
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#define SCHNORR_TEST_SANITIZED
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define SCHNORR_TEST_SANITIZED
+#endif
+
+#if defined(__GLIBC__) && !defined(SCHNORR_TEST_SANITIZED)
+#define SCHNORR_TEST_COUNT_ALLOCATIONS
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+static thread_local size_t thread_allocations = 0;
+
+void* malloc(size_t size) {
+  thread_allocations++;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+  thread_allocations++;
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  thread_allocations++;
+  return __libc_realloc(ptr, size);
+}
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE(schnorrtest)
 
 /**
@@ -218,6 +265,827 @@ BOOST_AUTO_TEST_CASE(test_performance) {
   }
 }
 
+/**
+ * \brief test_concurrent_verify
+ *
+ * \details Test verification throughput as the number of threads grows
+ */
+BOOST_AUTO_TEST_CASE(test_concurrent_verify) {
+  const unsigned int num_signatures = 64;
+  const unsigned int verifies_per_thread = 256;
+  const unsigned int max_threads =
+      max(thread::hardware_concurrency(), (unsigned int)1);
+
+  /// 1 kB messages, each signed by its own key
+  vector<std::vector<uint8_t>> messages(num_signatures,
+                                        std::vector<uint8_t>(1024));
+  vector<PairOfKey> keypairs;
+  vector<Signature> signatures(num_signatures);
+  for (unsigned int i = 0; i < num_signatures; i++) {
+    generate(messages[i].begin(), messages[i].end(), std::rand);
+    keypairs.emplace_back(Schnorr::GenKeyPair());
+  }
+
+  /// Sign concurrently (Boost.Test assertions are not thread-safe, so the
+  /// worker threads only count failures)
+  atomic<unsigned int> sign_failures(0);
+  vector<thread> signers;
+  for (unsigned int t = 0; t < max_threads; t++) {
+    signers.emplace_back([&, t]() {
+      for (unsigned int i = t; i < num_signatures; i += max_threads) {
+        if (!Schnorr::Sign(messages[i], keypairs[i].first, keypairs[i].second,
+                           signatures[i])) {
+          sign_failures++;
+        }
+      }
+    });
+  }
+  for (auto& signer : signers) {
+    signer.join();
+  }
+  BOOST_CHECK_MESSAGE(sign_failures == 0, "Concurrent signing failed");
+
+  /// Verify with 1, 2, 4, ... threads up to the number of cores
+  double single_thread_rate = 0;
+  for (unsigned int num_threads = 1;; num_threads *= 2) {
+    num_threads = min(num_threads, max_threads);
+
+    atomic<unsigned int> failures(0);
+    vector<thread> verifiers;
+    auto t = r_timer_start();
+    for (unsigned int n = 0; n < num_threads; n++) {
+      verifiers.emplace_back([&, n]() {
+        for (unsigned int j = 0; j < verifies_per_thread; j++) {
+          const unsigned int i = (n + j) % num_signatures;
+          if (!Schnorr::Verify(messages[i], signatures[i],
+                               keypairs[i].second)) {
+            failures++;
+          }
+        }
+      });
+    }
+    for (auto& verifier : verifiers) {
+      verifier.join();
+    }
+    const double rate = (num_threads * verifies_per_thread) / r_timer_end(t);
+
+    BOOST_CHECK_MESSAGE(failures == 0, "Concurrent verification failed");
+
+    if (num_threads == 1) {
+      single_thread_rate = rate;
+    }
+    cout << "Threads             = " << num_threads << endl;
+    cout << "Verify (per second) = " << rate * 1000000 << endl;
+    cout << "Speedup             = " << rate / single_thread_rate << endl;
+
+    if (num_threads == max_threads) {
+      break;
+    }
+  }
+}
+
+/**
+ * \brief test_verify_batch
+ *
+ * \details Test the per-item results of VerifyBatch and its throughput as
+ * the number of batch threads grows
+ */
+BOOST_AUTO_TEST_CASE(test_verify_batch) {
+  const unsigned int num_signatures = 256;
+  const unsigned int num_keys = 16;
+  const unsigned int max_threads =
+      max(thread::hardware_concurrency(), (unsigned int)1);
+
+  vector<PairOfKey> keypairs;
+  for (unsigned int i = 0; i < num_keys; i++) {
+    keypairs.emplace_back(Schnorr::GenKeyPair());
+  }
+  vector<std::vector<uint8_t>> messages(num_signatures,
+                                        std::vector<uint8_t>(1024));
+  vector<Signature> signatures(num_signatures);
+  vector<VerifyBatchItem> items;
+  for (unsigned int i = 0; i < num_signatures; i++) {
+    generate(messages[i].begin(), messages[i].end(), std::rand);
+    const PairOfKey& keypair = keypairs[i % num_keys];
+    if (i % 2 == 0) {
+      Schnorr::Sign(messages[i], keypair.first, keypair.second, signatures[i]);
+      items.emplace_back(messages[i], signatures[i], keypair.second);
+    } else {
+      Schnorr::Sign(messages[i], 1, 512, keypair.first, keypair.second,
+                    signatures[i]);
+      items.emplace_back(messages[i], 1, 512, signatures[i], keypair.second);
+    }
+  }
+
+  /// Every item passes, with more threads than cores as well
+  Schnorr::SetBatchThreads(3);
+  BOOST_CHECK_MESSAGE(Schnorr::GetBatchThreads() == 3, "Thread count mismatch");
+  vector<bool> valid;
+  BOOST_CHECK_MESSAGE(Schnorr::VerifyBatch(items, valid), "VerifyBatch failed");
+  BOOST_CHECK_MESSAGE(valid == vector<bool>(num_signatures, true),
+                      "VerifyBatch results mismatch");
+
+  /// Bad signatures, keys and ranges are reported at their index
+  vector<bool> expected(num_signatures, true);
+  Signature modified(signatures[5]);
+  BN_add_word(modified.m_s.get(), 1);
+  items[5].signature = &modified;
+  expected[5] = false;
+  items[100].pubkey = &keypairs[(100 + 1) % num_keys].second;
+  expected[100] = false;
+  items[255].size = 511;
+  expected[255] = false;
+  BOOST_CHECK_MESSAGE(!Schnorr::VerifyBatch(items.data(), items.size(), valid),
+                      "VerifyBatch (bad items) failed");
+  BOOST_CHECK_MESSAGE(valid == expected, "VerifyBatch (bad items) mismatch");
+
+  BOOST_CHECK_MESSAGE(!Schnorr::VerifyBatch({}, valid),
+                      "VerifyBatch (empty batch) failed");
+  BOOST_CHECK_MESSAGE(valid.empty(), "VerifyBatch (empty batch) mismatch");
+
+  Schnorr::SetBatchThreads(0);
+  BOOST_CHECK_MESSAGE(Schnorr::GetBatchThreads() == max_threads,
+                      "Default thread count mismatch");
+
+  /// Verify with 1, 2, 4, ... threads up to the number of cores
+  items[5].signature = &signatures[5];
+  items[100].pubkey = &keypairs[100 % num_keys].second;
+  items[255].size = 512;
+  double single_thread_rate = 0;
+  for (unsigned int num_threads = 1;; num_threads *= 2) {
+    num_threads = min(num_threads, max_threads);
+    Schnorr::SetBatchThreads(num_threads);
+
+    auto t = r_timer_start();
+    BOOST_CHECK_MESSAGE(Schnorr::VerifyBatch(items, valid),
+                        "VerifyBatch failed");
+    const double rate = num_signatures / r_timer_end(t);
+
+    if (num_threads == 1) {
+      single_thread_rate = rate;
+    }
+    cout << "Batch threads            = " << num_threads << endl;
+    cout << "VerifyBatch (per second) = " << rate * 1000000 << endl;
+    cout << "Speedup                  = " << rate / single_thread_rate << endl;
+
+    if (num_threads == max_threads) {
+      break;
+    }
+  }
+  Schnorr::SetBatchThreads(0);
+}
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+/**
+ * \brief test_verifying_key
+ *
+ * \details Test verification with a prepared key and its table memory limit
+ */
+BOOST_AUTO_TEST_CASE(test_verifying_key) {
+  const unsigned int num_signatures = 16;
+
+  vector<std::vector<uint8_t>> messages(num_signatures,
+                                        std::vector<uint8_t>(1024));
+  vector<PairOfKey> keypairs;
+  vector<Signature> signatures(num_signatures);
+  for (unsigned int i = 0; i < num_signatures; i++) {
+    generate(messages[i].begin(), messages[i].end(), std::rand);
+    keypairs.emplace_back(Schnorr::GenKeyPair());
+    BOOST_CHECK_MESSAGE(Schnorr::Sign(messages[i], keypairs[i].first,
+                                      keypairs[i].second, signatures[i]),
+                        "Signing failed");
+  }
+
+  /// Every window verifies the same signatures as the plain PubKey
+  for (unsigned int window = VerifyingKey::MIN_WINDOW;
+       window <= VerifyingKey::MAX_WINDOW; window++) {
+    for (unsigned int i = 0; i < num_signatures; i++) {
+      VerifyingKey key(keypairs[i].second, window);
+      const VerifyingKey other(keypairs[(i + 1) % num_signatures].second,
+                               window);
+
+      BOOST_CHECK_MESSAGE(key.GetTableSize() != 0, "Table not built");
+      BOOST_CHECK_MESSAGE(Schnorr::Verify(messages[i], signatures[i], key),
+                          "Verification (correct message) failed");
+      BOOST_CHECK_MESSAGE(
+          !Schnorr::Verify(messages[(i + 1) % num_signatures], signatures[i],
+                           key),
+          "Verification (wrong message) failed");
+      BOOST_CHECK_MESSAGE(!Schnorr::Verify(messages[i], signatures[i], other),
+                          "Verification (wrong key) failed");
+      BOOST_CHECK_MESSAGE(
+          Schnorr::Verify(messages[i], 1, messages[i].size() - 1,
+                          signatures[i], key) ==
+              Schnorr::Verify(messages[i], 1, messages[i].size() - 1,
+                              signatures[i], keypairs[i].second),
+          "Verification (offset) differs from PubKey");
+    }
+  }
+
+  /// The cached encoding matches the serialized key
+  VerifyingKey key(keypairs[0].second);
+  std::vector<uint8_t> serialized;
+  keypairs[0].second.Serialize(serialized, 0);
+  BOOST_CHECK_MESSAGE(equal(serialized.begin(), serialized.end(),
+                            key.GetCompressed().begin()),
+                      "Cached encoding mismatch");
+  BOOST_CHECK_MESSAGE(key.GetPubKey() == keypairs[0].second,
+                      "PubKey mismatch");
+
+  /// Out-of-range signatures and an uninitialized key are rejected
+  Signature bad(signatures[0]);
+  BN_copy(bad.m_s.get(), Schnorr::GetCurveOrder());
+  BOOST_CHECK_MESSAGE(!Schnorr::Verify(messages[0], bad, key),
+                      "Verification (response out of range) failed");
+  BN_zero(bad.m_r.get());
+  BOOST_CHECK_MESSAGE(!Schnorr::Verify(messages[0], bad, key),
+                      "Verification (zero challenge) failed");
+  BOOST_CHECK_MESSAGE(!Schnorr::Verify(messages[0], signatures[0],
+                                       VerifyingKey(PubKey())),
+                      "Verification (uninitialized key) failed");
+
+  /// Tables are only built within the memory limit and released with the
+  /// last copy of the key
+  const size_t limit = VerifyingKey::GetTableMemoryLimit();
+  const size_t usage = VerifyingKey::GetTableMemoryUsage();
+  VerifyingKey::SetTableMemoryLimit(usage);
+  {
+    const VerifyingKey untabled(keypairs[1].second);
+    BOOST_CHECK_MESSAGE(untabled.GetTableSize() == 0,
+                        "Table built beyond the memory limit");
+    BOOST_CHECK_MESSAGE(Schnorr::Verify(messages[1], signatures[1], untabled),
+                        "Verification (no table) failed");
+    BOOST_CHECK_MESSAGE(VerifyingKey::GetTableMemoryUsage() == usage,
+                        "Memory usage changed without a table");
+  }
+  VerifyingKey::SetTableMemoryLimit(limit);
+  {
+    const VerifyingKey tabled(keypairs[1].second);
+    const VerifyingKey copy(tabled);
+    BOOST_CHECK_MESSAGE(
+        VerifyingKey::GetTableMemoryUsage() == usage + tabled.GetTableSize(),
+        "Memory usage does not account for a shared table");
+  }
+  BOOST_CHECK_MESSAGE(VerifyingKey::GetTableMemoryUsage() == usage,
+                      "Table memory not released");
+
+  /// Compare the timings of the PubKey and VerifyingKey paths
+  const unsigned int rounds = 64;
+  vector<VerifyingKey> keys;
+  for (const auto& keypair : keypairs) {
+    keys.emplace_back(keypair.second);
+  }
+
+  auto t = r_timer_start();
+  for (unsigned int n = 0; n < rounds; n++) {
+    for (unsigned int i = 0; i < num_signatures; i++) {
+      Schnorr::Verify(messages[i], signatures[i], keypairs[i].second);
+    }
+  }
+  cout << "Verify with PubKey (usec)       = "
+       << r_timer_end(t) / (rounds * num_signatures) << endl;
+
+  t = r_timer_start();
+  for (unsigned int n = 0; n < rounds; n++) {
+    for (unsigned int i = 0; i < num_signatures; i++) {
+      Schnorr::Verify(messages[i], signatures[i], keys[i]);
+    }
+  }
+  cout << "Verify with VerifyingKey (usec) = "
+       << r_timer_end(t) / (rounds * num_signatures) << endl;
+}
+
+/**
+ * \brief test_signing_key
+ *
+ * \details Test signing with a prepared key against the PrivKey API
+ */
+BOOST_AUTO_TEST_CASE(test_signing_key) {
+  PairOfKey keypair = Schnorr::GenKeyPair();
+  SigningKey key(keypair.first);
+
+  BOOST_CHECK_MESSAGE(key.GetPubKey() == keypair.second,
+                      "Derived PubKey mismatch");
+  std::vector<uint8_t> serialized;
+  keypair.second.Serialize(serialized, 0);
+  BOOST_CHECK_MESSAGE(equal(serialized.begin(), serialized.end(),
+                            key.GetCompressed().begin()),
+                      "Cached encoding mismatch");
+
+  /// Signatures verify with the PubKey, also over a message range and from
+  /// a copy of the key
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+  const SigningKey copy(key);
+  SigningKey assigned(Schnorr::GenKeyPair().first);
+  assigned = copy;
+  for (unsigned int i = 1; i <= 16; i++) {
+    Signature signature;
+    const SigningKey& signer = (i % 2 == 0) ? key : assigned;
+    BOOST_CHECK_MESSAGE(Schnorr::Sign(message, signer, signature),
+                        "Signing failed");
+    BOOST_CHECK_MESSAGE(Schnorr::Verify(message, signature, keypair.second),
+                        "Verification failed");
+
+    BOOST_CHECK_MESSAGE(
+        Schnorr::Sign(message, i, message.size() - 2 * i, signer, signature),
+        "Signing (offset) failed");
+    BOOST_CHECK_MESSAGE(Schnorr::Verify(message, i, message.size() - 2 * i,
+                                        signature, keypair.second),
+                        "Verification (offset) failed");
+    BOOST_CHECK_MESSAGE(!Schnorr::Verify(message, signature, keypair.second),
+                        "Verification (wrong range) failed");
+  }
+
+  /// Empty messages, bad ranges and invalid keys are rejected
+  Signature signature;
+  BOOST_CHECK_MESSAGE(!Schnorr::Sign(std::vector<uint8_t>(), key, signature),
+                      "Signing (empty message) failed");
+  BOOST_CHECK_MESSAGE(
+      !Schnorr::Sign(message, 1, message.size(), key, signature),
+      "Signing (range beyond message) failed");
+  PrivKey zero;
+  BN_zero(zero.m_d.get());
+  SigningKey invalid(zero);
+  BOOST_CHECK_MESSAGE(!Schnorr::Sign(message, invalid, signature),
+                      "Signing (invalid key) failed");
+
+  /// One key shared by concurrent signers (the threads only count failures)
+  const unsigned int num_threads = 4;
+  const unsigned int signatures_per_thread = 64;
+  atomic<unsigned int> failures(0);
+  vector<thread> signers;
+  for (unsigned int t = 0; t < num_threads; t++) {
+    signers.emplace_back([&, t]() {
+      std::vector<uint8_t> thread_message(message);
+      thread_message[0] = static_cast<uint8_t>(t);
+      for (unsigned int i = 0; i < signatures_per_thread; i++) {
+        Signature thread_signature;
+        if (!Schnorr::Sign(thread_message, copy, thread_signature) ||
+            !Schnorr::Verify(thread_message, thread_signature,
+                             keypair.second)) {
+          failures++;
+        }
+      }
+    });
+  }
+  for (auto& signer : signers) {
+    signer.join();
+  }
+  BOOST_CHECK_MESSAGE(failures == 0, "Concurrent signing with one key failed");
+
+  /// Compare the timings of the PrivKey and SigningKey paths, interleaving
+  /// the batches and keeping the best of each to filter out noise
+  const unsigned int batches = 16;
+  const unsigned int batch_size = 64;
+  double best_privkey = 0;
+  double best_signingkey = 0;
+  for (unsigned int b = 0; b < batches; b++) {
+    auto t = r_timer_start();
+    for (unsigned int i = 0; i < batch_size; i++) {
+      Schnorr::Sign(message, keypair.first, keypair.second, signature);
+    }
+    const double privkey = r_timer_end(t) / batch_size;
+
+    t = r_timer_start();
+    for (unsigned int i = 0; i < batch_size; i++) {
+      Schnorr::Sign(message, key, signature);
+    }
+    const double signingkey = r_timer_end(t) / batch_size;
+
+    best_privkey = (b == 0) ? privkey : min(best_privkey, privkey);
+    best_signingkey = (b == 0) ? signingkey : min(best_signingkey, signingkey);
+  }
+  cout << "Sign with PrivKey (usec)    = " << best_privkey << endl;
+  cout << "Sign with SigningKey (usec) = " << best_signingkey << endl;
+}
+
+/**
+ * \brief test_nonce_pool
+ *
+ * \details Test signing with nonces taken from a NoncePool
+ */
+BOOST_AUTO_TEST_CASE(test_nonce_pool) {
+  PairOfKey keypair = Schnorr::GenKeyPair();
+  SigningKey key(keypair.first);
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+
+  const unsigned int capacity = 64;
+  NoncePool pool(capacity);
+  BOOST_CHECK_MESSAGE(pool.Capacity() == capacity, "Capacity mismatch");
+  BOOST_REQUIRE(pool.WaitUntilFull(std::chrono::seconds(30)));
+
+  /// Every signature verifies and uses its own nonce, so that the same
+  /// message never yields the same signature
+  vector<Signature> signatures(capacity);
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < capacity; i++) {
+    BOOST_CHECK_MESSAGE(Schnorr::Sign(message, key, pool, signatures.at(i)),
+                        "Signing failed");
+  }
+  const double pooled = r_timer_end(t) / capacity;
+
+  for (unsigned int i = 0; i < capacity; i++) {
+    BOOST_CHECK_MESSAGE(
+        Schnorr::Verify(message, signatures.at(i), keypair.second),
+        "Verification failed");
+    for (unsigned int j = 0; j < i; j++) {
+      BOOST_CHECK_MESSAGE(!(signatures.at(i) == signatures.at(j)),
+                          "Nonce used twice");
+    }
+  }
+
+  /// Signing goes on when the pool runs empty, also over a message range
+  NoncePool empty(0);
+  Signature signature;
+  BOOST_CHECK_MESSAGE(
+      Schnorr::Sign(message, 1, message.size() - 2, key, empty, signature),
+      "Signing (empty pool) failed");
+  BOOST_CHECK_MESSAGE(Schnorr::Verify(message, 1, message.size() - 2,
+                                      signature, keypair.second),
+                      "Verification (empty pool) failed");
+  BOOST_CHECK_MESSAGE(
+      !Schnorr::Sign(std::vector<uint8_t>(), key, pool, signature),
+      "Signing (empty message) failed");
+
+#if defined(__linux__)
+  /// A forked child does not take the nonces the parent takes next
+  BOOST_REQUIRE(pool.WaitUntilFull(std::chrono::seconds(30)));
+  int fds[2];
+  BOOST_REQUIRE(pipe(fds) == 0);
+  const pid_t child = fork();
+  BOOST_REQUIRE(child >= 0);
+  if (child == 0) {
+    Signature::Serialized child_bytes{};
+    if ((pool.Size() == 0) && Schnorr::Sign(message, key, pool, signature)) {
+      signature.Serialize(child_bytes);
+    }
+    const bool written = write(fds[1], child_bytes.data(),
+                               child_bytes.size()) ==
+                         static_cast<ssize_t>(child_bytes.size());
+    _exit(written ? 0 : 1);
+  }
+  close(fds[1]);
+  Signature::Serialized child_bytes{}, parent_bytes{};
+  const bool read_all = read(fds[0], child_bytes.data(), child_bytes.size()) ==
+                        static_cast<ssize_t>(child_bytes.size());
+  close(fds[0]);
+  int status = 0;
+  waitpid(child, &status, 0);
+  BOOST_REQUIRE(read_all && WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+  BOOST_REQUIRE(Schnorr::Sign(message, key, pool, signature));
+  BOOST_REQUIRE(signature.Serialize(parent_bytes));
+  Signature child_signature;
+  BOOST_CHECK_MESSAGE(child_signature.Deserialize(child_bytes) &&
+                          Schnorr::Verify(message, child_signature,
+                                          keypair.second),
+                      "Signing (forked child) failed");
+  BOOST_CHECK_MESSAGE(child_bytes != parent_bytes,
+                      "Nonce shared with a forked child");
+#endif
+
+  t = r_timer_start();
+  for (unsigned int i = 0; i < capacity; i++) {
+    Schnorr::Sign(message, key, signature);
+  }
+  const double inline_nonce = r_timer_end(t) / capacity;
+
+  cout << "Sign with SigningKey (usec) = " << inline_nonce << endl;
+  cout << "Sign with NoncePool (usec)  = " << pooled << endl;
+}
+
+/**
+ * \brief test_streaming
+ *
+ * \details Test signing and verifying messages fed in pieces
+ */
+BOOST_AUTO_TEST_CASE(test_streaming) {
+  PairOfKey keypair = Schnorr::GenKeyPair();
+  SigningKey key(keypair.first);
+  const VerifyingKey verifying_key(keypair.second);
+  std::vector<uint8_t> message(4096);
+  generate(message.begin(), message.end(), std::rand);
+
+  /// Three segments, one of them empty, in place of the whole message
+  const vector<MessageSegment> segments = {
+      {message.data(), 1000},
+      {message.data() + 1000, 0},
+      {message.data() + 1000, message.size() - 1000}};
+
+  /// Signatures on segments verify in one piece, and the other way round
+  Signature streamed;
+  BOOST_CHECK_MESSAGE(
+      Schnorr::Sign(segments.data(), segments.size(), key, streamed),
+      "Segment signing failed");
+  BOOST_CHECK_MESSAGE(Schnorr::Verify(message, streamed, keypair.second),
+                      "Verification of segment signature failed");
+  SignatureR streamed_r;
+  BOOST_CHECK_MESSAGE(
+      Schnorr::SignR(segments.data(), segments.size(), key, streamed_r),
+      "Segment signing (R-form) failed");
+  BOOST_CHECK_MESSAGE(Schnorr::VerifyR(message, streamed_r, keypair.second),
+                      "Verification of segment signature (R-form) failed");
+
+  Signature signature;
+  BOOST_REQUIRE(Schnorr::Sign(message, key, signature));
+  Verifier verifier(verifying_key, signature);
+  BOOST_REQUIRE(verifier.Initialized());
+  for (size_t pos = 0; pos < message.size(); pos += 100) {
+    BOOST_CHECK_MESSAGE(
+        verifier.Update(message.data() + pos,
+                        std::min<size_t>(100, message.size() - pos)),
+        "Verifier update failed");
+  }
+  BOOST_CHECK_MESSAGE(verifier.Finalize(), "Streamed verification failed");
+
+  /// A streamed verifier takes a single message
+  BOOST_CHECK_MESSAGE(!verifier.Update(message) && !verifier.Finalize(),
+                      "Verifier reuse failed");
+
+  /// Changed or truncated messages, other keys and empty messages fail
+  Verifier truncated(verifying_key, streamed);
+  truncated.Update(message.data(), message.size() - 1);
+  BOOST_CHECK_MESSAGE(!truncated.Finalize(),
+                      "Verification (truncated) failed");
+  std::vector<uint8_t> changed(message);
+  changed.back() ^= 0x01;
+  Verifier tampered(verifying_key, streamed);
+  tampered.Update(changed);
+  BOOST_CHECK_MESSAGE(!tampered.Finalize(), "Verification (changed) failed");
+  Verifier other(VerifyingKey(Schnorr::GenKeyPair().second), streamed);
+  other.Update(message);
+  BOOST_CHECK_MESSAGE(!other.Finalize(), "Verification (other key) failed");
+  BOOST_CHECK_MESSAGE(!Schnorr::Sign(segments.data() + 1, 1, key, streamed),
+                      "Signing (empty message) failed");
+  Verifier empty_verifier(verifying_key, signature);
+  BOOST_CHECK_MESSAGE(!empty_verifier.Finalize(),
+                      "Verification (empty message) failed");
+
+  /// Invalid keys and signatures are reported on construction
+  PrivKey zero;
+  BN_zero(zero.m_d.get());
+  SigningKey invalid(zero);
+  BOOST_CHECK_MESSAGE(
+      !Schnorr::Sign(segments.data(), segments.size(), invalid, streamed),
+      "Segment signing (invalid key) failed");
+  Signature out_of_range(signature);
+  BN_zero(out_of_range.m_s.get());
+  Verifier rejected(verifying_key, out_of_range);
+  BOOST_CHECK_MESSAGE(!rejected.Initialized() && !rejected.Update(message),
+                      "Verifier (invalid signature) failed");
+
+  /// Compare with copying the segments into one vector first
+  const unsigned int rounds = 64;
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < rounds; i++) {
+    std::vector<uint8_t> joined;
+    for (const auto& segment : segments) {
+      joined.insert(joined.end(), segment.data, segment.data + segment.size);
+    }
+    Schnorr::Sign(joined, key, signature);
+  }
+  const double copied = r_timer_end(t) / rounds;
+
+  t = r_timer_start();
+  for (unsigned int i = 0; i < rounds; i++) {
+    Schnorr::Sign(segments.data(), segments.size(), key, signature);
+  }
+  const double segment_sign = r_timer_end(t) / rounds;
+
+  cout << "Sign copied segments (usec) = " << copied << endl;
+  cout << "Sign segments (usec)        = " << segment_sign << endl;
+}
+#endif
+
+/**
+ * \brief test_pointer_input
+ *
+ * \details Test the entry points taking a pointer and a size
+ */
+BOOST_AUTO_TEST_CASE(test_pointer_input) {
+  PairOfKey keypair = Schnorr::GenKeyPair();
+#ifdef SCHNORR_NATIVE_SECP256K1
+  SigningKey key(keypair.first);
+  const VerifyingKey verifying_key(keypair.second);
+#endif
+
+  /// A message in a buffer that is not a vector, as received from the network
+  const size_t message_size = 1024;
+  unique_ptr<uint8_t[]> buffer(new uint8_t[message_size]);
+  generate(buffer.get(), buffer.get() + message_size, std::rand);
+  const std::vector<uint8_t> message(buffer.get(),
+                                     buffer.get() + message_size);
+
+  Signature signature;
+  BOOST_CHECK_MESSAGE(Schnorr::Sign(buffer.get(), message_size, keypair.first,
+                                    keypair.second, signature),
+                      "Signing (PrivKey) failed");
+  BOOST_CHECK_MESSAGE(Schnorr::Verify(message, signature, keypair.second),
+                      "Verification (PrivKey) failed");
+#ifdef SCHNORR_NATIVE_SECP256K1
+  BOOST_CHECK_MESSAGE(
+      Schnorr::Sign(buffer.get(), message_size, key, signature),
+      "Signing (SigningKey) failed");
+#endif
+  BOOST_CHECK_MESSAGE(
+      Schnorr::Verify(buffer.get(), message_size, signature, keypair.second),
+      "Verification (PubKey) failed");
+  BOOST_CHECK_MESSAGE(!Schnorr::Verify(buffer.get(), message_size - 1,
+                                       signature, keypair.second),
+                      "Verification (truncated) failed");
+#ifdef SCHNORR_NATIVE_SECP256K1
+  BOOST_CHECK_MESSAGE(
+      Schnorr::Verify(buffer.get(), message_size, signature, verifying_key),
+      "Verification (VerifyingKey) failed");
+  BOOST_CHECK_MESSAGE(!Schnorr::Sign(buffer.get(), 0, key, signature),
+                      "Signing (empty message) failed");
+
+  SignatureR signature_r;
+  BOOST_CHECK_MESSAGE(
+      Schnorr::SignR(buffer.get(), message_size, key, signature_r),
+      "SignR failed");
+  BOOST_CHECK_MESSAGE(Schnorr::VerifyR(buffer.get(), message_size,
+                                       signature_r, keypair.second),
+                      "VerifyR failed");
+  const MessageSegment segment = {buffer.get(), message_size};
+  BOOST_CHECK_MESSAGE(Schnorr::BatchVerifyR(&segment, &signature_r,
+                                            &keypair.second, 1),
+                      "BatchVerifyR failed");
+#endif
+
+  /// Deserialization from the middle of a raw buffer, and rejection of a
+  /// buffer too short
+  std::vector<uint8_t> serialized(3);
+  keypair.second.Serialize(serialized, serialized.size());
+  signature.Serialize(serialized, serialized.size());
+  PubKey pubkey;
+  Signature deserialized;
+  BOOST_CHECK_MESSAGE(
+      pubkey.Deserialize(serialized.data() + 3, serialized.size() - 3) &&
+          (pubkey == keypair.second),
+      "PubKey deserialization failed");
+  BOOST_CHECK_MESSAGE(deserialized.Deserialize(serialized.data() + 36,
+                                               serialized.size() - 36) &&
+                          (deserialized == signature),
+                      "Signature deserialization failed");
+  BOOST_CHECK_MESSAGE(
+      !deserialized.Deserialize(serialized.data() + 37, serialized.size() - 37),
+      "Signature deserialization (short buffer) failed");
+
+  /// Ranges whose end wraps around 32 bits are rejected
+  BOOST_CHECK_MESSAGE(
+      !Schnorr::Verify(message, 0xFFFFFF00, 0x200, signature, keypair.second),
+      "Verification (wrapping range) failed");
+  BOOST_CHECK_MESSAGE(!Schnorr::Sign(message, 0x200, 0xFFFFFF00,
+                                     keypair.first, keypair.second, signature),
+                      "Signing (wrapping range) failed");
+#ifdef SCHNORR_NATIVE_SECP256K1
+  BOOST_CHECK_MESSAGE(
+      !Schnorr::Sign(message, 0x200, 0xFFFFFF00, key, signature),
+      "Signing (wrapping range, SigningKey) failed");
+#endif
+
+#if defined(__linux__)
+  /// A message beyond the first 4 GiB of a mapping, whose pages are only
+  /// allocated when touched
+  const size_t offset = size_t(1) << 32;
+  void* mapping = mmap(nullptr, offset + message_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapping == MAP_FAILED) {
+    BOOST_TEST_MESSAGE("Skipping the 4 GiB offset check, mmap failed");
+  } else {
+    uint8_t* far_message = static_cast<uint8_t*>(mapping) + offset;
+    copy(message.begin(), message.end(), far_message);
+    BOOST_CHECK_MESSAGE(Schnorr::Sign(far_message, message_size, keypair.first,
+                                      keypair.second, signature),
+                        "Signing (beyond 4 GiB) failed");
+    BOOST_CHECK_MESSAGE(Schnorr::Verify(message, signature, keypair.second),
+                        "Verification (beyond 4 GiB) failed");
+    munmap(mapping, offset + message_size);
+  }
+#endif
+}
+
+#ifdef SCHNORR_NATIVE_SECP256K1
+/**
+ * \brief test_signature_r
+ *
+ * \details Test signing, verifying and batch verifying R-form signatures
+ */
+BOOST_AUTO_TEST_CASE(test_signature_r) {
+  PairOfKey keypair = Schnorr::GenKeyPair();
+  SigningKey key(keypair.first);
+
+  /// R-form signatures from either key verify, also over a message range
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+  for (unsigned int i = 1; i <= 8; i++) {
+    SignatureR signature;
+    BOOST_CHECK_MESSAGE(
+        (i % 2 == 0)
+            ? Schnorr::SignR(message, keypair.first, keypair.second, signature)
+            : Schnorr::SignR(message, key, signature),
+        "SignR failed");
+    BOOST_CHECK_MESSAGE(Schnorr::VerifyR(message, signature, keypair.second),
+                        "VerifyR failed");
+
+    BOOST_CHECK_MESSAGE(
+        (i % 2 == 0) ? Schnorr::SignR(message, i, message.size() - 2 * i,
+                                      keypair.first, keypair.second, signature)
+                     : Schnorr::SignR(message, i, message.size() - 2 * i, key,
+                                      signature),
+        "SignR (offset) failed");
+    BOOST_CHECK_MESSAGE(Schnorr::VerifyR(message, i, message.size() - 2 * i,
+                                         signature, keypair.second),
+                        "VerifyR (offset) failed");
+    BOOST_CHECK_MESSAGE(!Schnorr::VerifyR(message, signature, keypair.second),
+                        "VerifyR (wrong range) failed");
+  }
+
+  /// Serialization round trip, and rejection of modified signatures
+  SignatureR signature;
+  BOOST_CHECK_MESSAGE(!Schnorr::VerifyR(message, signature, keypair.second),
+                      "VerifyR (uninitialized signature) failed");
+  BOOST_CHECK_MESSAGE(Schnorr::SignR(message, key, signature), "SignR failed");
+  std::vector<uint8_t> signature_bytes;
+  signature.Serialize(signature_bytes, 0);
+  BOOST_CHECK_MESSAGE(signature_bytes.size() == 65, "Wrong serialized size");
+  SignatureR signature1(signature_bytes, 0);
+  BOOST_CHECK_MESSAGE(signature == signature1,
+                      "SignatureR serialization check failed");
+  BOOST_CHECK_MESSAGE(std::string(signature) == std::string(signature1),
+                      "SignatureR string conversion failed");
+  BOOST_CHECK_MESSAGE(
+      !Schnorr::VerifyR(message, signature, Schnorr::GenKeyPair().second),
+      "VerifyR (wrong key) failed");
+  BN_add_word(signature1.m_s.get(), 1);
+  BOOST_CHECK_MESSAGE(!Schnorr::VerifyR(message, signature1, keypair.second),
+                      "VerifyR (modified response) failed");
+
+  /// A batch of signatures by a set of keys on distinct messages
+  const unsigned int count = 10000;
+  const unsigned int num_keys = 64;
+  std::vector<SigningKey> keys;
+  for (unsigned int i = 0; i < num_keys; i++) {
+    keys.emplace_back(Schnorr::GenKeyPair().first);
+  }
+  std::vector<std::vector<uint8_t>> messages(count);
+  std::vector<SignatureR> signatures(count);
+  std::vector<PubKey> pubkeys;
+  for (unsigned int i = 0; i < count; i++) {
+    messages[i].resize(128);
+    generate(messages[i].begin(), messages[i].end(), std::rand);
+    Schnorr::SignR(messages[i], keys[i % num_keys], signatures[i]);
+    pubkeys.push_back(keys[i % num_keys].GetPubKey());
+  }
+
+  BOOST_CHECK_MESSAGE(Schnorr::BatchVerifyR(messages, signatures, pubkeys),
+                      "BatchVerifyR failed");
+  const std::vector<std::vector<uint8_t>> one_message(1, messages[0]);
+  const std::vector<SignatureR> one_signature(1, signatures[0]);
+  const std::vector<PubKey> one_pubkey(1, pubkeys[0]);
+  BOOST_CHECK_MESSAGE(
+      Schnorr::BatchVerifyR(one_message, one_signature, one_pubkey),
+      "BatchVerifyR (single signature) failed");
+  BOOST_CHECK_MESSAGE(!Schnorr::BatchVerifyR({}, {}, {}),
+                      "BatchVerifyR (empty batch) failed");
+  BOOST_CHECK_MESSAGE(!Schnorr::BatchVerifyR(one_message, signatures, pubkeys),
+                      "BatchVerifyR (mismatched sizes) failed");
+
+  /// A single bad signature, message or key fails the whole batch
+  const unsigned int bad = count / 3;
+  signatures[bad] = signature1;
+  BOOST_CHECK_MESSAGE(!Schnorr::BatchVerifyR(messages, signatures, pubkeys),
+                      "BatchVerifyR (bad signature) failed");
+  Schnorr::SignR(messages[bad], keys[bad % num_keys], signatures[bad]);
+  swap(messages[bad], messages[bad + 1]);
+  BOOST_CHECK_MESSAGE(!Schnorr::BatchVerifyR(messages, signatures, pubkeys),
+                      "BatchVerifyR (swapped messages) failed");
+  swap(messages[bad], messages[bad + 1]);
+  pubkeys[bad] = keypair.second;
+  BOOST_CHECK_MESSAGE(!Schnorr::BatchVerifyR(messages, signatures, pubkeys),
+                      "BatchVerifyR (wrong key) failed");
+  pubkeys[bad] = keys[bad % num_keys].GetPubKey();
+
+  /// Compare the timings of one VerifyR per signature and of BatchVerifyR
+  auto t = r_timer_start();
+  bool all_valid = true;
+  for (unsigned int i = 0; i < count; i++) {
+    all_valid &= Schnorr::VerifyR(messages[i], signatures[i], pubkeys[i]);
+  }
+  const double single = r_timer_end(t) / count;
+  BOOST_CHECK_MESSAGE(all_valid, "VerifyR failed");
+
+  t = r_timer_start();
+  BOOST_CHECK_MESSAGE(Schnorr::BatchVerifyR(messages, signatures, pubkeys),
+                      "BatchVerifyR failed");
+  const double batch = r_timer_end(t) / count;
+  cout << "VerifyR per signature (usec)      = " << single << endl;
+  cout << "BatchVerifyR per signature (usec) = " << batch << endl;
+}
+#endif
+
 /**
  * \brief test_serialization
  *
@@ -298,6 +1166,103 @@ BOOST_AUTO_TEST_CASE(test_serialization) {
   BOOST_CHECK(!SignatureOutput.is_empty(false));
 }
 
+/**
+ * \brief test_fixed_size_serialization
+ *
+ * \details Test serialization into fixed-size buffers, and that decoding a
+ * signature and a public key into existing objects does not allocate
+ */
+BOOST_AUTO_TEST_CASE(test_fixed_size_serialization) {
+  PairOfKey keypair = Schnorr::GenKeyPair();
+  std::vector<uint8_t> message(1024);
+  generate(message.begin(), message.end(), std::rand);
+
+  Signature signature;
+  BOOST_REQUIRE(
+      Schnorr::Sign(message, keypair.first, keypair.second, signature));
+  SignatureR signature_r;
+#ifdef SCHNORR_NATIVE_SECP256K1
+  BOOST_REQUIRE(
+      Schnorr::SignR(message, keypair.first, keypair.second, signature_r));
+#else
+  /// Without R-form signing, the fields are filled in by hand
+  BOOST_REQUIRE(EC_POINT_copy(signature_r.m_R.get(), keypair.second.m_P.get()));
+  BOOST_REQUIRE(BN_copy(signature_r.m_s.get(), signature.m_s.get()));
+#endif
+
+  /// Same encodings as the vector forms
+  PrivKey::Serialized privkey_bytes;
+  PubKey::Serialized pubkey_bytes;
+  Signature::Serialized signature_bytes;
+  SignatureR::Serialized signature_r_bytes;
+  BOOST_REQUIRE(keypair.first.Serialize(privkey_bytes));
+  BOOST_REQUIRE(keypair.second.Serialize(pubkey_bytes));
+  BOOST_REQUIRE(signature.Serialize(signature_bytes));
+  BOOST_REQUIRE(signature_r.Serialize(signature_r_bytes));
+
+  std::vector<uint8_t> pubkey_vector, signature_vector;
+  keypair.second.Serialize(pubkey_vector, 0);
+  signature.Serialize(signature_vector, 0);
+  BOOST_CHECK(equal(pubkey_bytes.begin(), pubkey_bytes.end(),
+                    pubkey_vector.begin(), pubkey_vector.end()));
+  BOOST_CHECK(equal(signature_bytes.begin(), signature_bytes.end(),
+                    signature_vector.begin(), signature_vector.end()));
+
+  /// Round trips
+  PrivKey privkey;
+  PubKey pubkey;
+  Signature signature1;
+  SignatureR signature_r1;
+  BOOST_CHECK(privkey.Deserialize(privkey_bytes) && privkey == keypair.first);
+  BOOST_CHECK(pubkey.Deserialize(pubkey_bytes) && pubkey == keypair.second);
+  BOOST_CHECK(signature1.Deserialize(signature_bytes) &&
+              signature1 == signature);
+  BOOST_CHECK(signature_r1.Deserialize(signature_r_bytes) &&
+              signature_r1 == signature_r);
+  BOOST_CHECK(Schnorr::Verify(message, signature1, pubkey));
+
+  /// An x coordinate above the field prime is rejected, and the key is left
+  /// unchanged
+  PubKey::Serialized bad_bytes;
+  bad_bytes.fill(0xFF);
+  bad_bytes[0] = 0x02;
+  BOOST_CHECK(!pubkey.Deserialize(bad_bytes));
+  BOOST_CHECK(pubkey == keypair.second);
+
+  /// The point at infinity is all zeroes
+  PubKey infinity;
+  EC_POINT_set_to_infinity(Schnorr::GetCurveGroup(), infinity.m_P.get());
+  PubKey::Serialized infinity_bytes;
+  BOOST_CHECK(infinity.Serialize(infinity_bytes));
+  BOOST_CHECK(all_of(infinity_bytes.begin(), infinity_bytes.end(),
+                     [](uint8_t b) { return b == 0x00; }));
+  BOOST_CHECK(pubkey.Deserialize(infinity_bytes) && pubkey == infinity);
+
+  /// Decoding into objects that already hold a value allocates nothing with
+  /// the native backend; OpenSSL allocates to decompress the point
+  const unsigned int count = 1000;
+  BOOST_REQUIRE(pubkey.Deserialize(pubkey_bytes));
+  const auto t = r_timer_start();
+#if defined(SCHNORR_TEST_COUNT_ALLOCATIONS) && defined(SCHNORR_NATIVE_SECP256K1)
+  const size_t allocations = thread_allocations;
+#endif
+  bool decoded = true;
+  for (unsigned int i = 0; i < count; i++) {
+    decoded = signature1.Deserialize(signature_bytes) &&
+              pubkey.Deserialize(pubkey_bytes) &&
+              signature1.Serialize(signature_bytes) &&
+              pubkey.Serialize(pubkey_bytes) && decoded;
+  }
+#if defined(SCHNORR_TEST_COUNT_ALLOCATIONS) && defined(SCHNORR_NATIVE_SECP256K1)
+  const size_t allocated = thread_allocations - allocations;
+  BOOST_CHECK_MESSAGE(allocated == 0, "Allocations: " << allocated);
+#endif
+  const double round_trip = r_timer_end(t) / count;
+  BOOST_CHECK(decoded);
+  BOOST_CHECK(signature1 == signature && pubkey == keypair.second);
+  cout << "Signature and PubKey round trip (usec) = " << round_trip << endl;
+}
+
 /**
  * \brief test_error_deserialization_pubkey
  *
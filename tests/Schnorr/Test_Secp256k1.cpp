@@ -0,0 +1,820 @@
+/*
+ * Copyright (C) 2019 Zilliqa
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <openssl/err.h>
+#include <openssl/rand.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include "libSchnorr/include/MultiSig.h"
+#include "libSchnorr/include/Schnorr.h"
+#include "libSchnorr/src/Secp256k1Group.h"
+
+#define BOOST_TEST_MODULE secp256k1test
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace secp256k1;
+
+using BNPtr = unique_ptr<BIGNUM, void (*)(BIGNUM*)>;
+using PointPtr = unique_ptr<EC_POINT, void (*)(EC_POINT*)>;
+using CtxPtr = unique_ptr<BN_CTX, void (*)(BN_CTX*)>;
+
+system_clock::time_point r_timer_start() { return system_clock::now(); }
+
+double r_timer_end(system_clock::time_point start_time) {
+  duration<double, std::micro> difference = system_clock::now() - start_time;
+  return difference.count();
+}
+
+/// The eigenvalue of the secp256k1 endomorphism.
+const uint8_t LAMBDA[32] = {0x53, 0x63, 0xAD, 0x4C, 0xC0, 0x5C, 0x30, 0xE0,
+                            0xA5, 0x26, 0x1C, 0x02, 0x88, 0x12, 0x64, 0x5A,
+                            0x12, 0x2E, 0x22, 0xEA, 0x20, 0x81, 0x66, 0x78,
+                            0xDF, 0x02, 0x96, 0x7C, 0x1B, 0x23, 0xBD, 0x72};
+
+BNPtr NewBN() { return BNPtr(BN_new(), BN_clear_free); }
+
+PointPtr NewPoint() {
+  return PointPtr(EC_POINT_new(Schnorr::GetCurveGroup()), EC_POINT_clear_free);
+}
+
+/// Writes a non-negative BIGNUM below 2^256 as 32 big-endian bytes.
+array<uint8_t, 32> ToBytes(const BIGNUM* bn) {
+  array<uint8_t, 32> out{};
+  BN_bn2bin(bn, out.data() + out.size() - BN_num_bytes(bn));
+  return out;
+}
+
+/// Returns the field prime p.
+BNPtr FieldPrime() {
+  BNPtr p = NewBN();
+  BN_CTX* ctx = BN_CTX_new();
+  EC_GROUP_get_curve_GFp(Schnorr::GetCurveGroup(), p.get(), nullptr, nullptr,
+                         ctx);
+  BN_CTX_free(ctx);
+  return p;
+}
+
+/// Compares a native field element with the residue of a BIGNUM modulo p.
+bool SameElem(const FieldElem& a, const BIGNUM* b) {
+  FieldElem t = a;
+  t.Normalize();
+  array<uint8_t, 32> buf;
+  t.GetB32(buf.data());
+  return buf == ToBytes(b);
+}
+
+/// Compares the compressed encodings of a native and an OpenSSL point.
+bool SamePoint(const GeJacobian& a, const EC_POINT* b, BN_CTX* ctx) {
+  GeAffine aa;
+  aa.SetJacobianVar(a);
+  if (aa.infinity || EC_POINT_is_at_infinity(Schnorr::GetCurveGroup(), b)) {
+    return aa.infinity && EC_POINT_is_at_infinity(Schnorr::GetCurveGroup(), b);
+  }
+
+  array<uint8_t, 33> native, openssl;
+  aa.GetCompressed(native.data());
+  EC_POINT_point2oct(Schnorr::GetCurveGroup(), b, POINT_CONVERSION_COMPRESSED,
+                     openssl.data(), openssl.size(), ctx);
+  return native == openssl;
+}
+
+/// Returns a uniformly random scalar.
+Scalar RandomScalar() {
+  array<uint8_t, 32> buf;
+  RAND_bytes(buf.data(), buf.size());
+  Scalar k;
+  k.SetB32(buf.data());
+  return k;
+}
+
+/// Returns k * G as an affine point.
+GeAffine MulG(const Scalar& k) {
+  GeJacobian rj;
+  EcMultGen(rj, k);
+  GeAffine r;
+  r.SetJacobianVar(rj);
+  return r;
+}
+
+/// Computes ng * G + sum(na[i] * a[i]) one term at a time.
+GeAffine MultiMulReference(const vector<GeAffine>& a, const vector<Scalar>& na,
+                           const Scalar& ng) {
+  GeJacobian sum;
+  EcMultGen(sum, ng);
+  Scalar zero;
+  zero.SetInt(0);
+  for (size_t i = 0; i < a.size(); i++) {
+    GeJacobian term;
+    EcMultDoubleVar(term, a[i], na[i], zero);
+    sum.AddVar(sum, term);
+  }
+  GeAffine r;
+  r.SetJacobianVar(sum);
+  return r;
+}
+
+BOOST_AUTO_TEST_SUITE(secp256k1test)
+
+/**
+ * \brief test_field_arithmetic
+ *
+ * \details Test the native field operations against BIGNUM arithmetic mod p
+ */
+BOOST_AUTO_TEST_CASE(test_field_arithmetic) {
+  CtxPtr ctx(BN_CTX_new(), BN_CTX_free);
+  BNPtr p = FieldPrime();
+  BNPtr a = NewBN(), b = NewBN(), r = NewBN();
+
+  // Random values plus the edge cases 0, 1, p-1 and 2^256-1 (which is not
+  // reduced and must wrap on load)
+  vector<array<uint8_t, 32>> values;
+  array<uint8_t, 32> v{};
+  values.emplace_back(v);
+  v[31] = 1;
+  values.emplace_back(v);
+  BN_copy(a.get(), p.get());
+  BN_sub_word(a.get(), 1);
+  values.emplace_back(ToBytes(a.get()));
+  v.fill(0xFF);
+  values.emplace_back(v);
+  for (unsigned int i = 0; i < 200; i++) {
+    RAND_bytes(v.data(), v.size());
+    values.emplace_back(v);
+  }
+
+  for (unsigned int i = 0; i < values.size(); i++) {
+    const auto& va = values[i];
+    const auto& vb = values[(i * 7 + 3) % values.size()];
+
+    FieldElem fa, fb, fr;
+    fa.SetB32(va.data());
+    fb.SetB32(vb.data());
+    BN_bin2bn(va.data(), va.size(), a.get());
+    BN_bin2bn(vb.data(), vb.size(), b.get());
+    BN_nnmod(a.get(), a.get(), p.get(), ctx.get());
+    BN_nnmod(b.get(), b.get(), p.get(), ctx.get());
+
+    fr.Mul(fa, fb);
+    BN_mod_mul(r.get(), a.get(), b.get(), p.get(), ctx.get());
+    BOOST_CHECK_MESSAGE(SameElem(fr, r.get()), "Mul mismatch");
+
+    fr.Sqr(fa);
+    BN_mod_sqr(r.get(), a.get(), p.get(), ctx.get());
+    BOOST_CHECK_MESSAGE(SameElem(fr, r.get()), "Sqr mismatch");
+
+    // Lazy sums up to the maximum supported magnitude of 8
+    FieldElem sum = fa;
+    for (unsigned int k = 1; k < 8; k++) {
+      sum.Add(fb);
+    }
+    fr.Mul(sum, sum);
+    BN_mul_word(b.get(), 7);
+    BN_mod_add(r.get(), a.get(), b.get(), p.get(), ctx.get());
+    BN_mod_sqr(r.get(), r.get(), p.get(), ctx.get());
+    BOOST_CHECK_MESSAGE(SameElem(fr, r.get()), "Lazy Add mismatch");
+    BN_bin2bn(vb.data(), vb.size(), b.get());
+    BN_nnmod(b.get(), b.get(), p.get(), ctx.get());
+
+    fr.Negate(fa, 1);
+    fr.Add(fb);
+    BN_mod_sub(r.get(), b.get(), a.get(), p.get(), ctx.get());
+    BOOST_CHECK_MESSAGE(SameElem(fr, r.get()), "Negate mismatch");
+
+    fr = fa;
+    fr.Half();
+    fr.MulInt(2);
+    BOOST_CHECK_MESSAGE(SameElem(fr, a.get()), "Half mismatch");
+
+    fr.Inv(fa);
+    if (BN_is_zero(a.get())) {
+      BOOST_CHECK_MESSAGE(SameElem(fr, a.get()), "Inverse of zero not zero");
+    } else {
+      BN_mod_inverse(r.get(), a.get(), p.get(), ctx.get());
+      BOOST_CHECK_MESSAGE(SameElem(fr, r.get()), "Inv mismatch");
+    }
+
+    const bool is_square = fr.Sqrt(fa);
+    const bool expected_square =
+        BN_mod_sqrt(r.get(), a.get(), p.get(), ctx.get()) != nullptr;
+    ERR_clear_error();
+    BOOST_CHECK_MESSAGE(is_square == expected_square, "Sqrt residue mismatch");
+    if (is_square) {
+      FieldElem check;
+      check.Sqr(fr);
+      BOOST_CHECK_MESSAGE(SameElem(check, a.get()), "Sqrt mismatch");
+    }
+  }
+}
+
+/**
+ * \brief test_double_multiplication
+ *
+ * \details Test native s*G + r*P against EC_POINT_mul
+ */
+BOOST_AUTO_TEST_CASE(test_double_multiplication) {
+  CtxPtr ctx(BN_CTX_new(), BN_CTX_free);
+  const BIGNUM* order = Schnorr::GetCurveOrder();
+  const EC_GROUP* group = Schnorr::GetCurveGroup();
+
+  BNPtr s = NewBN(), r = NewBN(), k = NewBN();
+  PointPtr P = NewPoint(), Q = NewPoint();
+
+  // Edge scalars: 0, 1, 2, n-1, n-2, 2^255, 2^128 - 1, 2^128, (n-1)/2,
+  // lambda and n - lambda (the last ones stress the GLV split)
+  vector<BNPtr> edges;
+  for (unsigned int i = 0; i < 11; i++) {
+    edges.emplace_back(NewBN());
+  }
+  BN_zero(edges[0].get());
+  BN_one(edges[1].get());
+  BN_set_word(edges[2].get(), 2);
+  BN_copy(edges[3].get(), order);
+  BN_sub_word(edges[3].get(), 1);
+  BN_copy(edges[4].get(), order);
+  BN_sub_word(edges[4].get(), 2);
+  BN_set_bit(edges[5].get(), 255);
+  BN_set_bit(edges[6].get(), 128);
+  BN_sub_word(edges[6].get(), 1);
+  BN_set_bit(edges[7].get(), 128);
+  BN_rshift1(edges[8].get(), edges[3].get());
+  BN_bin2bn(LAMBDA, sizeof(LAMBDA), edges[9].get());
+  BN_sub(edges[10].get(), order, edges[9].get());
+
+  for (unsigned int i = 0; i < 300; i++) {
+    BN_rand_range(k.get(), order);
+    if (i % 50 == 0) {
+      // P = G exercises the doubling branches of the additions
+      BN_one(k.get());
+    }
+    EC_POINT_mul(group, P.get(), k.get(), nullptr, nullptr, ctx.get());
+
+    if (i < edges.size() * edges.size()) {
+      BN_copy(s.get(), edges[i % edges.size()].get());
+      BN_copy(r.get(), edges[i / edges.size()].get());
+    } else {
+      BN_rand_range(s.get(), order);
+      BN_rand_range(r.get(), order);
+    }
+
+    EC_POINT_mul(group, Q.get(), s.get(), P.get(), r.get(), ctx.get());
+
+    Scalar ns, nr;
+    GeAffine np;
+    BOOST_REQUIRE(LoadScalar(ns, s.get()));
+    BOOST_REQUIRE(LoadScalar(nr, r.get()));
+    BOOST_REQUIRE(LoadPoint(np, P.get(), ctx.get()));
+
+    GeJacobian nq;
+    EcMultDoubleVar(nq, np, nr, ns);
+    BOOST_CHECK_MESSAGE(SamePoint(nq, Q.get(), ctx.get()),
+                        "Double multiplication mismatch at " << i);
+  }
+
+  // s*G + (n-s)*G is the point at infinity
+  BN_rand_range(s.get(), order);
+  BN_sub(r.get(), order, s.get());
+  Scalar ns, nr;
+  LoadScalar(ns, s.get());
+  LoadScalar(nr, r.get());
+  GeJacobian nq;
+  EcMultDoubleVar(nq, GeAffine::Generator(), nr, ns);
+  GeAffine q;
+  q.SetJacobianVar(nq);
+  BOOST_CHECK_MESSAGE(q.infinity, "Expected the point at infinity");
+}
+
+/**
+ * \brief test_glv_split
+ *
+ * \details Test the endomorphism scalar split and lambda * P
+ */
+BOOST_AUTO_TEST_CASE(test_glv_split) {
+  CtxPtr ctx(BN_CTX_new(), BN_CTX_free);
+  const BIGNUM* order = Schnorr::GetCurveOrder();
+  BNPtr k = NewBN(), lambda = NewBN(), bound = NewBN();
+  BN_bin2bn(LAMBDA, sizeof(LAMBDA), lambda.get());
+  BN_set_bit(bound.get(), 128);
+
+  Scalar lam;
+  lam.SetB32(LAMBDA);
+
+  for (unsigned int i = 0; i < 1000; i++) {
+    if (i == 0) {
+      BN_copy(k.get(), lambda.get());
+    } else if (i == 1) {
+      BN_copy(k.get(), order);
+      BN_sub_word(k.get(), 1);
+    } else {
+      BN_rand_range(k.get(), order);
+    }
+
+    Scalar nk, r1, r2, check;
+    LoadScalar(nk, k.get());
+    nk.SplitLambda(r1, r2);
+
+    check.Mul(r2, lam);
+    check.Add(check, r1);
+    BOOST_CHECK_MESSAGE(check.Equal(nk), "Split does not recombine");
+
+    for (const Scalar* part : {&r1, &r2}) {
+      Scalar neg;
+      neg.Negate(*part);
+      const bool small = (part->d[2] | part->d[3]) == 0;
+      const bool small_neg = (neg.d[2] | neg.d[3]) == 0;
+      BOOST_CHECK_MESSAGE(small || small_neg, "Split part above 2^128");
+    }
+  }
+
+  // lambda * P computed with beta matches the scalar multiplication
+  PointPtr P = NewPoint(), Q = NewPoint();
+  BN_rand_range(k.get(), order);
+  EC_POINT_mul(Schnorr::GetCurveGroup(), P.get(), k.get(), nullptr, nullptr,
+               ctx.get());
+  EC_POINT_mul(Schnorr::GetCurveGroup(), Q.get(), nullptr, P.get(),
+               lambda.get(), ctx.get());
+  GeAffine np;
+  LoadPoint(np, P.get(), ctx.get());
+  GeJacobian pj, lp;
+  pj.SetAffine(np);
+  lp.MulLambda(pj);
+  BOOST_CHECK_MESSAGE(SamePoint(lp, Q.get(), ctx.get()), "lambda * P mismatch");
+}
+
+/**
+ * \brief test_point_encoding
+ *
+ * \details Test native point parsing and encoding against OpenSSL
+ */
+BOOST_AUTO_TEST_CASE(test_point_encoding) {
+  CtxPtr ctx(BN_CTX_new(), BN_CTX_free);
+  const EC_GROUP* group = Schnorr::GetCurveGroup();
+  BNPtr k = NewBN();
+  PointPtr P = NewPoint(), P2 = NewPoint();
+
+  for (unsigned int i = 0; i < 100; i++) {
+    BN_rand_range(k.get(), Schnorr::GetCurveOrder());
+    EC_POINT_mul(group, P.get(), k.get(), nullptr, nullptr, ctx.get());
+
+    array<uint8_t, 33> compressed, native;
+    EC_POINT_point2oct(group, P.get(), POINT_CONVERSION_COMPRESSED,
+                       compressed.data(), compressed.size(), ctx.get());
+
+    GeAffine a;
+    BOOST_REQUIRE(a.ParseVar(compressed.data(), compressed.size()));
+    a.GetCompressed(native.data());
+    BOOST_CHECK_MESSAGE(native == compressed, "Compressed round trip failed");
+
+    BOOST_REQUIRE(StorePoint(P2.get(), a, ctx.get()));
+    BOOST_CHECK_MESSAGE(
+        EC_POINT_cmp(group, P.get(), P2.get(), ctx.get()) == 0,
+        "Store point mismatch");
+  }
+
+  // x = 5 is not the abscissa of a curve point, x = p is out of range
+  array<uint8_t, 33> invalid{};
+  invalid[0] = 0x02;
+  invalid[32] = 5;
+  GeAffine a;
+  BOOST_CHECK_MESSAGE(!a.ParseVar(invalid.data(), invalid.size()),
+                      "Invalid x accepted");
+  BNPtr p = FieldPrime();
+  BN_bn2bin(p.get(), invalid.data() + 1);
+  BOOST_CHECK_MESSAGE(!a.ParseVar(invalid.data(), invalid.size()),
+                      "Out of range x accepted");
+}
+
+/**
+ * \brief test_scalar_arithmetic
+ *
+ * \details Test the native scalar operations against BIGNUM arithmetic mod n
+ */
+BOOST_AUTO_TEST_CASE(test_scalar_arithmetic) {
+  CtxPtr ctx(BN_CTX_new(), BN_CTX_free);
+  const BIGNUM* order = Schnorr::GetCurveOrder();
+  BNPtr a = NewBN(), b = NewBN(), r = NewBN(), total = NewBN();
+
+  // Random values plus the edge cases 0, 1, n-1 and 2^256-1 (which is not
+  // reduced and must wrap on load)
+  vector<array<uint8_t, 32>> values;
+  array<uint8_t, 32> v{};
+  values.emplace_back(v);
+  v[31] = 1;
+  values.emplace_back(v);
+  BN_copy(a.get(), order);
+  BN_sub_word(a.get(), 1);
+  values.emplace_back(ToBytes(a.get()));
+  v.fill(0xFF);
+  values.emplace_back(v);
+  for (unsigned int i = 0; i < 200; i++) {
+    RAND_bytes(v.data(), v.size());
+    values.emplace_back(v);
+  }
+
+  ScalarSum sum;
+  BN_zero(total.get());
+
+  for (unsigned int i = 0; i < values.size(); i++) {
+    const auto& va = values[i];
+    const auto& vb = values[(i * 7 + 3) % values.size()];
+
+    Scalar sa, sb, sr;
+    const bool a_reduced = sa.SetB32(va.data());
+    sb.SetB32(vb.data());
+    BN_bin2bn(va.data(), va.size(), a.get());
+    BN_bin2bn(vb.data(), vb.size(), b.get());
+    BOOST_CHECK(a_reduced == (BN_cmp(a.get(), order) < 0));
+    BN_nnmod(a.get(), a.get(), order, ctx.get());
+    BN_nnmod(b.get(), b.get(), order, ctx.get());
+
+    array<uint8_t, 32> out;
+    sr.Mul(sa, sb);
+    sr.GetB32(out.data());
+    BN_mod_mul(r.get(), a.get(), b.get(), order, ctx.get());
+    BOOST_CHECK_MESSAGE(out == ToBytes(r.get()), "Mul mismatch");
+
+    sr.Add(sa, sb);
+    sr.GetB32(out.data());
+    BN_mod_add(r.get(), a.get(), b.get(), order, ctx.get());
+    BOOST_CHECK_MESSAGE(out == ToBytes(r.get()), "Add mismatch");
+
+    sr.Sub(sa, sb);
+    sr.GetB32(out.data());
+    BN_mod_sub(r.get(), a.get(), b.get(), order, ctx.get());
+    BOOST_CHECK_MESSAGE(out == ToBytes(r.get()), "Sub mismatch");
+
+    sum.Add(sa);
+    BN_mod_add(total.get(), total.get(), a.get(), order, ctx.get());
+  }
+
+  array<uint8_t, 32> out;
+  sum.Get().GetB32(out.data());
+  BOOST_CHECK_MESSAGE(out == ToBytes(total.get()), "Lazy sum mismatch");
+
+  // A long sum of n-1 wraps the 256-bit accumulator many times
+  Scalar max;
+  BN_copy(a.get(), order);
+  BN_sub_word(a.get(), 1);
+  max.SetB32(ToBytes(a.get()).data());
+  ScalarSum long_sum;
+  const unsigned int terms = 100000;
+  for (unsigned int i = 0; i < terms; i++) {
+    long_sum.Add(max);
+  }
+  long_sum.Get().GetB32(out.data());
+  // (n-1) * terms = -terms mod n
+  BN_copy(r.get(), order);
+  BN_sub_word(r.get(), terms);
+  BOOST_CHECK_MESSAGE(out == ToBytes(r.get()), "Long lazy sum mismatch");
+}
+
+/**
+ * \brief test_scalar_performance
+ *
+ * \details Compare native and BIGNUM scalar timings, and time response
+ * aggregation
+ */
+BOOST_AUTO_TEST_CASE(test_scalar_performance) {
+  const unsigned int iterations = 100000;
+  CtxPtr ctx(BN_CTX_new(), BN_CTX_free);
+  const BIGNUM* order = Schnorr::GetCurveOrder();
+  BNPtr a = NewBN(), b = NewBN();
+  BN_rand_range(a.get(), order);
+  BN_rand_range(b.get(), order);
+
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    BN_mod_mul(a.get(), a.get(), b.get(), order, ctx.get());
+  }
+  const double bn_mul = r_timer_end(t) * 1000 / iterations;
+
+  t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    BN_mod_add(a.get(), a.get(), b.get(), order, ctx.get());
+  }
+  const double bn_add = r_timer_end(t) * 1000 / iterations;
+
+  Scalar sa, sb;
+  LoadScalar(sa, a.get());
+  LoadScalar(sb, b.get());
+
+  t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    sa.Mul(sa, sb);
+  }
+  const double native_mul = r_timer_end(t) * 1000 / iterations;
+
+  t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    sa.Add(sa, sb);
+  }
+  const double native_add = r_timer_end(t) * 1000 / iterations;
+
+  ScalarSum sum;
+  t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    sum.Add(sa);
+  }
+  const double native_lazy = r_timer_end(t) * 1000 / iterations;
+  BOOST_CHECK(!sum.Get().IsZero() || sa.IsZero());
+
+  cout << "Scalar mul BIGNUM: " << bn_mul << " ns, native: " << native_mul
+       << " ns" << endl;
+  cout << "Scalar add BIGNUM: " << bn_add << " ns, native: " << native_add
+       << " ns, lazy: " << native_lazy << " ns" << endl;
+
+  const unsigned int responses_count = 4096;
+  vector<Response> responses;
+  vector<uint8_t> buf(32);
+  for (unsigned int i = 0; i < responses_count; i++) {
+    RAND_bytes(buf.data(), buf.size());
+    responses.emplace_back(buf, 0);
+  }
+
+  t = r_timer_start();
+  shared_ptr<Response> aggregated = MultiSig::AggregateResponses(responses);
+  cout << "AggregateResponses (" << responses_count
+       << "): " << r_timer_end(t) << " us" << endl;
+  BOOST_CHECK(aggregated != nullptr);
+}
+
+/**
+ * \brief test_generator_multiplication
+ *
+ * \details Test the comb table k*G against EC_POINT_mul
+ */
+BOOST_AUTO_TEST_CASE(test_generator_multiplication) {
+  CtxPtr ctx(BN_CTX_new(), BN_CTX_free);
+  const BIGNUM* order = Schnorr::GetCurveOrder();
+  BNPtr k = NewBN();
+  PointPtr Q = NewPoint();
+
+  for (unsigned int i = 0; i < 200; i++) {
+    switch (i) {
+      case 0:
+        BN_zero(k.get());
+        break;
+      case 1:
+        BN_one(k.get());
+        break;
+      case 2:
+        BN_copy(k.get(), order);
+        BN_sub_word(k.get(), 1);
+        break;
+      case 3:
+        BN_zero(k.get());
+        BN_set_bit(k.get(), 255);
+        break;
+      case 4:
+        BN_set_word(k.get(), 0xF);
+        break;
+      default:
+        BN_rand_range(k.get(), order);
+    }
+
+    EC_POINT_mul(Schnorr::GetCurveGroup(), Q.get(), k.get(), nullptr, nullptr,
+                 ctx.get());
+
+    Scalar nk;
+    BOOST_REQUIRE(LoadScalar(nk, k.get()));
+    GeJacobian nq;
+    EcMultGen(nq, nk);
+    BOOST_CHECK_MESSAGE(SamePoint(nq, Q.get(), ctx.get()),
+                        "Generator multiplication mismatch at " << i);
+  }
+}
+
+/**
+ * \brief test_generator_performance
+ *
+ * \details Time the entry points that multiply the generator
+ */
+BOOST_AUTO_TEST_CASE(test_generator_performance) {
+  const unsigned int iterations = 500;
+  CtxPtr ctx(BN_CTX_new(), BN_CTX_free);
+  BNPtr k = NewBN();
+  PointPtr Q = NewPoint();
+  BN_rand_range(k.get(), Schnorr::GetCurveOrder());
+
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    EC_POINT_mul(Schnorr::GetCurveGroup(), Q.get(), k.get(), nullptr, nullptr,
+                 ctx.get());
+  }
+  const double openssl_time = r_timer_end(t) / iterations;
+
+  Scalar nk;
+  LoadScalar(nk, k.get());
+  GeJacobian nq;
+  t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    EcMultGen(nq, nk);
+  }
+  const double comb_time = r_timer_end(t) / iterations;
+  BOOST_CHECK(SamePoint(nq, Q.get(), ctx.get()));
+
+  cout << "k*G OpenSSL: " << openssl_time << " us, comb table: " << comb_time
+       << " us" << endl;
+
+  PrivKey privkey;
+  t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    PubKey pubkey(privkey);
+  }
+  cout << "PubKey(PrivKey): " << r_timer_end(t) / iterations << " us" << endl;
+
+  CommitSecret secret;
+  t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    CommitPoint point(secret);
+  }
+  cout << "CommitPoint::Set: " << r_timer_end(t) / iterations << " us"
+       << endl;
+
+  PubKey pubkey(privkey);
+  vector<uint8_t> message(1024);
+  RAND_bytes(message.data(), message.size());
+  Signature signature;
+  t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    Schnorr::Sign(message, privkey, pubkey, signature);
+  }
+  cout << "Schnorr::Sign (1 kB): " << r_timer_end(t) / iterations << " us"
+       << endl;
+  BOOST_CHECK(Schnorr::Verify(message, signature, pubkey));
+}
+
+/**
+ * \brief test_native_performance
+ *
+ * \details Compare native and OpenSSL s*G + r*P timings
+ */
+BOOST_AUTO_TEST_CASE(test_native_performance) {
+  const unsigned int iterations = 1000;
+  CtxPtr ctx(BN_CTX_new(), BN_CTX_free);
+  const EC_GROUP* group = Schnorr::GetCurveGroup();
+  BNPtr s = NewBN(), r = NewBN();
+  PointPtr P = NewPoint(), Q = NewPoint();
+
+  BN_rand_range(s.get(), Schnorr::GetCurveOrder());
+  BN_rand_range(r.get(), Schnorr::GetCurveOrder());
+  EC_POINT_mul(group, P.get(), r.get(), nullptr, nullptr, ctx.get());
+
+  auto t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    EC_POINT_mul(group, Q.get(), s.get(), P.get(), r.get(), ctx.get());
+  }
+  const double openssl_time = r_timer_end(t) / iterations;
+
+  Scalar ns, nr;
+  GeAffine np;
+  LoadScalar(ns, s.get());
+  LoadScalar(nr, r.get());
+  LoadPoint(np, P.get(), ctx.get());
+  GeJacobian nq;
+
+  t = r_timer_start();
+  for (unsigned int i = 0; i < iterations; i++) {
+    EcMultDoubleVar(nq, np, nr, ns);
+  }
+  const double native_time = r_timer_end(t) / iterations;
+
+  BOOST_CHECK(SamePoint(nq, Q.get(), ctx.get()));
+
+  cout << "s*G + r*P OpenSSL: " << openssl_time << " us, native: "
+       << native_time << " us" << endl;
+}
+
+/**
+ * \brief test_multi_multiplication
+ *
+ * \details Test Straus, Pippenger and their dispatcher against the sum of
+ * single multiplications
+ */
+BOOST_AUTO_TEST_CASE(test_multi_multiplication) {
+  const size_t sizes[] = {0, 1, 2, 3, 7, 32, 129, 300};
+
+  for (size_t n : sizes) {
+    vector<GeAffine> a(n);
+    vector<Scalar> na(n);
+    for (size_t i = 0; i < n; i++) {
+      a[i] = MulG(RandomScalar());
+      na[i] = RandomScalar();
+    }
+
+    // Edge cases: zero scalars, points at infinity, repeated and opposite
+    // points, and scalars whose GLV parts or halves are negative or zero
+    if (n >= 7) {
+      na[0].SetInt(0);
+      a[1].infinity = true;
+      a[2] = a[3];
+      a[4].Neg(a[3]);
+      na[4] = na[3];
+      na[5].SetInt(1);
+      na[6].Negate(na[5]);
+    }
+
+    Scalar ng = RandomScalar();
+    const GeAffine expected = MultiMulReference(a, na, ng);
+
+    GeJacobian straus, pippenger, multi;
+    EcMultStrausVar(straus, a.data(), na.data(), n, ng);
+    EcMultPippengerVar(pippenger, a.data(), na.data(), n, ng);
+    EcMultMultiVar(multi, a.data(), na.data(), n, ng);
+    BOOST_CHECK_MESSAGE(straus.EqualAffineVar(expected),
+                        "Straus mismatch for n = " << n);
+    BOOST_CHECK_MESSAGE(pippenger.EqualAffineVar(expected),
+                        "Pippenger mismatch for n = " << n);
+    BOOST_CHECK_MESSAGE(multi.EqualAffineVar(expected),
+                        "EcMultMultiVar mismatch for n = " << n);
+
+    // A sum that cancels to the point at infinity
+    if (n >= 2) {
+      a[1] = a[0];
+      na[1].Negate(na[0]);
+      vector<GeAffine> pair_a(a.begin(), a.begin() + 2);
+      vector<Scalar> pair_na(na.begin(), na.begin() + 2);
+      Scalar zero;
+      zero.SetInt(0);
+      EcMultStrausVar(straus, pair_a.data(), pair_na.data(), 2, zero);
+      EcMultPippengerVar(pippenger, pair_a.data(), pair_na.data(), 2, zero);
+      BOOST_CHECK_MESSAGE(straus.infinity, "Straus sum not at infinity");
+      BOOST_CHECK_MESSAGE(pippenger.infinity, "Pippenger sum not at infinity");
+    }
+  }
+}
+
+/**
+ * \brief test_multi_performance
+ *
+ * \details Time multi-scalar multiplication for n = 2..65536 against n
+ * single multiplications
+ */
+BOOST_AUTO_TEST_CASE(test_multi_performance) {
+  const size_t max_points = 65536;
+  vector<GeJacobian> aj(max_points);
+  vector<GeAffine> a(max_points);
+  vector<Scalar> na(max_points);
+  for (size_t i = 0; i < max_points; i++) {
+    na[i] = RandomScalar();
+    EcMultGen(aj[i], RandomScalar());
+  }
+  GeAffine::SetAllJacobianVar(a.data(), aj.data(), max_points);
+  Scalar zero;
+  zero.SetInt(0);
+
+  for (size_t n = 2; n <= max_points; n *= 2) {
+    GeJacobian r;
+    double straus_time = 0;
+    double pippenger_time = 0;
+
+    // Straus and single multiplications are only timed where they are
+    // competitive
+    if (n <= 4 * STRAUS_MAX_POINTS) {
+      auto t = r_timer_start();
+      EcMultStrausVar(r, a.data(), na.data(), n, zero);
+      straus_time = r_timer_end(t);
+    }
+    auto t = r_timer_start();
+    EcMultPippengerVar(r, a.data(), na.data(), n, zero);
+    pippenger_time = r_timer_end(t);
+
+    double single_time = 0;
+    if (n <= 4 * STRAUS_MAX_POINTS) {
+      t = r_timer_start();
+      for (size_t i = 0; i < n; i++) {
+        EcMultDoubleVar(r, a[i], na[i], zero);
+      }
+      single_time = r_timer_end(t);
+    }
+
+    cout << "n = " << n << ": Pippenger " << pippenger_time / n
+         << " us/point";
+    if (straus_time != 0) {
+      cout << ", Straus " << straus_time / n << " us/point, single "
+           << single_time / n << " us/point";
+    }
+    cout << endl;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()